@@ -0,0 +1,116 @@
+// hot_bench.c: 한 항목에 응답이 몰릴 때의 쓰기 처리량 벤치마크
+// 쓰는 스레드 수를 늘려 가며, 모든 응답이 항목 lock 하나를 거치는 방식(lock)과
+// 이름 해시로 고른 샤드 잠금만 잡는 방식(shards)의 초당 응답 수를 비교한다.
+// 서버와 같이 참여자 중복 확인(명단 조회/추가)과 집계 갱신을 함께 하며, 끝나면 샤드를
+// 본체로 합쳐 득표 합과 참여자 수가 반영한 응답 수와 같은지 확인한다.
+// 실행: make hot_bench && ./bench/hot_bench [최대 쓰기 스레드 수] [측정 ms]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+#include "../include/common.h"
+#include "../src/server/voter_set.h"
+#include "../src/server/hash.h"
+#include "../src/server/seqlock.h"
+#include "../src/server/hot_item.h"
+
+typedef enum { MODE_LOCK, MODE_SHARDS } Mode;
+
+static Vote item;
+static HotItem* hot;
+static Mode mode;
+static atomic_int running;
+static atomic_ullong ballots;
+
+static void cast(const char* name, int idx) {
+    uint64_t hash = str_hash64(name);
+    if (mode == MODE_LOCK) {
+        pthread_mutex_lock(&item.lock);
+        if (!voter_set_contains(item.voters, name, hash) && voter_set_add(item.voters, name, hash)) {
+            seqlock_write_begin(&item.tally_seq);
+            item.voter_count++;
+            item.votes[idx]++;
+            seqlock_write_end(&item.tally_seq);
+        }
+        pthread_mutex_unlock(&item.lock);
+        return;
+    }
+    HotShard* shard = hot_item_shard(hot, hash);
+    pthread_mutex_lock(&shard->lock);
+    if (!voter_set_contains(item.voters, name, hash) && !voter_set_contains(shard->voters, name, hash) &&
+        voter_set_add(shard->voters, name, hash)) {
+        seqlock_write_begin(&shard->tally_seq);
+        shard->voter_count++;
+        shard->votes[idx]++;
+        seqlock_write_end(&shard->tally_seq);
+    }
+    pthread_mutex_unlock(&shard->lock);
+}
+
+static void* writer_main(void* arg) {
+    unsigned long n = 0, id = (unsigned long)(size_t)arg;
+    char name[MAX_USERNAME_LEN];
+    while (atomic_load_explicit(&running, memory_order_relaxed)) {
+        snprintf(name, sizeof(name), "w%lu_%lu", id, n);
+        cast(name, (int)(n % MAX_OPTIONS));
+        n++;
+    }
+    atomic_fetch_add(&ballots, n);
+    return NULL;
+}
+
+static void run(Mode m, int writers, int ms) {
+    pthread_t tids[256];
+
+    memset(&item, 0, sizeof(item));
+    pthread_mutex_init(&item.lock, NULL);
+    item.voters = voter_set_create();
+    hot = m == MODE_SHARDS ? hot_item_create() : NULL;
+    if (!item.voters || (m == MODE_SHARDS && !hot)) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    mode = m;
+    atomic_store(&running, 1);
+    atomic_store(&ballots, 0);
+
+    for (int i = 0; i < writers; i++) pthread_create(&tids[i], NULL, writer_main, (void*)(size_t)i);
+    struct timespec ts = { ms / 1000, (long)(ms % 1000) * 1000000L };
+    nanosleep(&ts, NULL);
+    atomic_store(&running, 0);
+    for (int i = 0; i < writers; i++) pthread_join(tids[i], NULL);
+
+    size_t shards = 0;
+    int folded = 1;
+    if (hot) {
+        size_t moved;
+        shards = hot->shard_count;
+        hot_item_lock_all(hot);
+        folded = hot_item_fold(hot, item.voters, item.votes, &item.voter_count, &item.tally_seq, &moved) == 0;
+        hot_item_unlock_all(hot);
+    }
+    long total = 0;
+    for (int i = 0; i < MAX_OPTIONS; i++) total += item.votes[i];
+    int ok = folded && total == item.voter_count && (unsigned long long)item.voter_count == atomic_load(&ballots);
+
+    double sec = ms / 1000.0;
+    printf("%-8s %7d %7zu %14.0f %8s\n", m == MODE_LOCK ? "lock" : "shards", writers, shards,
+           atomic_load(&ballots) / sec, ok ? "yes" : "NO");
+    // 명단과 샤드는 실행마다 새로 만들고 버림 (벤치마크라 해제하지 않음)
+    pthread_mutex_destroy(&item.lock);
+}
+
+int main(int argc, char* argv[]) {
+    int max_writers = argc > 1 ? atoi(argv[1]) : 8;
+    int ms = argc > 2 ? atoi(argv[2]) : 500;
+    if (max_writers > 256) max_writers = 256;
+
+    printf("%-8s %7s %7s %14s %8s\n", "mode", "writers", "shards", "ballots/s", "exact");
+    for (int w = 1; w <= max_writers; w *= 2) {
+        run(MODE_LOCK, w, ms);
+        run(MODE_SHARDS, w, ms);
+    }
+    return 0;
+}
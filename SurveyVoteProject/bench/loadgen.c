@@ -0,0 +1,456 @@
+// loadgen.c: 서버 부하 생성기 - 많은 동시 참여자를 흉내 내어 처리량과 지연 시간 분포를 잰다
+// 시작할 때 연결 하나로 설문/투표를 만들고, 스레드마다 epoll 하나로 나눠 맡은 연결들을 돌리며
+// 연결마다 요청 하나를 보내고 응답을 받으면 다음 요청을 보낸다(closed loop, 프레임 방식).
+// 요청 종류(RESPOND/RESULT/LIST 비율), 대상 항목과 보기는 연결마다 시드에서 만든 난수열로 고르므로
+// 같은 시드와 옵션이면 각 연결이 보내는 요청열이 실행마다 같다. 응답 이름은 실행마다 새로 만든 항목에
+// 연결/순번으로 만들어 겹치지 않으므로 RESPOND 는 모두 받아들여져야 한다 ([ERROR] 응답은 오류로 셈).
+// 실행: make loadgen && ./bench/loadgen [-c 연결] [-t 스레드] [-n 연결당 요청] [-d 최대 초] [-s 시드]
+//       [-m respond,result,list 비율] [-i 종류별 항목 수] [-H 인기 항목 비율%] [-h 호스트] [-p 포트]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include "../include/common.h"
+
+#define MAX_THREADS     64
+#define MAX_ITEMS       1024
+#define INITIAL_IN_CAP  4096
+#define LIST_PAGE_SIZE  20
+
+typedef enum { OP_RESPOND, OP_RESULT, OP_LIST, OP_COUNT } OpType;
+static const char* op_names[OP_COUNT] = { "respond", "result", "list" };
+
+typedef struct Options {
+    const char* host;
+    int port;
+    int connections;
+    int threads;
+    long requests;       // 연결당 요청 수
+    double max_seconds;  // 0 이면 제한 없음
+    unsigned long long seed;
+    int mix[OP_COUNT];   // 비율 (합으로 나눔)
+    int items;           // 종류(설문/투표)별 항목 수
+    int hot_percent;     // RESPOND/RESULT 중 첫 항목으로 보내는 비율
+} Options;
+
+// 만든 항목 - 짝수 번째는 설문, 홀수 번째는 투표
+typedef struct Item {
+    char kind;           // 'S' / 'V'
+    char id[ID_LENGTH];
+} Item;
+
+// 종류별 지연 시간 기록 (ns, 끝나고 정렬해 백분위를 구함)
+typedef struct Samples {
+    long long* ns;
+    size_t count;
+    size_t cap;
+    unsigned long long errors;
+} Samples;
+
+typedef struct Conn {
+    int fd;
+    int index;
+    uint64_t rng;
+    long sent;
+    OpType op;
+    long long sent_at;
+    unsigned char* in;
+    size_t in_len;
+    size_t in_cap;
+} Conn;
+
+typedef struct Worker {
+    pthread_t tid;
+    Conn* conns;
+    int conn_count;
+    Samples samples[OP_COUNT];
+    int failed;
+} Worker;
+
+static Options opt = {
+    .host = "127.0.0.1", .port = 9000, .connections = 100, .threads = 4, .requests = 500,
+    .max_seconds = 0, .seed = 1, .mix = { 60, 30, 10 }, .items = 8, .hot_percent = 0,
+};
+static Item items[MAX_ITEMS * 2];
+static int item_count;
+static pthread_barrier_t start_barrier;
+static long long deadline_ns;
+
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// splitmix64 - 시드가 같으면 같은 수열
+static uint64_t next_random(uint64_t* state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static int random_below(uint64_t* state, int n) {
+    return (int)(next_random(state) % (uint64_t)n);
+}
+
+static void add_sample(Samples* s, long long ns) {
+    if (s->count == s->cap) {
+        size_t cap = s->cap ? s->cap * 2 : 4096;
+        long long* grown = realloc(s->ns, cap * sizeof(long long));
+        if (!grown) return;
+        s->ns = grown;
+        s->cap = cap;
+    }
+    s->ns[s->count++] = ns;
+}
+
+static int connect_server(void) {
+    struct sockaddr_in addr;
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    if (fd < 0) return -1;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)opt.port);
+    if (inet_pton(AF_INET, opt.host, &addr.sin_addr) != 1 ||
+        connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+
+static int send_frame(int fd, const char* body, size_t len) {
+    unsigned char frame[FRAME_HEADER_LEN + BUFFER_SIZE];
+    if (len > BUFFER_SIZE) return -1;
+    frame[0] = (unsigned char)(len >> 24);
+    frame[1] = (unsigned char)(len >> 16);
+    frame[2] = (unsigned char)(len >> 8);
+    frame[3] = (unsigned char)len;
+    memcpy(frame + FRAME_HEADER_LEN, body, len);
+    // 연결마다 요청은 하나씩만 보내므로 소켓 송신 버퍼는 항상 비어 있어 한 번에 다 나감
+    ssize_t n = send(fd, frame, FRAME_HEADER_LEN + len, MSG_NOSIGNAL);
+    return n == (ssize_t)(FRAME_HEADER_LEN + len) ? 0 : -1;
+}
+
+// 준비용 동기 요청 (항목 만들기) - 응답 본문을 buf 에 담음
+static int call(int fd, const char* body, char* buf, size_t size) {
+    unsigned char header[FRAME_HEADER_LEN];
+    if (send_frame(fd, body, strlen(body)) < 0) return -1;
+    for (size_t got = 0; got < sizeof(header);) {
+        ssize_t n = recv(fd, header + got, sizeof(header) - got, 0);
+        if (n <= 0) return -1;
+        got += (size_t)n;
+    }
+    size_t len = ((size_t)header[0] << 24) | ((size_t)header[1] << 16) | ((size_t)header[2] << 8) | header[3];
+    if (len >= size) return -1;
+    for (size_t got = 0; got < len;) {
+        ssize_t n = recv(fd, buf + got, len - got, 0);
+        if (n <= 0) return -1;
+        got += (size_t)n;
+    }
+    buf[len] = '\0';
+    return 0;
+}
+
+// 시드가 들어간 제목으로 항목을 만들고 응답의 ID 를 모음
+static int create_items(void) {
+    char req[BUFFER_SIZE], resp[BUFFER_SIZE];
+    int fd = connect_server();
+    if (fd < 0) {
+        perror("connect() failed");
+        return -1;
+    }
+    for (int i = 0; i < opt.items * 2; i++) {
+        Item* item = &items[item_count];
+        item->kind = i % 2 == 0 ? 'S' : 'V';
+        snprintf(req, sizeof(req), "%s|loadgen %llu %s %d|a,b,c,d",
+                 item->kind == 'S' ? CMD_CREATE_SURVEY : CMD_CREATE_VOTE, opt.seed,
+                 item->kind == 'S' ? "survey" : "vote", i / 2);
+        const char* id;
+        if (call(fd, req, resp, sizeof(resp)) < 0 || strncmp(resp, "[OK]", 4) != 0 ||
+            !(id = strstr(resp, "ID: "))) {
+            fprintf(stderr, "failed to create item: %s\n", resp);
+            close(fd);
+            return -1;
+        }
+        snprintf(item->id, sizeof(item->id), "%s", id + 4);
+        item_count++;
+    }
+    close(fd);
+    return 0;
+}
+
+static const Item* pick_item(Conn* c) {
+    if (opt.hot_percent > 0 && random_below(&c->rng, 100) < opt.hot_percent) return &items[0];
+    return &items[random_below(&c->rng, item_count)];
+}
+
+// 다음 요청을 난수열로 정해 보냄 - 요청 내용은 시드, 연결 번호, 순번으로만 정해짐
+static int send_next(Conn* c) {
+    int total = opt.mix[OP_RESPOND] + opt.mix[OP_RESULT] + opt.mix[OP_LIST];
+    int r = random_below(&c->rng, total);
+    char req[BUFFER_SIZE];
+    int len;
+
+    if (r < opt.mix[OP_RESPOND]) {
+        const Item* item = pick_item(c);
+        c->op = OP_RESPOND;
+        if (item->kind == 'S') {
+            int a = random_below(&c->rng, 4) + 1, b = random_below(&c->rng, 4) + 1;
+            len = snprintf(req, sizeof(req), "%s|%s|%d,%d|u%llx.%d.%ld", CMD_RESPOND_SURVEY, item->id, a, b,
+                           opt.seed, c->index, c->sent);
+        } else {
+            len = snprintf(req, sizeof(req), "%s|%s|%d|u%llx.%d.%ld", CMD_RESPOND_VOTE, item->id,
+                           random_below(&c->rng, 4) + 1, opt.seed, c->index, c->sent);
+        }
+    } else if (r < opt.mix[OP_RESPOND] + opt.mix[OP_RESULT]) {
+        const Item* item = pick_item(c);
+        c->op = OP_RESULT;
+        len = snprintf(req, sizeof(req), "%s|%s", item->kind == 'S' ? CMD_RESULT_SURVEY : CMD_RESULT_VOTE, item->id);
+    } else {
+        c->op = OP_LIST;
+        len = snprintf(req, sizeof(req), "%s|-|%d", random_below(&c->rng, 2) ? CMD_LIST_SURVEY : CMD_LIST_VOTE,
+                       LIST_PAGE_SIZE);
+    }
+    c->sent++;
+    c->sent_at = now_ns();
+    return send_frame(c->fd, req, (size_t)len);
+}
+
+static int finished(const Conn* c, long long now) {
+    return c->sent >= opt.requests || (deadline_ns && now >= deadline_ns);
+}
+
+// 받은 바이트에서 완성된 응답을 꺼내 기록하고 다음 요청을 보냄 (연결을 끝내야 하면 1, 오류면 -1)
+static int handle_input(Worker* w, Conn* c) {
+    for (;;) {
+        if (c->in_cap - c->in_len < 1024) {
+            size_t cap = c->in_cap * 2;
+            unsigned char* grown = realloc(c->in, cap);
+            if (!grown) return -1;
+            c->in = grown;
+            c->in_cap = cap;
+        }
+        ssize_t n = recv(c->fd, c->in + c->in_len, c->in_cap - c->in_len, 0);
+        if (n == 0) return -1;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            return -1;
+        }
+        c->in_len += (size_t)n;
+    }
+
+    if (c->in_len < FRAME_HEADER_LEN) return 0;
+    size_t len = ((size_t)c->in[0] << 24) | ((size_t)c->in[1] << 16) | ((size_t)c->in[2] << 8) | c->in[3];
+    if (c->in_len < FRAME_HEADER_LEN + len) return 0;
+
+    long long now = now_ns();
+    Samples* s = &w->samples[c->op];
+    add_sample(s, now - c->sent_at);
+    if (len >= 7 && memcmp(c->in + FRAME_HEADER_LEN, "[ERROR]", 7) == 0) s->errors++;
+    // closed loop 이므로 응답 뒤에 더 받은 바이트는 없음
+    c->in_len = 0;
+
+    if (finished(c, now)) return 1;
+    return send_next(c) < 0 ? -1 : 0;
+}
+
+static void* worker_main(void* arg) {
+    Worker* w = arg;
+    struct epoll_event events[256];
+    int epfd = epoll_create1(0);
+    int active = 0;
+
+    if (epfd < 0) w->failed = 1;
+    for (int i = 0; i < w->conn_count && !w->failed; i++) {
+        Conn* c = &w->conns[i];
+        struct epoll_event ev = { .events = EPOLLIN, .data.ptr = c };
+        c->fd = connect_server();
+        c->in_cap = INITIAL_IN_CAP;
+        c->in = malloc(c->in_cap);
+        if (c->fd < 0 || !c->in || fcntl(c->fd, F_SETFL, O_NONBLOCK) < 0 || epoll_ctl(epfd, EPOLL_CTL_ADD, c->fd, &ev) < 0) {
+            fprintf(stderr, "connection %d failed: %s\n", c->index, strerror(errno));
+            w->failed = 1;
+        }
+    }
+    // 모든 스레드가 연결을 마친 뒤 함께 시작
+    pthread_barrier_wait(&start_barrier);
+    if (w->failed) goto out;
+
+    for (int i = 0; i < w->conn_count; i++) {
+        if (send_next(&w->conns[i]) < 0) {
+            w->failed = 1;
+            goto out;
+        }
+        active++;
+    }
+    while (active > 0) {
+        int n = epoll_wait(epfd, events, 256, 1000);
+        if (n < 0 && errno != EINTR) break;
+        for (int i = 0; i < n; i++) {
+            Conn* c = events[i].data.ptr;
+            int ret = handle_input(w, c);
+            if (ret < 0) {
+                fprintf(stderr, "connection %d closed unexpectedly\n", c->index);
+                w->failed = 1;
+            }
+            if (ret != 0) {
+                epoll_ctl(epfd, EPOLL_CTL_DEL, c->fd, NULL);
+                active--;
+            }
+        }
+    }
+out:
+    for (int i = 0; i < w->conn_count; i++) {
+        if (w->conns[i].fd >= 0) close(w->conns[i].fd);
+        free(w->conns[i].in);
+    }
+    if (epfd >= 0) close(epfd);
+    return NULL;
+}
+
+static int compare_ll(const void* a, const void* b) {
+    long long x = *(const long long*)a, y = *(const long long*)b;
+    return (x > y) - (x < y);
+}
+
+static double percentile_us(const Samples* s, double q) {
+    if (s->count == 0) return 0.0;
+    size_t rank = (size_t)(q * (double)s->count);
+    if (rank >= s->count) rank = s->count - 1;
+    return s->ns[rank] / 1000.0;
+}
+
+static void print_row(const char* name, Samples* s, double sec) {
+    long long sum = 0;
+    qsort(s->ns, s->count, sizeof(long long), compare_ll);
+    for (size_t i = 0; i < s->count; i++) sum += s->ns[i];
+    printf("%-8s %9zu %7llu %10.1f %9.1f %9.1f %9.1f %9.1f %9.1f\n", name, s->count, s->errors,
+           s->count / sec, s->count ? sum / 1000.0 / s->count : 0.0,
+           percentile_us(s, 0.50), percentile_us(s, 0.99), percentile_us(s, 0.999),
+           s->count ? s->ns[s->count - 1] / 1000.0 : 0.0);
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr, "Usage: %s [-c connections] [-t threads] [-n requests_per_conn] [-d max_seconds] [-s seed]\n"
+                    "          [-m respond,result,list] [-i items_per_kind] [-H hot_percent] [-h host] [-p port]\n", prog);
+}
+
+static int parse_args(int argc, char* argv[]) {
+    int o;
+    while ((o = getopt(argc, argv, "c:t:n:d:s:m:i:H:h:p:")) != -1) {
+        switch (o) {
+            case 'c': opt.connections = atoi(optarg); break;
+            case 't': opt.threads = atoi(optarg); break;
+            case 'n': opt.requests = atol(optarg); break;
+            case 'd': opt.max_seconds = atof(optarg); break;
+            case 's': opt.seed = strtoull(optarg, NULL, 10); break;
+            case 'm':
+                if (sscanf(optarg, "%d,%d,%d", &opt.mix[OP_RESPOND], &opt.mix[OP_RESULT], &opt.mix[OP_LIST]) != 3) {
+                    return -1;
+                }
+                break;
+            case 'i': opt.items = atoi(optarg); break;
+            case 'H': opt.hot_percent = atoi(optarg); break;
+            case 'h': opt.host = optarg; break;
+            case 'p': opt.port = atoi(optarg); break;
+            default: return -1;
+        }
+    }
+    if (opt.connections < 1 || opt.threads < 1 || opt.requests < 1 || opt.items < 1 || opt.items > MAX_ITEMS ||
+        opt.mix[OP_RESPOND] < 0 || opt.mix[OP_RESULT] < 0 || opt.mix[OP_LIST] < 0 ||
+        opt.mix[OP_RESPOND] + opt.mix[OP_RESULT] + opt.mix[OP_LIST] <= 0) {
+        return -1;
+    }
+    if (opt.threads > MAX_THREADS) opt.threads = MAX_THREADS;
+    if (opt.threads > opt.connections) opt.threads = opt.connections;
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    Worker workers[MAX_THREADS];
+
+    if (parse_args(argc, argv) < 0) {
+        usage(argv[0]);
+        return 2;
+    }
+    if (create_items() < 0) return 1;
+
+    Conn* conns = calloc((size_t)opt.connections, sizeof(Conn));
+    if (!conns) return 1;
+    memset(workers, 0, sizeof(workers));
+    for (int i = 0; i < opt.connections; i++) {
+        conns[i].fd = -1;
+        conns[i].index = i;
+        conns[i].rng = opt.seed * 0x100000001B3ULL + (uint64_t)i;
+    }
+    // 연결을 스레드에 고르게 나눔
+    for (int t = 0, start = 0; t < opt.threads; t++) {
+        int count = opt.connections / opt.threads + (t < opt.connections % opt.threads);
+        workers[t].conns = conns + start;
+        workers[t].conn_count = count;
+        start += count;
+    }
+
+    printf("loadgen: %s:%d, %d connections, %d threads, seed %llu, %ld requests/conn, "
+           "mix respond/result/list %d/%d/%d, %d items, hot %d%%\n",
+           opt.host, opt.port, opt.connections, opt.threads, opt.seed, opt.requests,
+           opt.mix[OP_RESPOND], opt.mix[OP_RESULT], opt.mix[OP_LIST], item_count, opt.hot_percent);
+
+    pthread_barrier_init(&start_barrier, NULL, (unsigned)opt.threads + 1);
+    for (int t = 0; t < opt.threads; t++) {
+        pthread_create(&workers[t].tid, NULL, worker_main, &workers[t]);
+    }
+    pthread_barrier_wait(&start_barrier);
+    long long start = now_ns();
+    if (opt.max_seconds > 0) deadline_ns = start + (long long)(opt.max_seconds * 1e9);
+    for (int t = 0; t < opt.threads; t++) {
+        pthread_join(workers[t].tid, NULL);
+    }
+    double sec = (now_ns() - start) / 1e9;
+
+    // 스레드별 기록을 종류별로 합침
+    Samples merged[OP_COUNT + 1];
+    memset(merged, 0, sizeof(merged));
+    int failed = 0;
+    for (int t = 0; t < opt.threads; t++) {
+        failed |= workers[t].failed;
+        for (int k = 0; k < OP_COUNT; k++) {
+            Samples* s = &workers[t].samples[k];
+            for (int m = 0; m < 2; m++) {
+                Samples* dst = m == 0 ? &merged[k] : &merged[OP_COUNT];
+                for (size_t i = 0; i < s->count; i++) add_sample(dst, s->ns[i]);
+                dst->errors += s->errors;
+            }
+            free(s->ns);
+        }
+    }
+
+    unsigned long long total = merged[OP_COUNT].count;
+    printf("elapsed %.2f s, %llu requests, %.1f req/s, errors %llu\n",
+           sec, total, total / sec, merged[OP_COUNT].errors);
+    printf("%-8s %9s %7s %10s %9s %9s %9s %9s %9s\n",
+           "op", "count", "errors", "req/s", "avg_us", "p50_us", "p99_us", "p999_us", "max_us");
+    for (int k = 0; k < OP_COUNT; k++) {
+        if (merged[k].count > 0) print_row(op_names[k], &merged[k], sec);
+    }
+    print_row("all", &merged[OP_COUNT], sec);
+
+    for (int k = 0; k <= OP_COUNT; k++) free(merged[k].ns);
+    free(conns);
+    return failed || merged[OP_COUNT].errors > 0 ? 1 : 0;
+}
@@ -0,0 +1,121 @@
+// parse_bench.c: 명령 파싱/분배 비용 비교
+// 이전 방식(메시지 복사 -> CMD_* 와 strncmp 연쇄 비교 -> 핸들러 안에서 strtok_r)과
+// request_parse + 조회 표 방식을 같은 명령 묶음에 대해 반복 실행하고 명령당 시간을 출력한다.
+// 실행: make parse_bench && ./bench/parse_bench [반복 횟수]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../include/common.h"
+#include "../src/server/request.h"
+
+static const char* samples[] = {
+    "RESPOND_VOTE|ronaldo-vs-messi|1|user1234",
+    "RESPOND_SURVEY|favorite-programming-language|1,3,4|user5678",
+    "RESULT_VOTE|ronaldo-vs-messi",
+    "LIST_VOTE",
+    "RESULT_SURVEY|favorite-programming-language",
+    "CREATE_VOTE|best lunch menu this week|kimchi stew,bibimbap,ramen",
+    "LIST_SURVEY",
+    "CLOSE_VOTE|best-lunch-menu-this-week",
+};
+#define SAMPLE_COUNT (sizeof(samples) / sizeof(samples[0]))
+
+// 최적화로 계산이 사라지지 않도록 결과를 모아 둠
+static volatile unsigned long sink;
+
+static unsigned long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// 이전 핸들러들이 하던 필드 나누기 - ID/이름/보기 번호까지 꺼냄
+static unsigned long legacy_fields(char* msg, int field_count, int parse_opts) {
+    char* saveptr;
+    unsigned long acc = 0;
+    strtok_r(msg, "|", &saveptr);
+    for (int i = 0; i < field_count; i++) {
+        char* f = strtok_r(NULL, "|", &saveptr);
+        if (!f) break;
+        acc += strlen(f);
+        if (parse_opts && i == 1) {
+            char* saveptr_opts;
+            for (char* t = strtok_r(f, ",", &saveptr_opts); t; t = strtok_r(NULL, ",", &saveptr_opts)) {
+                acc += atoi(t);
+            }
+        }
+    }
+    return acc;
+}
+
+static unsigned long legacy_dispatch(const char* buffer, size_t len) {
+    char msg_copy[BUFFER_SIZE];
+    if (len > sizeof(msg_copy) - 1) len = sizeof(msg_copy) - 1;
+    memcpy(msg_copy, buffer, len);
+    msg_copy[len] = '\0';
+
+    if (strncmp(msg_copy, CMD_CREATE_SURVEY, strlen(CMD_CREATE_SURVEY)) == 0) return 1 + legacy_fields(msg_copy, 2, 0);
+    else if (strncmp(msg_copy, CMD_RESPOND_SURVEY, strlen(CMD_RESPOND_SURVEY)) == 0) return 2 + legacy_fields(msg_copy, 3, 1);
+    else if (strncmp(msg_copy, CMD_RESULT_SURVEY, strlen(CMD_RESULT_SURVEY)) == 0) return 3 + legacy_fields(msg_copy, 1, 0);
+    else if (strncmp(msg_copy, CMD_CLOSE_SURVEY, strlen(CMD_CLOSE_SURVEY)) == 0) return 4 + legacy_fields(msg_copy, 1, 0);
+    else if (strncmp(msg_copy, CMD_CREATE_VOTE, strlen(CMD_CREATE_VOTE)) == 0) return 5 + legacy_fields(msg_copy, 2, 0);
+    else if (strncmp(msg_copy, CMD_RESPOND_VOTE, strlen(CMD_RESPOND_VOTE)) == 0) return 6 + legacy_fields(msg_copy, 3, 1);
+    else if (strncmp(msg_copy, CMD_RESULT_VOTE, strlen(CMD_RESULT_VOTE)) == 0) return 7 + legacy_fields(msg_copy, 1, 0);
+    else if (strncmp(msg_copy, CMD_CLOSE_VOTE, strlen(CMD_CLOSE_VOTE)) == 0) return 8 + legacy_fields(msg_copy, 1, 0);
+    else if (strncmp(msg_copy, CMD_LIST_SURVEY, strlen(CMD_LIST_SURVEY)) == 0) return 9;
+    else if (strncmp(msg_copy, CMD_LIST_VOTE, strlen(CMD_LIST_VOTE)) == 0) return 10;
+    return 0;
+}
+
+// 지금 핸들러들이 하는 일 - ID/이름은 짧은 버퍼로 복사, 보기 번호는 view 에서 바로 읽음
+static unsigned long request_dispatch(const char* buffer, size_t len) {
+    Request req;
+    char id[ID_LENGTH];
+    char username[MAX_USERNAME_LEN];
+    request_parse(buffer, len, &req);
+    unsigned long acc = (unsigned long)req.type;
+    if (req.argc > 0) acc += strview_copy(id, sizeof(id), req.args[0]);
+    if (req.type == REQ_RESPOND_VOTE || req.type == REQ_RESPOND_SURVEY) {
+        StrView opts = request_arg(&req, 1), t;
+        while (strview_next(&opts, ',', &t)) acc += strview_to_int(t);
+        acc += strview_copy(username, sizeof(username), request_arg(&req, 2));
+    } else if (req.argc > 1) {
+        acc += req.args[1].len;
+    }
+    return acc;
+}
+
+typedef unsigned long (*dispatch_fn)(const char* buffer, size_t len);
+
+static double run(dispatch_fn fn, long iterations, const size_t* lens) {
+    unsigned long acc = 0;
+    unsigned long long start = now_ns();
+    for (long i = 0; i < iterations; i++) {
+        size_t k = (size_t)i % SAMPLE_COUNT;
+        acc += fn(samples[k], lens[k]);
+    }
+    unsigned long long elapsed = now_ns() - start;
+    sink = acc;
+    return (double)elapsed / iterations;
+}
+
+int main(int argc, char* argv[]) {
+    long iterations = argc > 1 ? atol(argv[1]) : 5000000;
+    size_t lens[SAMPLE_COUNT];
+
+    request_table_init();
+    for (size_t i = 0; i < SAMPLE_COUNT; i++) lens[i] = strlen(samples[i]);
+
+    // 캐시/분기 예측을 데우기 위한 짧은 예열
+    run(legacy_dispatch, iterations / 10 + 1, lens);
+    run(request_dispatch, iterations / 10 + 1, lens);
+
+    double legacy = run(legacy_dispatch, iterations, lens);
+    double parsed = run(request_dispatch, iterations, lens);
+    printf("iterations        %ld\n", iterations);
+    printf("legacy  (ns/cmd)  %.1f\n", legacy);
+    printf("request (ns/cmd)  %.1f\n", parsed);
+    printf("speedup           %.2fx\n", legacy / parsed);
+    return 0;
+}
@@ -0,0 +1,146 @@
+// scan_bench.c: 항목 배치(layout)에 따른 목록/집계 순회 벤치마크
+// 이전 배치(문자열이 구조체 안에 있고 집계/상태/next 가 그 사이사이에 흩어진 약 900바이트 노드를 항목마다
+// malloc)와 지금 배치(집계/상태/next 를 첫 캐시 라인에 모은 256바이트 노드 + 별도 ItemText, 둘 다 항목
+// 풀에서 할당)로 같은 수의 항목을 만들고, 서버가 하는 두 가지 순회의 항목당 시간을 비교한다.
+//   tally: next 를 따라가며 seqlock 으로 집계/상태를 읽음 (RESULT/LIST 의 집계 읽기)
+//   list : 상태와 함께 ID/제목 길이를 셈 (LIST 스트리밍의 길이 계산)
+// 실행: make scan_bench && ./bench/scan_bench [항목 수] [반복 횟수]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../include/common.h"
+#include "../src/server/voter_set.h"
+#include "../src/server/seqlock.h"
+#include "../src/server/pool.h"
+
+// 이전 배치의 Survey (필드 순서 그대로)
+typedef struct OldSurvey {
+    char id[ID_LENGTH];
+    char question[MAX_QUESTION_LEN];
+    int  option_count;
+    char options[MAX_OPTIONS][MAX_OPTION_LEN];
+    int  votes[MAX_OPTIONS];
+    ItemStatus status;
+    int voter_count;
+    struct VoterSet* voters;
+    pthread_mutex_t lock;
+    pthread_mutex_t file_lock;
+    unsigned long change_seq;
+    unsigned long saved_seq;
+    atomic_uint tally_seq;
+    atomic_uint contention;
+    void* _Atomic hot;
+    void* result_reply;
+    struct OldSurvey* next;
+} OldSurvey;
+
+static Pool node_pool = POOL_INITIALIZER("survey", sizeof(Survey));
+static Pool text_pool = POOL_INITIALIZER("survey_text", sizeof(ItemText));
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// 서버와 같이 항목마다 참여자 명단도 함께 만들어, 항목 사이에 다른 할당이 끼게 함
+static OldSurvey* build_old(int n) {
+    OldSurvey* head = NULL;
+    for (int i = 0; i < n; i++) {
+        OldSurvey* node = malloc(sizeof(OldSurvey));
+        memset(node, 0, sizeof(OldSurvey));
+        node->voters = voter_set_create();
+        snprintf(node->id, sizeof(node->id), "bench-item-%d", i);
+        snprintf(node->question, sizeof(node->question), "bench item %d", i);
+        node->option_count = 3;
+        node->votes[i % 3] = i;
+        node->voter_count = i;
+        node->status = i % 7 ? STATUS_ACTIVE : STATUS_CLOSED;
+        node->next = head;
+        head = node;
+    }
+    return head;
+}
+
+static Survey* build_new(int n) {
+    Survey* head = NULL;
+    for (int i = 0; i < n; i++) {
+        Survey* node = pool_alloc(&node_pool);
+        ItemText* text = pool_alloc(&text_pool);
+        if (!node || !text) {
+            fprintf(stderr, "out of memory\n");
+            exit(1);
+        }
+        node->question = text->title;
+        node->options = text->options;
+        node->voters = voter_set_create();
+        snprintf(node->id, sizeof(node->id), "bench-item-%d", i);
+        snprintf(node->question, MAX_QUESTION_LEN, "bench item %d", i);
+        node->option_count = 3;
+        node->votes[i % 3] = i;
+        node->voter_count = i;
+        node->status = i % 7 ? STATUS_ACTIVE : STATUS_CLOSED;
+        node->next = head;
+        head = node;
+    }
+    return head;
+}
+
+// 두 배치에 같은 순회 코드를 쓰기 위한 매크로 - 결과(sink)를 돌려줘 최적화로 사라지지 않게 함
+#define SCAN_TALLY(type, head, sink)                                          \
+    for (type* cur = (head); cur; cur = cur->next) {                          \
+        int votes[MAX_OPTIONS], voters;                                       \
+        ItemStatus status;                                                    \
+        unsigned start;                                                       \
+        do {                                                                  \
+            start = seqlock_read_begin(&cur->tally_seq);                      \
+            memcpy(votes, cur->votes, sizeof(votes));                         \
+            voters = cur->voter_count;                                        \
+            status = cur->status;                                             \
+        } while (seqlock_read_retry(&cur->tally_seq, start));                 \
+        (sink) += votes[0] + votes[1] + votes[2] + voters + (int)status;      \
+    }
+
+#define SCAN_LIST(type, head, sink)                                           \
+    for (type* cur = (head); cur; cur = cur->next) {                          \
+        unsigned start;                                                       \
+        ItemStatus status;                                                    \
+        do {                                                                  \
+            start = seqlock_read_begin(&cur->tally_seq);                      \
+            status = cur->status;                                             \
+        } while (seqlock_read_retry(&cur->tally_seq, start));                 \
+        (sink) += strlen(cur->id) + strlen(cur->question) + (size_t)status;   \
+    }
+
+int main(int argc, char* argv[]) {
+    int n = argc > 1 ? atoi(argv[1]) : 100000;
+    int reps = argc > 2 ? atoi(argv[2]) : 10;
+    if (n < 1) n = 1;
+    if (reps < 1) reps = 1;
+
+    OldSurvey* old_head = build_old(n);
+    Survey* new_head = build_new(n);
+    double best[4] = { 1e30, 1e30, 1e30, 1e30 };
+    size_t sink = 0;
+
+    for (int r = 0; r < reps; r++) {
+        double t0 = now_ns();
+        SCAN_TALLY(OldSurvey, old_head, sink);
+        double t1 = now_ns();
+        SCAN_TALLY(Survey, new_head, sink);
+        double t2 = now_ns();
+        SCAN_LIST(OldSurvey, old_head, sink);
+        double t3 = now_ns();
+        SCAN_LIST(Survey, new_head, sink);
+        double t4 = now_ns();
+        double t[4] = { t1 - t0, t2 - t1, t3 - t2, t4 - t3 };
+        for (int i = 0; i < 4; i++) if (t[i] < best[i]) best[i] = t[i];
+    }
+
+    printf("items %d, node bytes: old %zu, new %zu (+ text %zu)\n", n, sizeof(OldSurvey), sizeof(Survey), sizeof(ItemText));
+    printf("%-6s %12s %12s %8s\n", "scan", "old ns/item", "new ns/item", "speedup");
+    printf("%-6s %12.2f %12.2f %7.2fx\n", "tally", best[0] / n, best[1] / n, best[0] / best[1]);
+    printf("%-6s %12.2f %12.2f %7.2fx\n", "list", best[2] / n, best[3] / n, best[2] / best[3]);
+    return sink == 42 ? 1 : 0;
+}
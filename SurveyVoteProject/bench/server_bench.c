@@ -0,0 +1,370 @@
+// server_bench.c: 서버 코드를 소켓 왕복 없이 같은 프로세스에서 직접 호출하는 벤치마크 모음
+// main.c 를 뺀 서버 소스를 그대로 링크하므로 실제 서버와 같은 함수를 잰다. 결과는 한 줄에 하나씩
+// JSON 으로 표준 출력에 쓰고(서버 코드가 찍는 메시지와 진행 상황은 표준 오류로), 비교하기 쉽도록
+// 항목당(호출당) ns 와 초당 처리 수를 함께 적는다.
+//   slugify, parse            : 항목 수와 상관없는 문자열 처리 (제목 -> ID, 명령 파싱)
+//   create_*, respond_*       : 생성/응답 핸들러 (로그 fsync 는 끔 - 디스크 대신 처리 비용만 봄)
+//   lookup_hit, lookup_miss   : ID 로 항목 찾기 (목록 잠금 + 해시 인덱스)
+//   voter_add, voter_check_*  : 참여자 N 명인 명단에 추가 / 중복 확인 (있는 이름 / 없는 이름)
+//   result_*_render, _cached  : RESULT 핸들러 - 항목마다 첫 요청(결과 문자열을 만들어 캐시)과 그다음 요청
+//   save_*_to_file            : 항목 파일 저장 (fsync 포함)
+//   load_text_files           : 저장한 파일 전체를 새 프로세스에서 다시 읽음 (시작 시 텍스트 가져오기)
+// 항목 수(설문/투표 각각)마다 새 자식 프로세스에서 빈 저장소로 시작하므로 앞 단계의 항목이 남지 않는다.
+// 핸들러의 응답은 socketpair 로 보내고 다른 스레드가 읽어 버림 (응답 전송 시스템 호출까지 포함한 시간).
+// 실행: make bench  (또는 make server_bench && ./bench/server_bench [항목 수,항목 수,...] > result.jsonl)
+#define _XOPEN_SOURCE 700
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <ftw.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include "../include/common.h"
+#include "../src/server/server.h"
+#include "../src/server/request.h"
+#include "../src/server/voter_set.h"
+#include "../src/server/hash.h"
+#include "../src/server/wal.h"
+#include "../src/server/stats.h"
+
+#define DEFAULT_SIZES      "1000,10000,100000"
+#define MAX_SIZES          16
+#define FIXED_ITERATIONS   1000000  // slugify/parse 반복 횟수
+#define LOOKUP_ITERATIONS  1000000
+#define VOTERS_PER_ITEM    4
+
+static FILE* out;          // 결과(JSON 줄) - 표준 출력은 서버 메시지용으로 표준 오류에 돌려 둠
+static volatile size_t sink;
+
+static void emit(const char* bench, long items, long long ops, long long ns) {
+    fprintf(out, "{\"bench\":\"%s\",\"items\":%ld,\"ops\":%lld,\"ns_per_op\":%.1f,\"ops_per_sec\":%.0f}\n",
+            bench, items, ops, ops > 0 ? (double)ns / ops : 0.0, ns > 0 ? ops * 1e9 / ns : 0.0);
+    fflush(out);
+}
+
+// xorshift - 매번 같은 순서로 고르도록 고정 시드
+static uint64_t next_random(uint64_t* state) {
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *state = x;
+}
+
+// 핸들러 응답을 받아 버리는 연결
+static int sink_fds[2];
+
+static void* drain_main(void* arg) {
+    (void)arg;
+    char buf[64 * 1024];
+    while (read(sink_fds[1], buf, sizeof(buf)) > 0) {
+    }
+    return NULL;
+}
+
+static int open_sink(Client* client, pthread_t* tid) {
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sink_fds) < 0) return -1;
+    if (pthread_create(tid, NULL, drain_main, NULL) != 0) return -1;
+    client->fd = sink_fds[0];
+    client->framed = 1;
+    return 0;
+}
+
+static void close_sink(pthread_t tid) {
+    shutdown(sink_fds[0], SHUT_WR);
+    pthread_join(tid, NULL);
+    close(sink_fds[0]);
+    close(sink_fds[1]);
+}
+
+static void bench_slugify(void) {
+    static const char* titles[] = {
+        "Best Programming Language 2024?",
+        "점심 메뉴 투표 - 오늘은 무엇을 먹을까요?",
+        "Ｆｕｌｌｗｉｄｔｈ ＡＳＣＩＩ and emoji 🎉 mixed 제목",
+        "A much longer survey question that keeps going past the point where the slug is cut at the ID length limit",
+    };
+    const int count = sizeof(titles) / sizeof(titles[0]);
+    char id[ID_LENGTH];
+
+    long long start = stats_now_ns();
+    for (int i = 0; i < FIXED_ITERATIONS; i++) {
+        slugify(titles[i % count], id, sizeof(id));
+        sink += (unsigned char)id[0];
+    }
+    emit("slugify", 0, FIXED_ITERATIONS, stats_now_ns() - start);
+}
+
+static void bench_parse(void) {
+    static const char* lines[] = {
+        "RESPOND_SURVEY|best-programming-language-2024|1,3|alice",
+        "RESPOND_VOTE|점심-메뉴-투표|2|bob",
+        "RESULT_SURVEY|best-programming-language-2024|1700000000000001",
+        "LIST_VOTE|-|20|1700000000000001",
+        "CREATE_SURVEY|Best Programming Language 2024?|C,C++,Rust,Go,Zig",
+        "RESPOND_BATCH|S:a:1:u1|V:b:2:u2|S:c:3,4:u3|V:d:1:u4",
+        "NOT_A_COMMAND|x",
+    };
+    const int count = sizeof(lines) / sizeof(lines[0]);
+    size_t lens[sizeof(lines) / sizeof(lines[0])];
+    Request req;
+
+    for (int i = 0; i < count; i++) lens[i] = strlen(lines[i]);
+    long long start = stats_now_ns();
+    for (int i = 0; i < FIXED_ITERATIONS; i++) {
+        request_parse(lines[i % count], lens[i % count], &req);
+        sink += (size_t)req.type + (size_t)req.argc;
+    }
+    emit("parse", 0, FIXED_ITERATIONS, stats_now_ns() - start);
+}
+
+// 참여자 n 명인 명단 하나에서 추가/중복 확인 (큰 설문 하나에 응답이 몰린 경우)
+static void bench_voters(long n) {
+    VoterSet* set = voter_set_create();
+    char name[MAX_USERNAME_LEN];
+    uint64_t rng = 88172645463325252ULL;
+
+    long long start = stats_now_ns();
+    for (long i = 0; i < n; i++) {
+        snprintf(name, sizeof(name), "voter-%ld", i);
+        voter_set_add(set, name, str_hash64(name));
+    }
+    emit("voter_add", n, n, stats_now_ns() - start);
+
+    // 이름 만들기(snprintf)는 재지 않도록 미리 만들어 둠
+    const long probes = n < LOOKUP_ITERATIONS ? n : LOOKUP_ITERATIONS;
+    char (*names)[MAX_USERNAME_LEN] = malloc((size_t)probes * MAX_USERNAME_LEN);
+    if (!names) {
+        voter_set_destroy(set);
+        return;
+    }
+    for (int miss = 0; miss < 2; miss++) {
+        for (long i = 0; i < probes; i++) {
+            snprintf(names[i], MAX_USERNAME_LEN, miss ? "guest-%ld" : "voter-%ld",
+                     (long)(next_random(&rng) % (uint64_t)n));
+        }
+        size_t found = 0;
+        start = stats_now_ns();
+        for (long i = 0; i < probes; i++) {
+            found += (size_t)voter_set_contains(set, names[i], str_hash64(names[i]));
+        }
+        emit(miss ? "voter_check_miss" : "voter_check_hit", n, probes, stats_now_ns() - start);
+        sink += found;
+    }
+    free(names);
+    voter_set_destroy(set);
+}
+
+// 명령 한 줄을 파싱해 핸들러를 바로 호출 (dispatch_command 의 계측은 빼고 핸들러만)
+static void call_handler(Client* client, void (*handler)(Client*, const Request*), const char* line) {
+    Request req;
+    request_parse(line, strlen(line), &req);
+    handler(client, &req);
+}
+
+static void bench_handlers(Client* client, long n) {
+    char line[BUFFER_SIZE];
+    long long start;
+
+    // 제목이 "bench survey <i>" 이면 ID 는 "bench-survey-<i>" (겹치는 ID 가 없으므로 번호가 붙지 않음)
+    start = stats_now_ns();
+    for (long i = 0; i < n; i++) {
+        snprintf(line, sizeof(line), "CREATE_SURVEY|bench survey %ld|red,green,blue,yellow", i);
+        call_handler(client, create_survey_handler, line);
+    }
+    emit("create_survey", n, n, stats_now_ns() - start);
+    start = stats_now_ns();
+    for (long i = 0; i < n; i++) {
+        snprintf(line, sizeof(line), "CREATE_VOTE|bench vote %ld|yes,no,abstain", i);
+        call_handler(client, create_vote_handler, line);
+    }
+    emit("create_vote", n, n, stats_now_ns() - start);
+
+    if (!find_survey("bench-survey-0") || !find_vote("bench-vote-0")) {
+        fprintf(stderr, "created items have unexpected IDs\n");
+        exit(EXIT_FAILURE);
+    }
+
+    start = stats_now_ns();
+    for (int v = 0; v < VOTERS_PER_ITEM; v++) {
+        for (long i = 0; i < n; i++) {
+            snprintf(line, sizeof(line), "RESPOND_SURVEY|bench-survey-%ld|%d,%d|user-%d", i, v % 4 + 1, (v + 1) % 4 + 1, v);
+            call_handler(client, respond_survey_handler, line);
+        }
+    }
+    emit("respond_survey", n, n * VOTERS_PER_ITEM, stats_now_ns() - start);
+    start = stats_now_ns();
+    for (int v = 0; v < VOTERS_PER_ITEM; v++) {
+        for (long i = 0; i < n; i++) {
+            snprintf(line, sizeof(line), "RESPOND_VOTE|bench-vote-%ld|%d|user-%d", i, v % 3 + 1, v);
+            call_handler(client, respond_vote_handler, line);
+        }
+    }
+    emit("respond_vote", n, n * VOTERS_PER_ITEM, stats_now_ns() - start);
+
+    // 조회할 ID 를 미리 만들어 두고 고정 시드로 고름
+    const long probes = LOOKUP_ITERATIONS;
+    char (*ids)[ID_LENGTH] = malloc((size_t)probes * ID_LENGTH);
+    uint64_t rng = 2463534242ULL;
+    if (!ids) exit(EXIT_FAILURE);
+    for (int miss = 0; miss < 2; miss++) {
+        for (long i = 0; i < probes; i++) {
+            long k = (long)(next_random(&rng) % (uint64_t)n);
+            if (i % 2 == 0) snprintf(ids[i], ID_LENGTH, miss ? "bench-survey-x%ld" : "bench-survey-%ld", k);
+            else            snprintf(ids[i], ID_LENGTH, miss ? "bench-vote-x%ld" : "bench-vote-%ld", k);
+        }
+        size_t found = 0;
+        start = stats_now_ns();
+        for (long i = 0; i < probes; i += 2) {
+            found += find_survey(ids[i]) != NULL;
+            found += find_vote(ids[i + 1]) != NULL;
+        }
+        emit(miss ? "lookup_miss" : "lookup_hit", n, probes, stats_now_ns() - start);
+        sink += found;
+    }
+
+    // RESULT 요청을 미리 파싱해 두고 핸들러만 잼 - 첫 바퀴는 결과 문자열을 만들고, 둘째 바퀴는 캐시를 보냄
+    Request* reqs = malloc((size_t)n * sizeof(Request));
+    char (*lines)[ID_LENGTH + 32] = malloc((size_t)n * (ID_LENGTH + 32));
+    if (!reqs || !lines) exit(EXIT_FAILURE);
+    for (int kind = 0; kind < 2; kind++) {
+        void (*handler)(Client*, const Request*) = kind == 0 ? result_survey_handler : result_vote_handler;
+        for (long i = 0; i < n; i++) {
+            snprintf(lines[i], ID_LENGTH + 32, kind == 0 ? "RESULT_SURVEY|bench-survey-%ld" : "RESULT_VOTE|bench-vote-%ld", i);
+            request_parse(lines[i], strlen(lines[i]), &reqs[i]);
+        }
+        for (int pass = 0; pass < 2; pass++) {
+            start = stats_now_ns();
+            for (long i = 0; i < n; i++) {
+                handler(client, &reqs[i]);
+            }
+            char name[32];
+            snprintf(name, sizeof(name), "result_%s_%s", kind == 0 ? "survey" : "vote", pass == 0 ? "render" : "cached");
+            emit(name, n, n, stats_now_ns() - start);
+        }
+    }
+    free(lines);
+    free(reqs);
+    free(ids);
+
+    // 항목 파일 저장 - 다음 단계(load_text_files)가 이 파일들을 읽음
+    start = stats_now_ns();
+    for (long i = 0; i < n; i++) {
+        snprintf(line, sizeof(line), "bench-survey-%ld", i);
+        if (save_survey_to_file(find_survey(line)) < 0) exit(EXIT_FAILURE);
+    }
+    emit("save_survey_to_file", n, n, stats_now_ns() - start);
+    start = stats_now_ns();
+    for (long i = 0; i < n; i++) {
+        snprintf(line, sizeof(line), "bench-vote-%ld", i);
+        if (save_vote_to_file(find_vote(line)) < 0) exit(EXIT_FAILURE);
+    }
+    emit("save_vote_to_file", n, n, stats_now_ns() - start);
+}
+
+// 자식 프로세스 1: 빈 데이터 디렉토리로 복구(로그 열기)까지 한 뒤 항목 n 개씩을 만들고 잼
+static void run_dataset(long n) {
+    Client client = { .fd = -1, .framed = 1 };
+    pthread_t drain;
+
+    if (recover_data(0) < 0 || wal_set_sync_policy(WAL_SYNC_NONE, 0) < 0) {
+        fprintf(stderr, "failed to open write-ahead log\n");
+        exit(EXIT_FAILURE);
+    }
+    if (open_sink(&client, &drain) < 0) {
+        perror("failed to open reply sink");
+        exit(EXIT_FAILURE);
+    }
+    bench_handlers(&client, n);
+    close_sink(drain);
+    bench_voters(n);
+}
+
+// 자식 프로세스 2: 빈 저장소에서 자식 1 이 저장한 파일을 다시 읽음
+static void run_load(long n) {
+    item_store_init();
+    long long start = stats_now_ns();
+    load_text_files();
+    emit("load_text_files", n, 2 * n, stats_now_ns() - start);
+
+    char id[ID_LENGTH];
+    snprintf(id, sizeof(id), "bench-survey-%ld", n - 1);
+    Survey* survey = find_survey(id);
+    if (!survey || survey->voter_count != VOTERS_PER_ITEM || !find_vote("bench-vote-0")) {
+        fprintf(stderr, "loaded items do not match the saved ones\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+static int run_child(void (*fn)(long), long n) {
+    int status;
+    fflush(out);
+    fflush(stderr);
+    pid_t pid = fork();
+    if (pid < 0) return -1;
+    if (pid == 0) {
+        fn(n);
+        fflush(out);
+        _exit(EXIT_SUCCESS);
+    }
+    if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) return -1;
+    return 0;
+}
+
+static int remove_entry(const char* path, const struct stat* st, int flag, struct FTW* ftw) {
+    (void)st;
+    (void)flag;
+    (void)ftw;
+    return remove(path);
+}
+
+int main(int argc, char* argv[]) {
+    long sizes[MAX_SIZES];
+    int size_count = 0;
+    char list[256];
+    char dir[] = "/tmp/server_bench.XXXXXX";
+
+    snprintf(list, sizeof(list), "%s", argc > 1 ? argv[1] : DEFAULT_SIZES);
+    for (char* tok = strtok(list, ","); tok && size_count < MAX_SIZES; tok = strtok(NULL, ",")) {
+        long n = atol(tok);
+        if (n < 1) {
+            fprintf(stderr, "Usage: %s [items,items,...]  (default %s)\n", argv[0], DEFAULT_SIZES);
+            return 2;
+        }
+        sizes[size_count++] = n;
+    }
+
+    // 결과는 원래 표준 출력으로, 서버 코드가 찍는 메시지는 표준 오류로
+    out = fdopen(dup(STDOUT_FILENO), "w");
+    if (!out || dup2(STDERR_FILENO, STDOUT_FILENO) < 0) return 1;
+    if (!mkdtemp(dir) || chdir(dir) < 0) {
+        perror("failed to create work directory");
+        return 1;
+    }
+    request_table_init();
+    stats_init();
+
+    bench_slugify();
+    bench_parse();
+
+    int ret = 0;
+    for (int i = 0; i < size_count && ret == 0; i++) {
+        fprintf(stderr, ">> %ld surveys + %ld votes\n", sizes[i], sizes[i]);
+        mkdir("data", 0755);
+        mkdir("data/survey", 0755);
+        mkdir("data/vote", 0755);
+        if (run_child(run_dataset, sizes[i]) < 0 || run_child(run_load, sizes[i]) < 0) {
+            fprintf(stderr, "benchmark failed at %ld items\n", sizes[i]);
+            ret = 1;
+        }
+        nftw("data", remove_entry, 16, FTW_DEPTH | FTW_PHYS);
+    }
+
+    if (chdir("/") == 0) nftw(dir, remove_entry, 16, FTW_DEPTH | FTW_PHYS);
+    fclose(out);
+    return ret;
+}
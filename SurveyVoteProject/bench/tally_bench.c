@@ -0,0 +1,109 @@
+// tally_bench.c: 결과 읽기/응답 쓰기 혼합 벤치마크
+// 투표 항목 하나에 쓰는 스레드(응답 반영)와 읽는 스레드(RESULT 집계 읽기)를 함께 돌려,
+// 읽는 쪽이 항목 lock 을 잡던 이전 방식(mutex)과 seqlock 으로 잠금 없이 읽는 방식을 비교한다.
+// 읽는 스레드 수를 늘려 가며 초당 읽기/쓰기 횟수를 출력하고, 읽은 사본이 항상 일관된지
+// (득표 합 == 참여자 수) 확인한다.
+// 실행: make tally_bench && ./bench/tally_bench [최대 읽기 스레드 수] [쓰기 스레드 수] [측정 ms]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+#include "../include/common.h"
+#include "../src/server/seqlock.h"
+
+typedef enum { MODE_MUTEX, MODE_SEQLOCK } Mode;
+
+static Vote item;
+static Mode mode;
+static atomic_int running;
+static atomic_ullong reads;
+static atomic_ullong writes;
+static atomic_ullong torn;
+
+// 응답 한 건 반영 - 서버와 같이 항목 lock 안에서 tally_seq 로 감쌈
+static void* writer_main(void* arg) {
+    unsigned long n = 0, idx = (unsigned long)(size_t)arg;
+    while (atomic_load_explicit(&running, memory_order_relaxed)) {
+        pthread_mutex_lock(&item.lock);
+        seqlock_write_begin(&item.tally_seq);
+        item.voter_count++;
+        item.votes[idx++ % MAX_OPTIONS]++;
+        seqlock_write_end(&item.tally_seq);
+        pthread_mutex_unlock(&item.lock);
+        n++;
+    }
+    atomic_fetch_add(&writes, n);
+    return NULL;
+}
+
+static void* reader_main(void* arg) {
+    (void)arg;
+    unsigned long n = 0, bad = 0;
+    int votes[MAX_OPTIONS];
+    int voter_count;
+
+    while (atomic_load_explicit(&running, memory_order_relaxed)) {
+        if (mode == MODE_MUTEX) {
+            pthread_mutex_lock(&item.lock);
+            memcpy(votes, item.votes, sizeof(votes));
+            voter_count = item.voter_count;
+            pthread_mutex_unlock(&item.lock);
+        } else {
+            unsigned start;
+            do {
+                start = seqlock_read_begin(&item.tally_seq);
+                memcpy(votes, item.votes, sizeof(votes));
+                voter_count = item.voter_count;
+            } while (seqlock_read_retry(&item.tally_seq, start));
+        }
+        int total = 0;
+        for (int i = 0; i < MAX_OPTIONS; i++) total += votes[i];
+        if (total != voter_count) bad++;
+        n++;
+    }
+    atomic_fetch_add(&reads, n);
+    atomic_fetch_add(&torn, bad);
+    return NULL;
+}
+
+static void run(Mode m, int readers, int writers, int ms) {
+    pthread_t tids[256];
+    int count = 0;
+
+    memset(&item, 0, sizeof(item));
+    pthread_mutex_init(&item.lock, NULL);
+    mode = m;
+    atomic_store(&running, 1);
+    atomic_store(&reads, 0);
+    atomic_store(&writes, 0);
+    atomic_store(&torn, 0);
+
+    for (int i = 0; i < writers; i++) pthread_create(&tids[count++], NULL, writer_main, (void*)(size_t)i);
+    for (int i = 0; i < readers; i++) pthread_create(&tids[count++], NULL, reader_main, NULL);
+    struct timespec ts = { ms / 1000, (long)(ms % 1000) * 1000000L };
+    nanosleep(&ts, NULL);
+    atomic_store(&running, 0);
+    for (int i = 0; i < count; i++) pthread_join(tids[i], NULL);
+    pthread_mutex_destroy(&item.lock);
+
+    double sec = ms / 1000.0;
+    printf("%-8s %7d %7d %14.0f %14.0f %8llu\n", m == MODE_MUTEX ? "mutex" : "seqlock", readers, writers,
+           atomic_load(&reads) / sec, atomic_load(&writes) / sec, (unsigned long long)atomic_load(&torn));
+}
+
+int main(int argc, char* argv[]) {
+    int max_readers = argc > 1 ? atoi(argv[1]) : 8;
+    int writers = argc > 2 ? atoi(argv[2]) : 2;
+    int ms = argc > 3 ? atoi(argv[3]) : 500;
+    if (max_readers > 128) max_readers = 128;
+    if (writers > 64) writers = 64;
+
+    printf("%-8s %7s %7s %14s %14s %8s\n", "mode", "readers", "writers", "reads/s", "writes/s", "torn");
+    for (int r = 1; r <= max_readers; r *= 2) {
+        run(MODE_MUTEX, r, writers, ms);
+        run(MODE_SEQLOCK, r, writers, ms);
+    }
+    return 0;
+}
@@ -4,6 +4,8 @@
 
 #include <stddef.h>
 #include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
 
 // 설문 질문 또는 투표 제목의 최대 글자 수
 #define MAX_QUESTION_LEN 256
@@ -24,9 +26,11 @@
 // 사용자 이름의 최대 글자 수
 #define MAX_USERNAME_LEN 32
 
-// 하나의 설문이나 투표에서 참여할 수 있는 최대 인원 수
-#define MAX_VOTERS       100
 
+struct VoterSet; // 서버 전용 참여자 해시 집합 (src/server/voter_set.h)
+struct HotItem;  // 서버 전용 응답 샤드 (src/server/hot_item.h)
+struct ReplySlot; // 서버 전용 응답 문자열 캐시 (src/server/reply_cache.h)
+struct SubTopic; // 서버 전용 결과 구독 (src/server/subscription.h)
 
 // 설문 또는 투표가 현재 진행 중인지, 종료되었는지를 나타냄
 typedef enum {
@@ -35,31 +39,69 @@ typedef enum {
 } ItemStatus;
 
 
+// 설문 질문(투표 제목)과 보기 문자열 - 만든 뒤 바뀌지 않고 결과/목록 응답을 만들 때만 읽으므로
+// 항목 본체와 떨어진 별도 저장소(cold)에 둠
+typedef struct ItemText {
+    char title[MAX_QUESTION_LEN];
+    char options[MAX_OPTIONS][MAX_OPTION_LEN];
+} ItemText;
+
+// 항목 본체는 캐시 라인(64바이트) 단위로 정렬하고, 첫 라인에는 응답 반영/집계 읽기/목록 순회가
+// 매번 건드리는 필드만 모음 (hot). 그 뒤에 ID, 잠금과 저장 상태가 오고 (warm), 문자열은 ItemText 에 둠.
+// 본체와 문자열은 종류별 객체 풀(src/server/pool.h)에서 따로 할당하므로, 풀의 64KB 블록에서 차례로 잘려 나온
+// 본체끼리 가깝게 모여 있어 목록을 훑을 때 문자열이 캐시를 차지하지 않음
+
 // Survey 구조체: 하나의 설문에 대한 모든 정보를 담는 구조체
 typedef struct Survey {
-    char id[ID_LENGTH];
-    char question[MAX_QUESTION_LEN];
-    int  option_count;
-    char options[MAX_OPTIONS][MAX_OPTION_LEN];
-    int  votes[MAX_OPTIONS];
+    // --- hot (첫 캐시 라인)
+    atomic_uint tally_seq;                     // votes/voter_count/status 를 바꾸는 동안 홀수 (잠금 없이 읽는 쪽이 확인)
     ItemStatus status;
-    char voters[MAX_VOTERS][MAX_USERNAME_LEN]; // 이 설문에 참여한 사용자들의 이름 목록
+    int  option_count;
     int voter_count;                           // 현재까지 설문에 참여한 인원 수
+    int  votes[MAX_OPTIONS];
+    atomic_uint contention;                    // 지금 구간에서 응답 반영 때 lock 을 바로 잡지 못한 횟수
+    atomic_uint contention_window;             // contention 을 세고 있는 구간 번호 (HOT_ITEM_WINDOW_SHIFT)
+    struct HotItem* _Atomic hot;               // 응답이 몰려 샤드로 전환된 경우 샤드 (아니면 NULL)
     struct Survey* next;
-} Survey;
+    // --- warm
+    char id[ID_LENGTH];
+    struct VoterSet* voters;                   // 참여한 사용자들의 이름 목록 (arena 저장 + 중복 확인용 해시 집합)
+    pthread_mutex_t lock;                      // 이 항목의 집계/상태/참여자 목록을 보호
+    pthread_mutex_t file_lock;                 // 같은 항목의 파일 저장 순서를 보장
+    unsigned long change_seq;                  // 변경될 때마다 증가 (lock 으로 보호)
+    unsigned long saved_seq;                   // 파일에 반영된 마지막 change_seq (file_lock 으로 보호)
+    struct ReplySlot* result_reply;            // 마지막으로 만든 RESULT 응답 (집계 버전별)
+    struct SubTopic* _Atomic subs;             // 결과 구독자 목록 (구독된 적이 없으면 NULL)
+    // --- cold (ItemText 를 가리킴)
+    char* question;                            // MAX_QUESTION_LEN 바이트
+    char (*options)[MAX_OPTION_LEN];           // MAX_OPTIONS 개
+} __attribute__((aligned(64))) Survey;
 
 // Vote 구조체: 하나의 투표에 대한 모든 정보를 담는 구조체
 typedef struct Vote {
-    char id[ID_LENGTH];
-    char title[MAX_QUESTION_LEN];
-    int  option_count;
-    char options[MAX_OPTIONS][MAX_OPTION_LEN];
-    int  votes[MAX_OPTIONS];
+    // --- hot (첫 캐시 라인)
+    atomic_uint tally_seq;                     // votes/voter_count/status 를 바꾸는 동안 홀수 (잠금 없이 읽는 쪽이 확인)
     ItemStatus status;
-    char voters[MAX_VOTERS][MAX_USERNAME_LEN]; // 이 설문에 참여한 사용자들의 이름 목록
+    int  option_count;
     int voter_count;                           // 현재까지 설문에 참여한 인원 수
+    int  votes[MAX_OPTIONS];
+    atomic_uint contention;                    // 지금 구간에서 응답 반영 때 lock 을 바로 잡지 못한 횟수
+    atomic_uint contention_window;             // contention 을 세고 있는 구간 번호 (HOT_ITEM_WINDOW_SHIFT)
+    struct HotItem* _Atomic hot;               // 응답이 몰려 샤드로 전환된 경우 샤드 (아니면 NULL)
     struct Vote* next;
-} Vote;
+    // --- warm
+    char id[ID_LENGTH];
+    struct VoterSet* voters;                   // 참여한 사용자들의 이름 목록 (arena 저장 + 중복 확인용 해시 집합)
+    pthread_mutex_t lock;                      // 이 항목의 집계/상태/참여자 목록을 보호
+    pthread_mutex_t file_lock;                 // 같은 항목의 파일 저장 순서를 보장
+    unsigned long change_seq;                  // 변경될 때마다 증가 (lock 으로 보호)
+    unsigned long saved_seq;                   // 파일에 반영된 마지막 change_seq (file_lock 으로 보호)
+    struct ReplySlot* result_reply;            // 마지막으로 만든 RESULT 응답 (집계 버전별)
+    struct SubTopic* _Atomic subs;             // 결과 구독자 목록 (구독된 적이 없으면 NULL)
+    // --- cold (ItemText 를 가리킴)
+    char* title;                               // MAX_QUESTION_LEN 바이트
+    char (*options)[MAX_OPTION_LEN];           // MAX_OPTIONS 개
+} __attribute__((aligned(64))) Vote;
 
 
 // 클라이언트와 서버가 통신할 때 사용하는 명령어 문자열
@@ -78,5 +120,35 @@ typedef struct Vote {
 #define CMD_LIST_VOTE       "LIST_VOTE"
 #define CMD_CLOSE_VOTE      "CLOSE_VOTE"
 
+// 목록: LIST_SURVEY / LIST_VOTE 는 전체 목록, LIST_*|커서|개수 는 커서("-" 이면 처음부터) 다음 항목부터
+// 개수만큼 보내고 마지막 줄에 "[NEXT] 다음 커서" 또는 "[END]" 를 붙임
+
+// 조건부 조회: RESULT_*|ID|버전, LIST_*|커서|개수|버전, 전체 목록은 LIST_*|*|버전
+// 버전이 지금과 같으면 "[NOT MODIFIED] 버전" 만 보내고, 다르면 보통 응답 끝에 "[VERSION] 지금 버전" 줄을 붙임
+// 서버가 주는 버전은 0 이 아니므로 처음에는 0 을 보내면 됨. 항목 버전은 응답/종료마다, 목록 버전은 항목이 추가/종료될 때 커짐
+
+// 여러 응답을 한 번에 제출: RESPOND_BATCH|종류:ID:보기:사용자|종류:ID:보기:사용자|...
+// 종류는 S(설문, 보기는 쉼표로 여러 개) / V(투표). 응답은 요청 순서대로 한 줄에 한 건씩 결과
+#define CMD_RESPOND_BATCH   "RESPOND_BATCH"
+
+// 결과 구독: SUBSCRIBE_SURVEY|ID[|간격ms] / SUBSCRIBE_VOTE|ID[|간격ms]
+// "[OK] Subscribed to ..." 응답 뒤 연결은 구독 전용이 되어, 지금 결과와 이후 바뀐 결과(RESULT_* 응답과 같은 형식)를
+// 서버가 먼저 보낸다. 결과는 간격(기본 200ms)보다 자주 보내지 않고 그 사이의 변경은 최신 결과 하나로 합친다.
+// 구독 뒤에 보낸 명령은 처리하지 않으며, 구독을 끝내려면 연결을 닫는다. 결과 경계를 알 수 있도록 프레임 방식을 권장
+#define CMD_SUBSCRIBE_SURVEY "SUBSCRIBE_SURVEY"
+#define CMD_SUBSCRIBE_VOTE   "SUBSCRIBE_VOTE"
+
+// 서버 상태: STATS - 명령별 처리 횟수와 지연 시간 분포(평균, p50/p99/p99.9, 최대), 항목 lock 대기/보유 시간,
+// 항목 파일 저장 시간, 연결/스레드 수, 로그(WAL)와 구독 현황을 여러 줄로 응답
+#define CMD_STATS           "STATS"
+
+
+// 메시지 프레임: [본문 길이 4바이트, big-endian][본문]
+// 연결의 첫 바이트가 0x00 이면(본문 길이가 16MB 미만이므로 항상 그러함) 서버는 그 연결을 프레임 방식으로 처리하고
+// 응답에도 같은 머리를 붙인다. 프레임 방식에서는 응답을 기다리지 않고 여러 명령을 이어 보낼 수 있으며(pipelining),
+// 응답은 보낸 순서대로 돌아온다. 첫 바이트가 다른 값이면 recv() 한 번에 명령 하나로 보는 기존 방식으로 동작.
+#define FRAME_HEADER_LEN    4
+#define MAX_FRAME_LEN       (64 * 1024)
+
 
 #endif  // SURVEY_VOTE_COMMON_H
\ No newline at end of file
@@ -3,11 +3,16 @@
 #include <string.h>
 #include <unistd.h>
 #include <arpa/inet.h>
+#include <errno.h>
 #include "../include/common.h"
 
 #define SERVER_IP   "127.0.0.1"
 #define SERVER_PORT 9000
 
+// 목록을 한 번에 요청하는 항목 수와 그 응답을 받을 버퍼 크기 (한 줄은 ID + 제목 + 30바이트 이하)
+#define LIST_PAGE_SIZE   20
+#define LIST_PAGE_BUFFER (LIST_PAGE_SIZE * (ID_LENGTH + MAX_QUESTION_LEN + 32) + ID_LENGTH + 16)
+
 // 사용자 이름을 저장하기 위한 전역 변수
 char my_username[MAX_USERNAME_LEN];
 
@@ -34,6 +39,65 @@ void handle_close_survey(int sockfd);
 // 특정 투표를 종료하도록 서버에 요청
 void handle_close_vote(int sockfd);
 
+// len 바이트를 모두 보낼 때까지 반복 - 실패 시 -1
+static int write_all(int sockfd, const void* buf, size_t len) {
+    const char* p = buf;
+    while (len > 0) {
+        ssize_t n = send(sockfd, p, len, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        p += n;
+        len -= n;
+    }
+    return 0;
+}
+
+// len 바이트를 모두 받을 때까지 반복 - 연결이 끊기면 -1
+static int read_all(int sockfd, void* buf, size_t len) {
+    char* p = buf;
+    while (len > 0) {
+        ssize_t n = recv(sockfd, p, len, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        p += n;
+        len -= n;
+    }
+    return 0;
+}
+
+// 명령 하나를 길이 머리를 붙인 프레임으로 전송
+static int send_command(int sockfd, const char* msg) {
+    size_t len = strlen(msg);
+    unsigned char frame[FRAME_HEADER_LEN + BUFFER_SIZE];
+
+    if (len > BUFFER_SIZE) len = BUFFER_SIZE;
+    frame[0] = (unsigned char)(len >> 24);
+    frame[1] = (unsigned char)(len >> 16);
+    frame[2] = (unsigned char)(len >> 8);
+    frame[3] = (unsigned char)len;
+    memcpy(frame + FRAME_HEADER_LEN, msg, len);
+    return write_all(sockfd, frame, FRAME_HEADER_LEN + len);
+}
+
+// 응답 프레임 하나를 끝까지 받아 buf 에 담음 (size 를 넘는 부분은 읽고 버림)
+// 반환값: buf 에 담은 길이, 연결이 끊겼거나 오류면 -1
+static int recv_reply(int sockfd, char* buf, size_t size) {
+    unsigned char header[FRAME_HEADER_LEN];
+    char discard[BUFFER_SIZE];
+
+    if (read_all(sockfd, header, sizeof(header)) < 0) return -1;
+    size_t len = ((size_t)header[0] << 24) | ((size_t)header[1] << 16) |
+                 ((size_t)header[2] << 8) | header[3];
+    size_t keep = len < size ? len : size;
+    if (read_all(sockfd, buf, keep) < 0) return -1;
+    for (size_t rest = len - keep; rest > 0;) {
+        size_t chunk = rest < sizeof(discard) ? rest : sizeof(discard);
+        if (read_all(sockfd, discard, chunk) < 0) return -1;
+        rest -= chunk;
+    }
+    return (int)keep;
+}
+
 // 클라이언트 프로그램의 진입점 - 서버에 연결하고 사용자 메뉴를 보여줌
 int main() {
     int sockfd;
@@ -145,9 +209,9 @@ void handle_respond_survey(int sockfd) {
     
     // 서버에 결과 요청
     snprintf(buffer, sizeof(buffer), "%s|%s", CMD_RESULT_SURVEY, survey_id);
-    send(sockfd, buffer, strlen(buffer), 0);
+    send_command(sockfd, buffer);
     // 서버로부터 옵션 목록 받기
-    bytes = recv(sockfd, buffer, sizeof(buffer) - 1, 0);
+    bytes = recv_reply(sockfd, buffer, sizeof(buffer) - 1);
     if (bytes > 0) {
         buffer[bytes] = '\0';
         if (strncmp(buffer, "[ERROR]", 7) == 0) {
@@ -168,10 +232,10 @@ void handle_respond_survey(int sockfd) {
     // 서버에 응답 전송
     snprintf(buffer, sizeof(buffer), "%s|%s|%s|%s",
              CMD_RESPOND_SURVEY, survey_id, opt_input, my_username);
-    send(sockfd, buffer, strlen(buffer), 0);
+    send_command(sockfd, buffer);
 
     // 서버로부터 처리 결과 받기
-    bytes = recv(sockfd, buffer, sizeof(buffer) - 1, 0);
+    bytes = recv_reply(sockfd, buffer, sizeof(buffer) - 1);
     if (bytes > 0) {
         buffer[bytes] = '\0';
         printf("Server> %s\n", buffer);
@@ -192,9 +256,9 @@ void handle_respond_vote(int sockfd) {
 
     // 서버에 결과 요청
     snprintf(buffer, sizeof(buffer), "%s|%s", CMD_RESULT_VOTE, vote_id);
-    send(sockfd, buffer, strlen(buffer), 0);
+    send_command(sockfd, buffer);
     // 서버로부터 옵션 목록 받기
-    bytes = recv(sockfd, buffer, sizeof(buffer) - 1, 0);
+    bytes = recv_reply(sockfd, buffer, sizeof(buffer) - 1);
     if (bytes > 0) {
         buffer[bytes] = '\0';
         if (strncmp(buffer, "[ERROR]", 7) == 0) {
@@ -227,10 +291,10 @@ void handle_respond_vote(int sockfd) {
     // 서버에 응답 전송
     snprintf(buffer, sizeof(buffer), "%s|%s|%s|%s",
              CMD_RESPOND_VOTE, vote_id, opt_input, my_username);
-    send(sockfd, buffer, strlen(buffer), 0);
+    send_command(sockfd, buffer);
 
     // 서버로부터 처리 결과 받기
-    bytes = recv(sockfd, buffer, sizeof(buffer) - 1, 0);
+    bytes = recv_reply(sockfd, buffer, sizeof(buffer) - 1);
     if (bytes > 0) {
         buffer[bytes] = '\0';
         printf("Server> %s\n", buffer);
@@ -247,9 +311,9 @@ void handle_close_survey(int sockfd) {
     survey_id[strcspn(survey_id, "\n")] = '\0';
 
     snprintf(buffer, sizeof(buffer), "%s|%s", CMD_CLOSE_SURVEY, survey_id);
-    send(sockfd, buffer, strlen(buffer), 0);
+    send_command(sockfd, buffer);
 
-    int bytes = recv(sockfd, buffer, sizeof(buffer) - 1, 0);
+    int bytes = recv_reply(sockfd, buffer, sizeof(buffer) - 1);
     if (bytes > 0) {
         buffer[bytes] = '\0';
         printf("Server> %s\n", buffer);
@@ -266,9 +330,9 @@ void handle_close_vote(int sockfd) {
     vote_id[strcspn(vote_id, "\n")] = '\0';
 
     snprintf(buffer, sizeof(buffer), "%s|%s", CMD_CLOSE_VOTE, vote_id);
-    send(sockfd, buffer, strlen(buffer), 0);
+    send_command(sockfd, buffer);
 
-    int bytes = recv(sockfd, buffer, sizeof(buffer) - 1, 0);
+    int bytes = recv_reply(sockfd, buffer, sizeof(buffer) - 1);
     if (bytes > 0) {
         buffer[bytes] = '\0';
         printf("Server> %s\n", buffer);
@@ -305,9 +369,9 @@ void handle_create_survey(int sockfd) {
 
     snprintf(buffer, sizeof(buffer), "%s|%s|%s",
              CMD_CREATE_SURVEY, question, options_csv);
-    send(sockfd, buffer, strlen(buffer), 0);
+    send_command(sockfd, buffer);
 
-    int bytes = recv(sockfd, buffer, sizeof(buffer) - 1, 0);
+    int bytes = recv_reply(sockfd, buffer, sizeof(buffer) - 1);
     if (bytes > 0) {
         buffer[bytes] = '\0';
         printf("Server> %s\n", buffer);
@@ -325,9 +389,9 @@ void handle_result_survey(int sockfd) {
 
     snprintf(buffer, sizeof(buffer), "%s|%s",
              CMD_RESULT_SURVEY, survey_id);
-    send(sockfd, buffer, strlen(buffer), 0);
+    send_command(sockfd, buffer);
 
-    int bytes = recv(sockfd, buffer, sizeof(buffer) - 1, 0);
+    int bytes = recv_reply(sockfd, buffer, sizeof(buffer) - 1);
     if (bytes > 0) {
         buffer[bytes] = '\0';
         printf("Server> %s\n", buffer);
@@ -364,9 +428,9 @@ void handle_create_vote(int sockfd) {
 
     snprintf(buffer, sizeof(buffer), "%s|%s|%s",
              CMD_CREATE_VOTE, title, options_csv);
-    send(sockfd, buffer, strlen(buffer), 0);
+    send_command(sockfd, buffer);
 
-    int bytes = recv(sockfd, buffer, sizeof(buffer) - 1, 0);
+    int bytes = recv_reply(sockfd, buffer, sizeof(buffer) - 1);
     if (bytes > 0) {
         buffer[bytes] = '\0';
         printf("Server> %s\n", buffer);
@@ -384,35 +448,56 @@ void handle_result_vote(int sockfd) {
 
     snprintf(buffer, sizeof(buffer), "%s|%s",
              CMD_RESULT_VOTE, vote_id);
-    send(sockfd, buffer, strlen(buffer), 0);
+    send_command(sockfd, buffer);
 
-    int bytes = recv(sockfd, buffer, sizeof(buffer) - 1, 0);
+    int bytes = recv_reply(sockfd, buffer, sizeof(buffer) - 1);
     if (bytes > 0) {
         buffer[bytes] = '\0';
         printf("Server> %s\n", buffer);
     }
 }
 
+// 목록을 한 쪽씩 받아 출력 - 응답 끝 줄이 "[NEXT] 커서" 이면 그 커서로 다음 쪽을 요청하고, "[END]" 이면 끝
+static void print_list_pages(int sockfd, const char* command, const char* empty) {
+    static char page[LIST_PAGE_BUFFER];
+    char request[BUFFER_SIZE];
+    char cursor[ID_LENGTH] = "-";
+    int printed = 0;
+
+    for (;;) {
+        snprintf(request, sizeof(request), "%s|%s|%d", command, cursor, LIST_PAGE_SIZE);
+        if (send_command(sockfd, request) < 0) return;
+        int bytes = recv_reply(sockfd, page, sizeof(page) - 1);
+        if (bytes <= 0) return;
+        page[bytes] = '\0';
+
+        // 마지막 줄(끝 표시)을 떼어 냄
+        if (bytes > 0 && page[bytes - 1] == '\n') page[--bytes] = '\0';
+        char* last = strrchr(page, '\n');
+        char* trailer = last ? last + 1 : page;
+        if (strncmp(trailer, "[NEXT] ", 7) != 0 && strcmp(trailer, "[END]") != 0) {
+            printf("%s\n", page); // 오류 응답
+            return;
+        }
+        if (last) {
+            *last = '\0';
+            printf("%s\n", page);
+            printed = 1;
+        }
+        if (trailer[1] == 'E') break;
+        snprintf(cursor, sizeof(cursor), "%s", trailer + 7);
+    }
+    if (!printed) printf("%s\n", empty);
+}
+
 // 설문 목록 요청 및 출력
 void handle_list_survey(int sockfd) {
-    char buffer[BUFFER_SIZE];
-    snprintf(buffer, sizeof(buffer), "%s", CMD_LIST_SURVEY);
-    send(sockfd, buffer, strlen(buffer), 0);
-    int bytes = recv(sockfd, buffer, sizeof(buffer) - 1, 0);
-    if (bytes > 0) {
-        buffer[bytes] = '\0';
-        printf("--- 설문 목록 ---\n%s", buffer);
-    }
+    printf("--- 설문 목록 ---\n");
+    print_list_pages(sockfd, CMD_LIST_SURVEY, "No surveys available.");
 }
 
 // 투표 목록 요청 및 출력
 void handle_list_vote(int sockfd) {
-    char buffer[BUFFER_SIZE];
-    snprintf(buffer, sizeof(buffer), "%s", CMD_LIST_VOTE);
-    send(sockfd, buffer, strlen(buffer), 0);
-    int bytes = recv(sockfd, buffer, sizeof(buffer) - 1, 0);
-    if (bytes > 0) {
-        buffer[bytes] = '\0';
-        printf("--- 투표 목록 ---\n%s", buffer);
-    }
+    printf("--- 투표 목록 ---\n");
+    print_list_pages(sockfd, CMD_LIST_VOTE, "No votes available.");
 }
\ No newline at end of file
@@ -0,0 +1,51 @@
+// frame_buffer.c: 길이 접두 프레임 재조립
+// TCP 는 경계를 보존하지 않으므로 한 번의 recv() 에 프레임 여러 개나 프레임 일부가 섞여 올 수 있다.
+// 받은 바이트를 이어 붙여 두고 [길이][본문]이 모두 모인 프레임만 순서대로 꺼낸다.
+#include <stdlib.h>
+#include <string.h>
+#include "server.h"
+#include "pool.h"
+
+int frame_buffer_append(FrameBuffer* fb, const char* data, size_t len) {
+    // 이미 꺼낸 앞부분은 당겨서 재사용
+    if (fb->start > 0) {
+        memmove(fb->data, fb->data + fb->start, fb->len - fb->start);
+        fb->len -= fb->start;
+        fb->start = 0;
+    }
+    // 버퍼는 I/O 버퍼 풀에서 꺼내므로, 늘릴 때는 더 큰 등급으로 옮겨 담고 이전 것을 돌려줌
+    if (fb->len + len > fb->cap) {
+        size_t cap = fb->cap ? fb->cap : BUFFER_SIZE;
+        while (cap < fb->len + len) cap *= 2;
+        cap = buffer_capacity(cap);
+        char* grown = buffer_alloc(cap);
+        if (!grown) return -1;
+        if (fb->len > 0) memcpy(grown, fb->data, fb->len);
+        buffer_free(fb->data, fb->cap);
+        fb->data = grown;
+        fb->cap = cap;
+    }
+    memcpy(fb->data + fb->len, data, len);
+    fb->len += len;
+    return 0;
+}
+
+int frame_buffer_next(FrameBuffer* fb, const char** payload, size_t* len) {
+    size_t avail = fb->len - fb->start;
+    if (avail < FRAME_HEADER_LEN) return 0;
+
+    const unsigned char* h = (const unsigned char*)fb->data + fb->start;
+    size_t body = ((size_t)h[0] << 24) | ((size_t)h[1] << 16) | ((size_t)h[2] << 8) | h[3];
+    if (body > MAX_FRAME_LEN) return -1;
+    if (avail - FRAME_HEADER_LEN < body) return 0;
+
+    *payload = fb->data + fb->start + FRAME_HEADER_LEN;
+    *len = body;
+    fb->start += FRAME_HEADER_LEN + body;
+    return 1;
+}
+
+void frame_buffer_free(FrameBuffer* fb) {
+    buffer_free(fb->data, fb->cap);
+    memset(fb, 0, sizeof(*fb));
+}
@@ -0,0 +1,20 @@
+// hash.h: 서버 자료구조들이 함께 쓰는 문자열 해시 함수
+#ifndef SURVEY_VOTE_HASH_H
+#define SURVEY_VOTE_HASH_H
+
+#include <stdint.h>
+
+// FNV-1a 64비트 해시 + 하위 비트가 고르게 섞이도록 마지막에 한 번 더 섞음
+static inline uint64_t str_hash64(const char* s) {
+    uint64_t h = 14695981039346656037ULL;
+    while (*s) {
+        h ^= (unsigned char)*s++;
+        h *= 1099511628211ULL;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h;
+}
+
+#endif  // SURVEY_VOTE_HASH_H
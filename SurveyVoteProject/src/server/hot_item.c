@@ -0,0 +1,143 @@
+// hot_item.c: 응답이 몰리는 항목의 샤드 관리
+// 샤드로 전환된 항목에서는 응답이 항목 lock 대신 이름 해시로 고른 샤드 잠금만 잡으므로,
+// 서로 다른 사용자의 응답은 코어 수만큼 동시에 반영된다. 전환 이전 참여자는 항목 본체의
+// 명단에 그대로 있고 (샤드가 있는 동안에는 합치기 말고는 바뀌지 않음), 체크포인트 때
+// 샤드 내용을 본체로 합쳐 파일/스냅샷 저장 코드는 샤드를 몰라도 되게 한다.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "hot_item.h"
+#include "hash.h"
+#include "seqlock.h"
+
+static size_t shard_count_for_cores(void) {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t n = 2;
+    while (n < (size_t)(cores > 0 ? cores : 1) * 2 && n < HOT_ITEM_MAX_SHARDS) n *= 2;
+    return n;
+}
+
+HotItem* hot_item_create(void) {
+    size_t n = shard_count_for_cores();
+    HotItem* hot = NULL;
+
+    if (posix_memalign((void**)&hot, 64, sizeof(HotItem) + n * sizeof(HotShard)) != 0) return NULL;
+    memset(hot, 0, sizeof(HotItem) + n * sizeof(HotShard));
+    hot->shard_count = n;
+    for (size_t i = 0; i < n; i++) {
+        pthread_mutex_init(&hot->shards[i].lock, NULL);
+        hot->shards[i].voters = voter_set_create();
+        if (!hot->shards[i].voters) {
+            while (i-- > 0) voter_set_destroy(hot->shards[i].voters);
+            free(hot);
+            return NULL;
+        }
+    }
+    return hot;
+}
+
+void hot_item_lock_all(HotItem* hot) {
+    for (size_t i = 0; i < hot->shard_count; i++) pthread_mutex_lock(&hot->shards[i].lock);
+}
+
+void hot_item_unlock_all(HotItem* hot) {
+    for (size_t i = hot->shard_count; i-- > 0;) pthread_mutex_unlock(&hot->shards[i].lock);
+}
+
+int hot_item_fold(HotItem* hot, VoterSet* base, int* votes, int* voter_count, atomic_uint* base_seq, size_t* moved) {
+    int ret = 0;
+
+    *moved = 0;
+    seqlock_write_begin(base_seq);
+    for (size_t i = 0; i < hot->shard_count; i++) {
+        HotShard* shard = &hot->shards[i];
+        if (shard->voter_count == 0) continue;
+
+        // 본체에 다 옮기지 못하면 (메모리 부족) 샤드를 그대로 두고 다음 합치기에서 다시 시도
+        // 이미 옮긴 이름은 본체 명단 뒤쪽(voter_count 밖)에 남지만, 다시 옮길 때 건너뛰므로 중복되지 않음
+        VoterSet* fresh = voter_set_create();
+        if (!fresh) {
+            ret = -1;
+            break;
+        }
+        VoterIter it;
+        const char* name;
+        int complete = 1;
+        voter_iter_init(&it, shard->voters);
+        while ((name = voter_iter_next(&it)) != NULL) {
+            uint64_t hash = str_hash64(name);
+            if (!voter_set_contains(base, name, hash) && !voter_set_add(base, name, hash)) {
+                complete = 0;
+                break;
+            }
+        }
+        if (!complete) {
+            voter_set_destroy(fresh);
+            ret = -1;
+            break;
+        }
+
+        seqlock_write_begin(&shard->tally_seq);
+        for (int k = 0; k < MAX_OPTIONS; k++) {
+            votes[k] += shard->votes[k];
+            shard->votes[k] = 0;
+        }
+        *voter_count += shard->voter_count;
+        *moved += shard->voter_count;
+        shard->voter_count = 0;
+        voter_set_destroy(shard->voters);
+        shard->voters = fresh;
+        seqlock_write_end(&shard->tally_seq);
+    }
+    seqlock_write_end(base_seq);
+    return ret;
+}
+
+// 샤드마다 따로 일관된 값을 읽어 더하고, 각 샤드를 읽은 시점의 tally_seq 를 seqs 에 적어 둠
+static void sum_shards(HotItem* hot, int* votes, int* voter_count, unsigned* seqs) {
+    memset(votes, 0, MAX_OPTIONS * sizeof(int));
+    *voter_count = 0;
+    for (size_t i = 0; i < hot->shard_count; i++) {
+        HotShard* shard = &hot->shards[i];
+        int shard_votes[MAX_OPTIONS];
+        int shard_voters;
+        unsigned start;
+        do {
+            start = seqlock_read_begin(&shard->tally_seq);
+            memcpy(shard_votes, shard->votes, sizeof(shard_votes));
+            shard_voters = shard->voter_count;
+        } while (seqlock_read_retry(&shard->tally_seq, start));
+        seqs[i] = start;
+        for (int k = 0; k < MAX_OPTIONS; k++) votes[k] += shard_votes[k];
+        *voter_count += shard_voters;
+    }
+}
+
+// 다 읽은 뒤 모든 샤드의 tally_seq 가 읽을 때 그대로면 1 - 그러면 마지막 샤드를 읽은 때와 이 확인 사이의
+// 한 시점에 모든 샤드가 읽은 값이었으므로, 서로 다른 시점의 샤드 값을 섞어 더한 것이 아님
+static int shards_unchanged(HotItem* hot, const unsigned* seqs) {
+    for (size_t i = 0; i < hot->shard_count; i++) {
+        if (seqlock_read_retry(&hot->shards[i].tally_seq, seqs[i])) return 0;
+    }
+    return 1;
+}
+
+void hot_item_add_tally(HotItem* hot, int* votes, int* voter_count) {
+    int sum_votes[MAX_OPTIONS];
+    int sum_voters;
+    unsigned seqs[HOT_ITEM_MAX_SHARDS];
+    int consistent = 0;
+
+    for (int attempt = 0; attempt < HOT_ITEM_READ_RETRIES && !consistent; attempt++) {
+        sum_shards(hot, sum_votes, &sum_voters, seqs);
+        consistent = shards_unchanged(hot, seqs);
+    }
+    if (!consistent) {
+        hot_item_lock_all(hot);
+        sum_shards(hot, sum_votes, &sum_voters, seqs);
+        hot_item_unlock_all(hot);
+    }
+    for (int k = 0; k < MAX_OPTIONS; k++) votes[k] += sum_votes[k];
+    *voter_count += sum_voters;
+}
@@ -0,0 +1,58 @@
+// hot_item.h: 응답이 한 항목에 몰릴 때 쓰는 샤드 - 참여자 명단과 집계를 이름 해시로 나눠 따로 잠금
+#ifndef SURVEY_VOTE_HOT_ITEM_H
+#define SURVEY_VOTE_HOT_ITEM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "../include/common.h"
+#include "voter_set.h"
+
+// 한 구간 안에서 항목 lock 경합이 이 횟수에 이르면 그 항목을 샤드 방식으로 전환 (되돌리지는 않음)
+#define HOT_ITEM_CONTENTION 1024
+// 경합을 세는 구간 - 단조 시각(ns)을 이만큼 밀어 구간 번호로 씀 (약 1초). 구간이 바뀌면 다시 셈
+#define HOT_ITEM_WINDOW_SHIFT 30
+// 샤드 수 상한 - 실제 수는 코어 수의 두 배 이상인 2의 거듭제곱
+#define HOT_ITEM_MAX_SHARDS 64
+// 샤드 집계를 잠금 없이 읽다가 다시 읽는 횟수 상한 - 넘으면 모든 샤드를 잡고 읽음
+#define HOT_ITEM_READ_RETRIES 8
+
+// 같은 이름은 항상 같은 샤드로 가므로 중복 확인은 그 샤드 안에서만 하면 됨
+// 샤드끼리 캐시 라인을 나눠 쓰지 않도록 정렬
+typedef struct HotShard {
+    pthread_mutex_t lock;
+    atomic_uint tally_seq;   // 집계를 바꾸는 동안 홀수 (항목의 tally_seq 와 같은 규칙)
+    int voter_count;
+    int votes[MAX_OPTIONS];
+    VoterSet* voters;        // 샤드로 전환된 뒤 들어온 참여자
+} __attribute__((aligned(64))) HotShard;
+
+typedef struct HotItem {
+    size_t   shard_count;    // 2의 거듭제곱
+    HotShard shards[];
+} HotItem;
+
+HotItem* hot_item_create(void);
+
+// 이름 해시로 샤드 선택 - VoterSet 이 하위 비트로 칸을 고르므로 샤드는 다른 비트로 나눔
+static inline HotShard* hot_item_shard(HotItem* hot, uint64_t hash) {
+    return &hot->shards[(hash >> 40) & (hot->shard_count - 1)];
+}
+
+// 상태 변경(종료)과 합치기는 모든 샤드를 잡고 수행 - 항상 0번부터 순서대로 잡음
+void hot_item_lock_all(HotItem* hot);
+void hot_item_unlock_all(HotItem* hot);
+
+// 샤드에 쌓인 참여자와 집계를 항목 본체(base)로 옮기고 샤드를 비움 - 옮긴 참여자 수를 moved 에 채움
+// 항목 lock 과 모든 샤드 잠금을 잡은 상태에서 호출. base_seq 로 감싸므로 읽는 쪽은 옮기는 중간을 보지 않음
+// 메모리가 부족해 옮기지 못한 샤드가 남으면 -1 - 본체에는 일부 응답만 있으므로 호출자는 본체만으로
+// 스냅샷을 확정해서는 안 됨 (남은 샤드는 그대로 집계되고 다음 합치기에서 다시 옮김)
+int hot_item_fold(HotItem* hot, VoterSet* base, int* votes, int* voter_count, atomic_uint* base_seq, size_t* moved);
+
+// 모든 샤드의 집계를 한 시점의 값으로 읽어 votes/voter_count 에 더함 - 샤드를 다 읽은 뒤 어느 샤드의 tally_seq 도
+// 바뀌지 않았을 때만 받아들이므로 쓰는 쪽은 자기 샤드 말고는 건드리지 않음. HOT_ITEM_READ_RETRIES 번 안에
+// 못 맞추면 모든 샤드 잠금을 잡고 읽음 (응답이 끊이지 않아도 끝남)
+void hot_item_add_tally(HotItem* hot, int* votes, int* voter_count);
+
+#endif  // SURVEY_VOTE_HOT_ITEM_H
@@ -0,0 +1,125 @@
+// id_registry.c: linear probing 방식의 ID 기록 - 항목은 삭제되지 않으므로 삭제 처리는 없다
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "id_registry.h"
+#include "hash.h"
+
+#define INITIAL_CAPACITY 64
+
+static IdEntry* find_entry(const IdRegistry* reg, const char* id, uint64_t hash) {
+    if (reg->capacity == 0) return NULL;
+    size_t mask = reg->capacity - 1;
+    for (size_t pos = hash & mask; reg->slots[pos].id[0]; pos = (pos + 1) & mask) {
+        if (reg->slots[pos].hash == hash && strcmp(reg->slots[pos].id, id) == 0) {
+            return &reg->slots[pos];
+        }
+    }
+    return NULL;
+}
+
+static IdEntry* place(IdEntry* slots, size_t mask, uint64_t hash) {
+    size_t pos = hash & mask;
+    while (slots[pos].id[0]) {
+        pos = (pos + 1) & mask;
+    }
+    return &slots[pos];
+}
+
+// 적재율이 70%를 넘으면 두 배로 늘리고 저장해 둔 해시로 재배치
+static int grow(IdRegistry* reg) {
+    size_t new_cap = reg->capacity ? reg->capacity * 2 : INITIAL_CAPACITY;
+    IdEntry* slots = calloc(new_cap, sizeof(IdEntry));
+    if (!slots) return -1;
+
+    for (size_t i = 0; i < reg->capacity; i++) {
+        if (reg->slots[i].id[0]) {
+            *place(slots, new_cap - 1, reg->slots[i].hash) = reg->slots[i];
+        }
+    }
+    free(reg->slots);
+    reg->slots = slots;
+    reg->capacity = new_cap;
+    return 0;
+}
+
+// id 의 칸을 찾고 없으면 새로 만듦 (메모리 부족 시 NULL)
+static IdEntry* get_entry(IdRegistry* reg, const char* id) {
+    uint64_t hash = str_hash64(id);
+    IdEntry* e = find_entry(reg, id, hash);
+    if (e) return e;
+    if ((reg->count + 1) * 10 > reg->capacity * 7 && grow(reg) < 0) {
+        return NULL;
+    }
+    e = place(reg->slots, reg->capacity - 1, hash);
+    e->hash = hash;
+    snprintf(e->id, sizeof(e->id), "%s", id);
+    reg->count++;
+    return e;
+}
+
+static int taken(const IdRegistry* reg, const char* id, IdInUseFn in_use) {
+    if (in_use(id)) return 1;
+    IdEntry* e = find_entry(reg, id, str_hash64(id));
+    return e && e->file_only;
+}
+
+void id_registry_init(IdRegistry* reg) {
+    memset(reg, 0, sizeof(*reg));
+}
+
+int id_registry_add_file(IdRegistry* reg, const char* id) {
+    IdEntry* e = get_entry(reg, id);
+    if (!e) return -1;
+    e->file_only = 1;
+    return 0;
+}
+
+int id_registry_note_id(IdRegistry* reg, const char* id) {
+    const char* dash = strrchr(id, '-');
+    if (!dash || dash == id || dash[1] == '\0') return 0;
+
+    unsigned long n = 0;
+    for (const char* p = dash + 1; *p; p++) {
+        if (*p < '0' || *p > '9' || n > 100000000UL) return 0;
+        n = n * 10 + (unsigned long)(*p - '0');
+    }
+    if (n < 2) return 0;
+
+    char base[ID_LENGTH];
+    snprintf(base, sizeof(base), "%.*s", (int)(dash - id), id);
+    IdEntry* e = get_entry(reg, base);
+    if (!e) return -1;
+    if (e->next_suffix < n + 1) e->next_suffix = (unsigned)(n + 1);
+    return 0;
+}
+
+// base 에서 번호 "-n" 이 들어갈 자리를 남기고 자름 - UTF-8 글자 중간이나 하이픈 뒤에서 끝나지 않게 함
+static void format_candidate(const char* base, unsigned n, char* out, size_t out_len) {
+    char suffix[16];
+    int suffix_len = snprintf(suffix, sizeof(suffix), "-%u", n);
+    size_t keep = strlen(base);
+
+    if (keep + (size_t)suffix_len + 1 > out_len) {
+        keep = out_len > (size_t)suffix_len + 1 ? out_len - (size_t)suffix_len - 1 : 0;
+        while (keep > 0 && ((unsigned char)base[keep] & 0xC0) == 0x80) keep--;
+        while (keep > 0 && base[keep - 1] == '-') keep--;
+    }
+    snprintf(out, out_len, "%.*s%s", (int)keep, base, suffix);
+}
+
+void id_registry_assign(IdRegistry* reg, const char* base, IdInUseFn in_use, char* out, size_t out_len) {
+    if (!taken(reg, base, in_use)) {
+        snprintf(out, out_len, "%s", base);
+        return;
+    }
+
+    // 기본 ID 의 칸을 먼저 만들어 두면, 아래에서 찾기만 하는 동안 칸이 옮겨지지 않음
+    IdEntry* e = get_entry(reg, base);
+    unsigned n = e && e->next_suffix ? e->next_suffix : 2;
+    for (;; n++) {
+        format_candidate(base, n, out, out_len);
+        if (!taken(reg, out, in_use)) break;
+    }
+    if (e) e->next_suffix = n + 1;
+}
@@ -0,0 +1,38 @@
+// id_registry.h: 새 항목의 ID 를 정할 때 쓰는 메모리 상의 기록 (종류마다 하나)
+// - 기본 ID(제목의 slug)마다 다음에 붙일 번호 - 같은 제목이 N 번째여도 번호를 처음부터 세지 않음
+// - 메모리에 없는 항목 파일 이름 - 시작할 때 디렉토리를 한 번 읽어 모아 두므로, ID 를 정할 때
+//   파일이 있는지 매번 파일 시스템에 묻지 않아도 기존 파일을 덮어쓰지 않음
+// 메모리에 있는 항목은 호출자의 ID 인덱스로 확인한다. 동기화는 호출자가 담당 (서버에서는 목록 쓰기 잠금)
+#ifndef SURVEY_VOTE_ID_REGISTRY_H
+#define SURVEY_VOTE_ID_REGISTRY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../include/common.h"
+
+typedef struct IdEntry {
+    uint64_t hash;
+    unsigned next_suffix; // 이 ID 를 기본 ID 로 쓸 때 다음에 시도할 번호 (0 이면 아직 없음 = 2)
+    int      file_only;   // 메모리에 항목이 없는 파일 이름
+    char     id[ID_LENGTH]; // 빈 문자열이면 빈 칸
+} IdEntry;
+
+typedef struct IdRegistry {
+    IdEntry* slots;
+    size_t   capacity; // 항상 2의 거듭제곱
+    size_t   count;
+} IdRegistry;
+
+// id 가 메모리의 항목으로 이미 쓰이고 있는지 (호출자의 인덱스 조회)
+typedef int (*IdInUseFn)(const char* id);
+
+void id_registry_init(IdRegistry* reg);
+// 메모리에 항목이 없는 파일 이름을 기록 (메모리 부족 시 -1)
+int  id_registry_add_file(IdRegistry* reg, const char* id);
+// 이미 있는 ID 가 "<기본 ID>-<번호>" 꼴이면 기본 ID 의 다음 번호를 그 뒤로 맞춤 (시작 시 항목마다 호출)
+int  id_registry_note_id(IdRegistry* reg, const char* id);
+// base 가 비어 있으면 base, 아니면 base-2, base-3 ... 중 비어 있는 첫 ID 를 out 에 씀
+// 번호를 붙여 ID_LENGTH 를 넘으면 base 뒤쪽을 잘라 번호가 들어갈 자리를 만듦
+void id_registry_assign(IdRegistry* reg, const char* base, IdInUseFn in_use, char* out, size_t out_len);
+
+#endif  // SURVEY_VOTE_ID_REGISTRY_H
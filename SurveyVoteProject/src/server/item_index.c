@@ -0,0 +1,72 @@
+// item_index.c: linear probing 방식의 ID 해시 인덱스
+// 항목은 삭제되지 않으므로 삭제(tombstone) 처리는 없다
+#include <stdlib.h>
+#include <string.h>
+#include "item_index.h"
+#include "hash.h"
+
+#define INITIAL_CAPACITY 64
+
+static const char* key_of(const ItemIndex* index, const void* item) {
+    return (const char*)item + index->key_offset;
+}
+
+static void place(IndexSlot* slots, size_t mask, uint64_t hash, void* item) {
+    size_t pos = hash & mask;
+    while (slots[pos].item) {
+        pos = (pos + 1) & mask;
+    }
+    slots[pos].hash = hash;
+    slots[pos].item = item;
+}
+
+// 적재율이 70%를 넘으면 두 배로 늘리고 저장해 둔 해시로 재배치
+static int grow(ItemIndex* index) {
+    size_t new_cap = index->capacity ? index->capacity * 2 : INITIAL_CAPACITY;
+    IndexSlot* slots = calloc(new_cap, sizeof(IndexSlot));
+    if (!slots) return -1;
+
+    for (size_t i = 0; i < index->capacity; i++) {
+        if (index->slots[i].item) {
+            place(slots, new_cap - 1, index->slots[i].hash, index->slots[i].item);
+        }
+    }
+    free(index->slots);
+    index->slots = slots;
+    index->capacity = new_cap;
+    return 0;
+}
+
+void item_index_init(ItemIndex* index, size_t key_offset) {
+    memset(index, 0, sizeof(*index));
+    index->key_offset = key_offset;
+}
+
+void* item_index_find(const ItemIndex* index, const char* key) {
+    if (index->capacity == 0) return NULL;
+
+    uint64_t hash = str_hash64(key);
+    size_t mask = index->capacity - 1;
+    size_t pos = hash & mask;
+
+    while (index->slots[pos].item) {
+        if (index->slots[pos].hash == hash &&
+            strcmp(key_of(index, index->slots[pos].item), key) == 0) {
+            return index->slots[pos].item;
+        }
+        pos = (pos + 1) & mask;
+    }
+    return NULL;
+}
+
+int item_index_insert(ItemIndex* index, void* item) {
+    const char* key = key_of(index, item);
+
+    if (item_index_find(index, key)) return -1;
+    if ((index->count + 1) * 10 > index->capacity * 7 && grow(index) < 0) {
+        return -1;
+    }
+    place(index->slots, index->capacity - 1, str_hash64(key), item);
+    index->count++;
+    return 0;
+}
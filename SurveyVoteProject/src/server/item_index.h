@@ -0,0 +1,27 @@
+// item_index.h: ID 문자열 -> 항목(Survey/Vote) 포인터 해시 인덱스 (open addressing)
+#ifndef SURVEY_VOTE_ITEM_INDEX_H
+#define SURVEY_VOTE_ITEM_INDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct IndexSlot {
+    uint64_t hash;
+    void*    item; // NULL 이면 빈 칸
+} IndexSlot;
+
+// 항목 안의 ID 필드 위치(key_offset)만 알면 어떤 구조체든 담을 수 있음
+// 동기화는 호출자가 담당 (서버에서는 목록 잠금으로 보호)
+typedef struct ItemIndex {
+    IndexSlot* slots;
+    size_t capacity; // 항상 2의 거듭제곱
+    size_t count;
+    size_t key_offset;
+} ItemIndex;
+
+void  item_index_init(ItemIndex* index, size_t key_offset);
+void* item_index_find(const ItemIndex* index, const char* key);
+// 같은 키가 이미 있으면 -1
+int   item_index_insert(ItemIndex* index, void* item);
+
+#endif  // SURVEY_VOTE_ITEM_INDEX_H
@@ -0,0 +1,310 @@
+// main.c: 서버 프로그램의 진입점 - 옵션을 읽고, 데이터를 복구한 뒤 연결을 받아 실행 모드에 맞게 넘김
+// 명령 처리와 저장은 server_main.c 에 있으며, 벤치마크(bench/server_bench.c)는 이 파일 없이 그 코드를 링크함
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <arpa/inet.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include "../include/common.h"
+#include "server.h"
+#include "thread_pool.h"
+#include "wal.h"
+#include "request.h"
+#include "pool.h"
+#include "subscription.h"
+#include "stats.h"
+
+#define SERVER_PORT 9000
+
+// listen() 대기열 기본 크기 - 투표 시작 직후 몰리는 연결 요청(SYN)을 버리지 않도록 넉넉하게
+#define DEFAULT_BACKLOG SOMAXCONN
+
+// 워커 작업 큐 크기 - 연결당 예약되는 작업은 최대 하나이므로 동시 연결 수 정도면 충분
+#define JOB_QUEUE_CAPACITY 65536
+
+// epoll 모드에서 사용할 이벤트 루프 스레드 수의 상한 (기본값은 코어 수)
+#define MAX_EVENT_LOOPS 4
+
+// -s 통계에 출력하는 객체 풀 수의 상한
+#define MAX_REPORTED_POOLS 16
+
+// 스레드 모드에서 동시에 둘 수 있는 연결 스레드 수의 기본값 (-c)
+#define DEFAULT_MAX_CLIENT_THREADS 1024
+
+// 스레드 모드의 연결 스레드 수 - 상한에 닿으면 스레드 하나가 끝날 때까지 accept() 를 미뤄
+// 새 연결은 listen() 대기열에서 기다림 (연결이 몰려도 스레드와 스택 메모리가 끝없이 늘지 않음)
+static pthread_mutex_t client_threads_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  client_threads_freed = PTHREAD_COND_INITIALIZER;
+static int client_threads = 0;
+
+static void reserve_client_thread(int max_threads) {
+    pthread_mutex_lock(&client_threads_lock);
+    while (client_threads >= max_threads) {
+        pthread_cond_wait(&client_threads_freed, &client_threads_lock);
+    }
+    client_threads++;
+    pthread_mutex_unlock(&client_threads_lock);
+}
+
+static void release_client_thread(void) {
+    pthread_mutex_lock(&client_threads_lock);
+    client_threads--;
+    pthread_cond_signal(&client_threads_freed);
+    pthread_mutex_unlock(&client_threads_lock);
+}
+
+// 연결 스레드 - 연결이 끝나면 자리를 돌려줌
+static void* client_thread_main(void* arg) {
+    handle_client(arg);
+    release_client_thread();
+    return NULL;
+}
+
+static void print_usage(const char* prog) {
+    fprintf(stderr, "Usage: %s [-m thread|epoll] [-c max_client_threads] [-t event_loops] [-w workers] "
+                    "[-b backlog] [-s stats_interval_sec] [-f always|none|sync_interval_ms] [-i]\n", prog);
+}
+
+// 주기적으로 워커 풀 상태(큐 깊이, 워커 사용률), 응답 기록(WAL) 처리량/지연, 객체 풀 사용량, 구독 현황과
+// STATS 계측 보고를 출력하는 스레드
+static void* stats_reporter(void* arg) {
+    int interval = *(int*)arg;
+    ThreadPoolStats prev, cur;
+    WalStats wal_prev, wal_cur;
+    SubscriptionStats sub_prev, sub_cur;
+
+    thread_pool_get_stats(&prev);
+    wal_get_stats(&wal_prev);
+    subscription_get_stats(&sub_prev);
+    while (1) {
+        sleep(interval);
+        thread_pool_get_stats(&cur);
+        wal_get_stats(&wal_cur);
+        unsigned long long busy   = cur.busy_ns - prev.busy_ns;
+        unsigned long long window = (cur.uptime_ns - prev.uptime_ns) * (unsigned long long)cur.workers;
+        printf(">> [stats] workers %d (busy %d, util %.1f%%), queue %zu/%zu, jobs +%llu\n",
+               cur.workers, cur.busy_workers,
+               window > 0 ? 100.0 * busy / window : 0.0,
+               cur.queue_depth, cur.queue_capacity,
+               cur.completed - prev.completed);
+
+        // 레코드에는 응답 말고도 생성/종료가 있고, RESPOND_BATCH 는 레코드 여러 개를 한 번에 커밋함
+        unsigned long long records = wal_cur.appended - wal_prev.appended;
+        unsigned long long commits = wal_cur.commits - wal_prev.commits;
+        unsigned long long syncs   = wal_cur.syncs - wal_prev.syncs;
+        printf(">> [stats] wal fsync=%s: %.1f records/s, fsyncs +%llu (avg batch %.1f), "
+               "commit avg %.1f us, max %.1f us\n",
+               wal_policy_name(wal_cur.policy),
+               (double)records / interval, syncs,
+               syncs > 0 ? (double)(wal_cur.synced - wal_prev.synced) / syncs : 0.0,
+               commits > 0 ? (wal_cur.ack_ns - wal_prev.ack_ns) / 1000.0 / commits : 0.0,
+               wal_cur.ack_max_ns / 1000.0);
+
+        // 풀마다 사용 중/확보한 객체 수 - 확보량이 더 늘지 않으면 요청 처리 중 힙 할당이 없는 상태
+        PoolStats pools[MAX_REPORTED_POOLS];
+        int pool_count = pool_get_all_stats(pools, MAX_REPORTED_POOLS);
+        for (int i = 0; i < pool_count; i++) {
+            printf(">> [stats] pool %-11s %5zuB: in use %zu/%zu (peak %zu), chunks %zu, allocs %llu\n",
+                   pools[i].name, pools[i].elem_size, pools[i].in_use, pools[i].capacity,
+                   pools[i].peak, pools[i].chunks, pools[i].allocs);
+        }
+        printf(">> [stats] buffers larger than the pools: %llu\n", buffer_large_allocs());
+
+        // refreshes 는 구독자 수와 상관없이 바뀐 항목마다 한 번, pushes 는 구독자마다
+        subscription_get_stats(&sub_cur);
+        printf(">> [stats] subscribers %zu: refreshes +%llu, pushes +%llu, stalled +%llu\n",
+               sub_cur.subscribers, sub_cur.refreshes - sub_prev.refreshes,
+               sub_cur.pushes - sub_prev.pushes, sub_cur.stalled - sub_prev.stalled);
+
+        // STATS 명령과 같은 누적 계측 (명령별 지연 분포, 항목 lock, 저장 시간, 연결/스레드 수)
+        char report[BUFFER_SIZE * 4];
+        render_stats(report, sizeof(report));
+        printf("%s", report);
+        fflush(stdout);
+        prev = cur;
+        wal_prev = wal_cur;
+        sub_prev = sub_cur;
+    }
+    return NULL;
+}
+
+// 서버 프로그램의 진입점 - 클라이언트 요청을 기다리고 실행 모드에 따라
+// 각 연결을 새 스레드(thread, 동시에 최대 -c 개) 또는 epoll 이벤트 루프(epoll)로 넘김
+int main(int argc, char* argv[]) {
+    int server_fd, client_fd;
+    struct sockaddr_in server_addr, client_addr;
+    socklen_t addr_len = sizeof(client_addr);
+    pthread_t tid;
+    ServerMode mode = SERVER_MODE_THREAD;
+    int cores = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int loop_count, worker_count, backlog = DEFAULT_BACKLOG;
+    int max_client_threads = DEFAULT_MAX_CLIENT_THREADS;
+    static int stats_interval = 0;
+    WalSyncPolicy sync_policy = WAL_SYNC_ALWAYS;
+    int sync_interval_ms = 0;
+    int import_text = 0;
+    int opt;
+
+    if (cores < 1) cores = 1;
+    loop_count   = cores < MAX_EVENT_LOOPS ? cores : MAX_EVENT_LOOPS;
+    worker_count = cores;
+
+    while ((opt = getopt(argc, argv, "m:c:t:w:b:s:f:i")) != -1) {
+        switch (opt) {
+            case 'm':
+                if (strcmp(optarg, "thread") == 0) {
+                    mode = SERVER_MODE_THREAD;
+                } else if (strcmp(optarg, "epoll") == 0) {
+                    mode = SERVER_MODE_EPOLL;
+                } else {
+                    print_usage(argv[0]);
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            case 'c':
+                max_client_threads = atoi(optarg);
+                if (max_client_threads < 1) max_client_threads = DEFAULT_MAX_CLIENT_THREADS;
+                break;
+            case 't':
+                loop_count = atoi(optarg);
+                if (loop_count < 1) loop_count = 1;
+                break;
+            case 'w':
+                worker_count = atoi(optarg);
+                if (worker_count < 0) worker_count = 0;
+                break;
+            case 'b':
+                backlog = atoi(optarg);
+                if (backlog < 1) backlog = DEFAULT_BACKLOG;
+                break;
+            case 's':
+                stats_interval = atoi(optarg);
+                break;
+            case 'f':
+                // 응답을 디스크에 내리는 시점: always(응답마다, 묶어서) / none / 밀리초 주기
+                if (strcmp(optarg, "always") == 0) {
+                    sync_policy = WAL_SYNC_ALWAYS;
+                } else if (strcmp(optarg, "none") == 0) {
+                    sync_policy = WAL_SYNC_NONE;
+                } else if (atoi(optarg) > 0) {
+                    sync_policy = WAL_SYNC_INTERVAL;
+                    sync_interval_ms = atoi(optarg);
+                } else {
+                    print_usage(argv[0]);
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            case 'i':
+                // 스냅샷 대신 data/survey, data/vote 의 텍스트 파일에서 다시 읽어 들임
+                import_text = 1;
+                break;
+            default:
+                print_usage(argv[0]);
+                exit(EXIT_FAILURE);
+        }
+    }
+
+    server_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (server_fd < 0) {
+        perror("socket() failed");
+        exit(EXIT_FAILURE);
+    }
+
+    // 재시작 직후 TIME_WAIT 상태의 이전 연결 때문에 bind()가 실패하지 않도록 설정
+    int reuse = 1;
+    setsockopt(server_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    memset(&server_addr, 0, sizeof(server_addr));
+    server_addr.sin_family      = AF_INET;
+    server_addr.sin_addr.s_addr = INADDR_ANY;
+    server_addr.sin_port        = htons(SERVER_PORT);
+
+    if (bind(server_fd, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
+        perror("bind() failed");
+        close(server_fd);
+        exit(EXIT_FAILURE);
+    }
+
+    if (listen(server_fd, backlog) < 0) {
+        perror("listen() failed");
+        close(server_fd);
+        exit(EXIT_FAILURE);
+    }
+
+    mkdir("data", 0755);
+    mkdir("data/survey", 0755);
+    mkdir("data/vote", 0755);
+
+    // 스냅샷(또는 텍스트 파일)을 읽고, 마지막 체크포인트 이후의 변경은 로그에서 재생
+    request_table_init();
+    stats_init();
+    if (recover_data(import_text) < 0) {
+        fprintf(stderr, "failed to open write-ahead log\n");
+        exit(EXIT_FAILURE);
+    }
+    if (wal_set_sync_policy(sync_policy, sync_interval_ms) < 0) {
+        exit(EXIT_FAILURE);
+    }
+    if (pthread_create(&tid, NULL, checkpoint_main, NULL) == 0) {
+        pthread_detach(tid);
+    }
+    // 구독 fan-out 스레드 - 시작하지 못해도 서버는 돌고 구독 요청만 오류로 응답
+    subscription_start();
+
+    // epoll 모드에서는 이벤트 루프가 읽은 명령을 고정 크기 워커 풀이 처리 (-w 0 이면 루프에서 직접 처리)
+    if (mode == SERVER_MODE_EPOLL && worker_count > 0 &&
+        thread_pool_start(worker_count, JOB_QUEUE_CAPACITY) < 0) {
+        fprintf(stderr, "failed to start worker pool\n");
+        exit(EXIT_FAILURE);
+    }
+    if (mode == SERVER_MODE_EPOLL && reactor_start(loop_count) < 0) {
+        fprintf(stderr, "failed to start event loops\n");
+        exit(EXIT_FAILURE);
+    }
+    if (stats_interval > 0 && pthread_create(&tid, NULL, stats_reporter, &stats_interval) == 0) {
+        pthread_detach(tid);
+    }
+    printf(">> Server listening on port %d (%s mode)\n", SERVER_PORT,
+           mode == SERVER_MODE_EPOLL ? "epoll" : "thread");
+
+    while (1) {
+        if (mode == SERVER_MODE_THREAD) {
+            reserve_client_thread(max_client_threads);
+        }
+        client_fd = accept(server_fd, (struct sockaddr*)&client_addr, &addr_len);
+        if (client_fd < 0) {
+            perror("accept() failed");
+            if (mode == SERVER_MODE_THREAD) release_client_thread();
+            continue;
+        }
+        printf(">> Client connected: %s:%d\n",
+               inet_ntoa(client_addr.sin_addr),
+               ntohs(client_addr.sin_port));
+
+        if (mode == SERVER_MODE_EPOLL) {
+            reactor_add_client(client_fd);
+            continue;
+        }
+
+        // 읽지 않는 클라이언트에게 보내다 연결 스레드가 끝없이 묶이지 않도록 송신 대기 시간을 제한
+        struct timeval send_timeout = { SEND_TIMEOUT_MS / 1000, (SEND_TIMEOUT_MS % 1000) * 1000 };
+        setsockopt(client_fd, SOL_SOCKET, SO_SNDTIMEO, &send_timeout, sizeof(send_timeout));
+
+        // 소켓 번호는 포인터 값에 담아 넘김 (연결마다 힙에 할당하지 않음)
+        if (pthread_create(&tid, NULL, client_thread_main, (void*)(intptr_t)client_fd) != 0) {
+            perror("pthread_create() failed");
+            close(client_fd);
+            release_client_thread();
+            continue;
+        }
+        pthread_detach(tid);
+    }
+
+    close(server_fd);
+    return 0;
+}
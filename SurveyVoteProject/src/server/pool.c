@@ -0,0 +1,128 @@
+// pool.c: 고정 크기 객체 풀과 크기 등급별 I/O 버퍼
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "../include/common.h"
+#include "pool.h"
+
+static pthread_mutex_t registry_lock = PTHREAD_MUTEX_INITIALIZER;
+static Pool* registry = NULL;
+
+// I/O 버퍼 등급 - 마지막 등급은 가장 큰 프레임(MAX_FRAME_LEN)에 명령 머리를 더한 크기
+static Pool buffer_pools[] = {
+    POOL_INITIALIZER("buf256", 256),
+    POOL_INITIALIZER("buf1k", 1024),
+    POOL_INITIALIZER("buf4k", 4096),
+    POOL_INITIALIZER("buf16k", 16 * 1024),
+    POOL_INITIALIZER("buf64k", MAX_FRAME_LEN + 256),
+};
+#define BUFFER_CLASSES ((int)(sizeof(buffer_pools) / sizeof(buffer_pools[0])))
+
+static atomic_ullong large_allocs = 0;
+
+// pool->lock 을 잡은 상태에서 호출 - 다 쓴 블록의 객체들은 계속 쓰이므로 블록은 그대로 둠
+static int pool_grow_locked(Pool* pool) {
+    void* chunk = NULL;
+    if (pool->per_chunk == 0) {
+        pool->per_chunk = POOL_CHUNK_BYTES / pool->elem_size;
+        if (pool->per_chunk == 0) pool->per_chunk = 1;
+    }
+    if (posix_memalign(&chunk, 64, pool->elem_size * pool->per_chunk) != 0) return -1;
+    if (pool->chunks == 0) {
+        pthread_mutex_lock(&registry_lock);
+        pool->next = registry;
+        registry = pool;
+        pthread_mutex_unlock(&registry_lock);
+    }
+    pool->chunk = chunk;
+    pool->used = 0;
+    pool->chunks++;
+    return 0;
+}
+
+static void* pool_take(Pool* pool) {
+    void* obj = NULL;
+
+    pthread_mutex_lock(&pool->lock);
+    if (pool->free_list) {
+        obj = pool->free_list;
+        pool->free_list = *(void**)obj;
+    } else if (pool->used < pool->per_chunk || pool_grow_locked(pool) == 0) {
+        obj = pool->chunk + pool->used * pool->elem_size;
+        pool->used++;
+    }
+    if (obj) {
+        pool->allocs++;
+        if (++pool->in_use > pool->peak) pool->peak = pool->in_use;
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return obj;
+}
+
+void* pool_alloc(Pool* pool) {
+    void* obj = pool_take(pool);
+    if (obj) memset(obj, 0, pool->elem_size);
+    return obj;
+}
+
+void pool_free(Pool* pool, void* obj) {
+    if (!obj) return;
+    pthread_mutex_lock(&pool->lock);
+    *(void**)obj = pool->free_list;
+    pool->free_list = obj;
+    pool->in_use--;
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void pool_get_stats(Pool* pool, PoolStats* out) {
+    pthread_mutex_lock(&pool->lock);
+    out->name      = pool->name;
+    out->elem_size = pool->elem_size;
+    out->capacity  = pool->chunks * pool->per_chunk;
+    out->in_use    = pool->in_use;
+    out->peak      = pool->peak;
+    out->chunks    = pool->chunks;
+    out->allocs    = pool->allocs;
+    pthread_mutex_unlock(&pool->lock);
+}
+
+int pool_get_all_stats(PoolStats* out, int max) {
+    int n = 0;
+    pthread_mutex_lock(&registry_lock);
+    for (Pool* pool = registry; pool && n < max; pool = pool->next) {
+        pool_get_stats(pool, &out[n++]);
+    }
+    pthread_mutex_unlock(&registry_lock);
+    return n;
+}
+
+static Pool* buffer_class(size_t size) {
+    for (int i = 0; i < BUFFER_CLASSES; i++) {
+        if (size <= buffer_pools[i].elem_size) return &buffer_pools[i];
+    }
+    return NULL;
+}
+
+void* buffer_alloc(size_t size) {
+    Pool* pool = buffer_class(size);
+    if (pool) return pool_take(pool);
+    atomic_fetch_add_explicit(&large_allocs, 1, memory_order_relaxed);
+    return malloc(size);
+}
+
+void buffer_free(void* buf, size_t size) {
+    Pool* pool;
+    if (!buf) return;
+    pool = buffer_class(size);
+    if (pool) pool_free(pool, buf);
+    else free(buf);
+}
+
+size_t buffer_capacity(size_t size) {
+    Pool* pool = buffer_class(size);
+    return pool ? pool->elem_size : size;
+}
+
+unsigned long long buffer_large_allocs(void) {
+    return atomic_load_explicit(&large_allocs, memory_order_relaxed);
+}
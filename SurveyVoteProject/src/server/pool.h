@@ -0,0 +1,61 @@
+// pool.h: 크기가 같은 객체를 큰 블록(slab)에서 잘라 주고, 돌려받은 객체는 free 목록에 두었다가 다시 내주는 풀
+// 항목 본체/문자열, 연결 상태처럼 개수가 많고 크기가 정해진 객체와, 명령/응답 버퍼처럼 크기가 제각각인
+// I/O 버퍼(크기 등급별 풀)를 여기서 할당한다. 블록은 프로세스가 끝날 때까지 돌려주지 않으므로, 한 번
+// 최대치까지 늘어난 뒤에는 요청을 처리하는 동안 범용 힙(malloc)을 거치지 않고, 많은 항목을 읽어 들여도
+// 힙이 잘게 쪼개지지 않는다.
+#ifndef SURVEY_VOTE_POOL_H
+#define SURVEY_VOTE_POOL_H
+
+#include <stddef.h>
+#include <pthread.h>
+
+// 블록 하나의 크기 - 객체가 이보다 크면 블록 하나에 객체 하나
+#define POOL_CHUNK_BYTES (64 * 1024)
+
+typedef struct Pool {
+    pthread_mutex_t lock;
+    const char*  name;
+    size_t       elem_size;  // 캐시 라인(64바이트) 배수로 올린 크기
+    char*        chunk;      // 지금 잘라 쓰는 블록
+    size_t       used;       // chunk 에서 잘라 준 객체 수
+    size_t       per_chunk;  // 블록 하나의 객체 수 (첫 블록을 만들 때 정함)
+    void*        free_list;  // 돌려받은 객체 - 첫 8바이트에 다음 객체 주소를 적어 연결
+    struct Pool* next;       // 통계 출력을 위해 등록된 풀 목록
+    // 통계 (lock 으로 보호)
+    size_t chunks;
+    size_t in_use;
+    size_t peak;
+    unsigned long long allocs;
+} Pool;
+
+#define POOL_INITIALIZER(pool_name, size) \
+    { PTHREAD_MUTEX_INITIALIZER, (pool_name), ((size) + 63) & ~(size_t)63, NULL, 0, 0, NULL, NULL, 0, 0, 0, 0 }
+
+typedef struct PoolStats {
+    const char* name;
+    size_t elem_size;
+    size_t capacity;  // 지금까지 만든 블록에 들어가는 객체 수
+    size_t in_use;
+    size_t peak;
+    size_t chunks;
+    unsigned long long allocs;
+} PoolStats;
+
+// 0 으로 채운, 64바이트 정렬된 객체 하나 (메모리 부족 시 NULL)
+void* pool_alloc(Pool* pool);
+// NULL 이면 아무것도 하지 않음
+void  pool_free(Pool* pool, void* obj);
+void  pool_get_stats(Pool* pool, PoolStats* out);
+// 블록을 하나라도 만든 풀의 통계를 최대 max 개 채우고 채운 수를 반환
+int   pool_get_all_stats(PoolStats* out, int max);
+
+// I/O 버퍼: size 를 담는 가장 작은 등급(256B ~ 64KB+α)의 풀에서 꺼냄 - 내용은 채우지 않음
+// 가장 큰 등급보다 크면 malloc 으로 할당하고 buffer_large_allocs() 에 셈
+// 돌려줄 때는 할당할 때 준 size(또는 buffer_capacity 로 늘린 크기)를 그대로 넘겨야 함
+void*  buffer_alloc(size_t size);
+void   buffer_free(void* buf, size_t size);
+// size 를 요청했을 때 실제로 쓸 수 있는 크기 (등급 크기, 등급보다 크면 size 그대로)
+size_t buffer_capacity(size_t size);
+unsigned long long buffer_large_allocs(void);
+
+#endif  // SURVEY_VOTE_POOL_H
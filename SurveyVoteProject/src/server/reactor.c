@@ -0,0 +1,548 @@
+// reactor.c: epoll 기반 이벤트 루프 - 소수의 스레드가 모든 클라이언트 소켓을 다중화
+// 워커 풀이 켜져 있으면 이벤트 루프는 소켓에서 명령을 읽어 연결별 대기열에 넣기만 하고,
+// 실제 *_handler 실행은 워커가 맡는다. 한 연결의 명령은 한 번에 한 워커만 처리하므로
+// 응답 순서는 요청 순서와 같다.
+// 응답은 보낼 수 있는 만큼만 바로 보내고, 소켓 송신 버퍼가 차면 나머지를 연결의 송신 대기열에 두고
+// EPOLLOUT 을 등록해 이벤트 루프가 이어 보낸다. 핸들러(워커나 이벤트 루프 스레드)는 느린 클라이언트를
+// 기다리지 않으며, 대기열이 MAX_OUTPUT_BACKLOG 를 넘은 연결은 다 보낼 때까지 다음 명령을 처리하지 않는다.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include "server.h"
+#include "thread_pool.h"
+#include "pool.h"
+#include "stats.h"
+
+// epoll_wait 한 번에 받아오는 최대 이벤트 수
+#define MAX_EVENTS 256
+
+// 한 연결에서 처리되지 않고 쌓일 수 있는 명령 수 - 넘으면 해당 소켓 읽기를 멈춤
+#define MAX_PENDING_COMMANDS 64
+
+// 송신 대기열 블록 하나의 기본 크기와, 이 이상 쌓이면 그 연결의 명령 처리(-w 0 이면 읽기)를 멈추는 크기
+#define OUTPUT_CHUNK_BYTES  (16 * 1024)
+#define MAX_OUTPUT_BACKLOG  (256 * 1024)
+
+// 이벤트 루프 하나 = epoll 인스턴스 하나 + 이를 도는 스레드 하나
+typedef struct EventLoop {
+    int epfd;
+    pthread_t tid;
+} EventLoop;
+
+// 수신했지만 아직 처리하지 않은 명령 한 건 - 크기에 맞는 I/O 버퍼 풀에서 할당
+typedef struct Command {
+    struct Command* next;
+    size_t len;
+    char data[];
+} Command;
+
+// 아직 보내지 못한 응답 바이트 - 크기에 맞는 I/O 버퍼 풀에서 할당
+typedef struct OutChunk {
+    struct OutChunk* next;
+    size_t size;  // 할당한 크기 (buffer_free 에 넘김)
+    size_t cap;   // data 에 쓸 수 있는 바이트
+    size_t len;   // 채운 바이트
+    size_t off;   // 보낸 바이트
+    char data[];
+} OutChunk;
+
+// 클라이언트 연결 상태 - 이벤트 루프와 워커가 함께 참조하므로 참조 카운트로 수명 관리
+// 명령 대기열과 송신 대기열은 lock 으로 보호하며, 연결을 닫는 것은 이벤트 루프 스레드만 함
+typedef struct Conn {
+    Client client;
+    FrameBuffer in;  // 프레임 방식 연결에서 아직 완성되지 않은 프레임 (이벤트 루프만 사용)
+    EventLoop* loop;
+    pthread_mutex_t lock;
+    Command* head;
+    Command* tail;
+    int pending;    // 대기열에 있는 명령 수
+    int scheduled;  // 이 연결을 처리할 워커 작업이 큐에 있거나 실행 중인지 (blocked 동안에도 1)
+    int paused;     // 대기 명령이 너무 많아 읽기를 멈췄는지
+    int closed;     // 이벤트 루프에서 연결 종료를 감지했는지
+    OutChunk* out_head;
+    OutChunk* out_tail;
+    size_t out_bytes;  // 송신 대기열에 남은 바이트
+    int want_out;      // EPOLLOUT 을 등록해 두었는지
+    int blocked;       // 송신 대기열이 차서 워커가 명령 처리를 멈췄는지 (다 보내면 이벤트 루프가 다시 예약)
+    int read_paused;   // 송신 대기열이 차서 읽기를 멈췄는지 (워커 풀이 없을 때)
+    int read_closed;   // 상대가 쓰기를 닫음 - 남은 명령과 응답을 마친 뒤 닫음
+    int out_closed;    // 출력을 구독 쪽에 넘김 - 이후 응답은 보내지 않음
+    atomic_int refs;
+} Conn;
+
+// 연결 상태는 풀에서 꺼내고 연결이 끝나면 돌려줌
+static Pool conn_pool = POOL_INITIALIZER("conn", sizeof(Conn));
+
+static EventLoop* loops = NULL;
+static int loop_total = 0;
+static unsigned int next_loop = 0; // accept 스레드에서만 사용하는 라운드로빈 인덱스
+
+static int set_nonblocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0) return -1;
+    return fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+static void command_free(Command* cmd) {
+    buffer_free(cmd, sizeof(Command) + cmd->len + 1);
+}
+
+static void free_output(Conn* conn) {
+    while (conn->out_head) {
+        OutChunk* next = conn->out_head->next;
+        buffer_free(conn->out_head, conn->out_head->size);
+        conn->out_head = next;
+    }
+    conn->out_tail = NULL;
+    conn->out_bytes = 0;
+}
+
+// 연결의 이벤트 등록을 지금 상태에 맞춤 - 다시 등록하면 이미 읽기/쓰기 가능한 상태에 대해 이벤트가 다시 발생
+static void rearm(Conn* conn) {
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events   = EPOLLIN | EPOLLRDHUP | EPOLLET | (conn->want_out ? EPOLLOUT : 0);
+    ev.data.ptr = conn;
+    epoll_ctl(conn->loop->epfd, EPOLL_CTL_MOD, conn->client.fd, &ev);
+}
+
+static void conn_release(Conn* conn) {
+    if (atomic_fetch_sub_explicit(&conn->refs, 1, memory_order_acq_rel) != 1) {
+        return;
+    }
+    printf(">> Client disconnected\n");
+    stats_connection_closed();
+    close(conn->client.fd);
+    while (conn->head) {
+        Command* next = conn->head->next;
+        command_free(conn->head);
+        conn->head = next;
+    }
+    free_output(conn);
+    frame_buffer_free(&conn->in);
+    pthread_mutex_destroy(&conn->lock);
+    pool_free(&conn_pool, conn);
+}
+
+// 이벤트 루프 스레드에서만 호출
+static void close_client(Conn* conn) {
+    pthread_mutex_lock(&conn->lock);
+    if (conn->closed) {
+        pthread_mutex_unlock(&conn->lock);
+        return;
+    }
+    conn->closed = 1;
+    pthread_mutex_unlock(&conn->lock);
+    epoll_ctl(conn->loop->epfd, EPOLL_CTL_DEL, conn->client.fd, NULL);
+    conn_release(conn);
+}
+
+// 워커 작업: 연결의 대기열이 빌 때까지 명령을 순서대로 처리
+// 송신 대기열이 차 있으면 멈추고, 다 보낸 뒤 이벤트 루프가 이 작업을 다시 예약함
+static void run_pending_commands(void* arg) {
+    Conn* conn = arg;
+    int resume = 0;
+
+    for (;;) {
+        pthread_mutex_lock(&conn->lock);
+        Command* cmd = conn->head;
+        if (cmd && conn->out_bytes >= MAX_OUTPUT_BACKLOG && !conn->closed) {
+            conn->blocked = 1;
+            pthread_mutex_unlock(&conn->lock);
+            break;
+        }
+        if (!cmd) {
+            conn->scheduled = 0;
+            // 상대가 쓰기를 닫은 연결은 마지막 명령까지 처리했으면 이벤트 루프가 닫도록 깨움 (EPOLLOUT)
+            resume = (conn->paused || conn->read_closed) && !conn->closed;
+            if (conn->read_closed) conn->want_out = 1;
+            conn->paused = 0;
+            pthread_mutex_unlock(&conn->lock);
+            break;
+        }
+        conn->head = cmd->next;
+        if (!conn->head) conn->tail = NULL;
+        conn->pending--;
+        pthread_mutex_unlock(&conn->lock);
+
+        // 구독으로 넘겨진 연결의 남은 명령은 버림 - 연결은 이벤트 루프가 다음 이벤트에서 정리
+        if (!atomic_load(&conn->client.detached)) {
+            dispatch_command(&conn->client, cmd->data, cmd->len);
+        }
+        command_free(cmd);
+    }
+
+    // 읽기를 멈췄던 소켓을 다시 등록하면 남아 있는 데이터에 대해 이벤트가 다시 발생
+    if (resume) {
+        pthread_mutex_lock(&conn->lock);
+        if (!conn->closed) rearm(conn);
+        pthread_mutex_unlock(&conn->lock);
+    }
+    conn_release(conn);
+}
+
+// iov 에서 아직 보내지 않은 바이트를 송신 대기열 끝에 복사 - lock 을 잡은 상태에서 호출
+static int queue_output_locked(Conn* conn, const struct iovec* iov, int iovcnt) {
+    for (int i = 0; i < iovcnt; i++) {
+        const char* src = iov[i].iov_base;
+        size_t left = iov[i].iov_len;
+        while (left > 0) {
+            OutChunk* tail = conn->out_tail;
+            if (!tail || tail->len == tail->cap) {
+                size_t want = left > OUTPUT_CHUNK_BYTES ? left : OUTPUT_CHUNK_BYTES;
+                size_t size = buffer_capacity(sizeof(OutChunk) + want);
+                tail = buffer_alloc(size);
+                if (!tail) return -1;
+                tail->next = NULL;
+                tail->size = size;
+                tail->cap  = size - sizeof(OutChunk);
+                tail->len  = 0;
+                tail->off  = 0;
+                if (conn->out_tail) conn->out_tail->next = tail;
+                else conn->out_head = tail;
+                conn->out_tail = tail;
+            }
+            size_t n = tail->cap - tail->len < left ? tail->cap - tail->len : left;
+            memcpy(tail->data + tail->len, src, n);
+            tail->len += n;
+            conn->out_bytes += n;
+            src += n;
+            left -= n;
+        }
+    }
+    return 0;
+}
+
+int reactor_send(Client* client, struct iovec* cur, int iovcnt, int more) {
+    Conn* conn = client->conn;
+    int ret = 0;
+
+    pthread_mutex_lock(&conn->lock);
+    if (conn->closed || conn->out_closed) {
+        pthread_mutex_unlock(&conn->lock);
+        return -1;
+    }
+    // 앞선 응답이 대기열에 남아 있으면 순서를 지키기 위해 뒤에 붙이기만 함
+    while (!conn->out_head && iovcnt > 0) {
+        struct msghdr mh = { .msg_iov = cur, .msg_iovlen = iovcnt };
+        ssize_t n = sendmsg(client->fd, &mh, MSG_DONTWAIT | MSG_NOSIGNAL | (more ? MSG_MORE : 0));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            pthread_mutex_unlock(&conn->lock);
+            return -1;
+        }
+        while (iovcnt > 0 && (size_t)n >= cur->iov_len) {
+            n -= cur->iov_len;
+            cur++;
+            iovcnt--;
+        }
+        if (iovcnt > 0) {
+            cur->iov_base = (char*)cur->iov_base + n;
+            cur->iov_len -= n;
+        }
+    }
+    if (iovcnt > 0) {
+        ret = queue_output_locked(conn, cur, iovcnt);
+        if (!conn->want_out) {
+            conn->want_out = 1;
+            rearm(conn);
+        }
+    }
+    pthread_mutex_unlock(&conn->lock);
+    return ret;
+}
+
+// EPOLLOUT: 송신 대기열을 보낼 수 있는 만큼 보냄 (이벤트 루프 스레드)
+// 반환값: 0 = 연결 유지, -1 = 연결 종료 필요 (전송 오류, 또는 상대가 쓰기를 닫았고 남은 일이 없음)
+static int flush_output(Conn* conn) {
+    int resubmit = 0;
+    int finished = 0;
+
+    pthread_mutex_lock(&conn->lock);
+    while (conn->out_head) {
+        OutChunk* chunk = conn->out_head;
+        ssize_t n = send(conn->client.fd, chunk->data + chunk->off, chunk->len - chunk->off, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            pthread_mutex_unlock(&conn->lock);
+            return -1;
+        }
+        chunk->off += (size_t)n;
+        conn->out_bytes -= (size_t)n;
+        if (chunk->off == chunk->len) {
+            conn->out_head = chunk->next;
+            if (!conn->out_head) conn->out_tail = NULL;
+            buffer_free(chunk, chunk->size);
+        }
+    }
+    if (conn->out_bytes < MAX_OUTPUT_BACKLOG) {
+        // 밀린 응답을 충분히 보냈으면 멈췄던 명령 처리/읽기를 다시 시작
+        if (conn->blocked) {
+            conn->blocked = 0;
+            resubmit = 1;
+        }
+        if (conn->read_paused) {
+            conn->read_paused = 0;
+            rearm(conn);
+        }
+    }
+    if (!conn->out_head && conn->want_out) {
+        conn->want_out = 0;
+        rearm(conn);
+    }
+    finished = conn->read_closed && !conn->out_head && !conn->scheduled;
+    pthread_mutex_unlock(&conn->lock);
+
+    if (resubmit) {
+        atomic_fetch_add_explicit(&conn->refs, 1, memory_order_relaxed);
+        if (thread_pool_submit(run_pending_commands, conn) != 0) {
+            run_pending_commands(conn);
+        }
+    }
+    return finished ? -1 : 0;
+}
+
+// 명령 한 건을 연결 대기열에 넣고, 처리 중인 워커가 없으면 작업을 예약
+static void enqueue_command(Conn* conn, const char* data, size_t len) {
+    Command* cmd = buffer_alloc(sizeof(Command) + len + 1);
+    int need_schedule;
+
+    if (!cmd) return;
+    cmd->next = NULL;
+    cmd->len = len;
+    memcpy(cmd->data, data, len);
+    cmd->data[len] = '\0';
+
+    pthread_mutex_lock(&conn->lock);
+    if (conn->tail) conn->tail->next = cmd;
+    else conn->head = cmd;
+    conn->tail = cmd;
+    conn->pending++;
+    need_schedule = !conn->scheduled;
+    conn->scheduled = 1;
+    pthread_mutex_unlock(&conn->lock);
+
+    if (need_schedule) {
+        atomic_fetch_add_explicit(&conn->refs, 1, memory_order_relaxed);
+        // 큐가 가득 찼으면 이벤트 루프 스레드에서 직접 처리 (명령을 버리지 않음)
+        if (thread_pool_submit(run_pending_commands, conn) != 0) {
+            run_pending_commands(conn);
+        }
+    }
+}
+
+static int too_many_pending(Conn* conn) {
+    int full;
+    pthread_mutex_lock(&conn->lock);
+    full = conn->pending >= MAX_PENDING_COMMANDS;
+    if (full) conn->paused = 1;
+    pthread_mutex_unlock(&conn->lock);
+    return full;
+}
+
+// 명령 한 건 처리 - 워커 풀이 있으면 대기열로, 없으면 이벤트 루프 스레드에서 바로 실행
+static void handle_command(Conn* conn, const char* data, size_t len, int use_pool) {
+    if (use_pool) {
+        enqueue_command(conn, data, len);
+    } else {
+        dispatch_command(&conn->client, data, len);
+    }
+}
+
+// 송신 대기열이 차 있으면 읽기를 멈춤 (워커 풀이 없을 때) - 다 보내면 flush_output 이 다시 등록
+static int too_much_output(Conn* conn) {
+    int full;
+    pthread_mutex_lock(&conn->lock);
+    full = conn->out_bytes >= MAX_OUTPUT_BACKLOG;
+    if (full) conn->read_paused = 1;
+    pthread_mutex_unlock(&conn->lock);
+    return full;
+}
+
+// 상대가 쓰기를 닫음 - 처리 중인 명령이나 보낼 응답이 남아 있으면 그것을 마친 뒤 닫음
+static int finish_reading(Conn* conn) {
+    int done;
+    pthread_mutex_lock(&conn->lock);
+    conn->read_closed = 1;
+    done = !conn->scheduled && !conn->out_head;
+    pthread_mutex_unlock(&conn->lock);
+    return done ? -1 : 0;
+}
+
+// edge-triggered 이므로 EAGAIN이 날 때까지 모두 읽어서 명령 단위로 분배
+// 프레임 방식 연결은 recv() 경계와 상관없이 완성된 프레임마다 명령 한 건으로 처리
+// 반환값: 0 = 연결 유지, -1 = 연결 종료 필요
+static int drain_client(Conn* conn) {
+    char buffer[BUFFER_SIZE];
+    int use_pool = thread_pool_running();
+
+    for (;;) {
+        // 구독으로 넘겨진 연결은 이 루프에서 빼고 닫음 (fan-out 스레드가 dup 한 번호로 계속 보냄)
+        if (atomic_load(&conn->client.detached)) {
+            return -1;
+        }
+        if (conn->read_closed) {
+            return 0;
+        }
+        if (use_pool ? too_many_pending(conn) : too_much_output(conn)) {
+            return 0;
+        }
+        ssize_t bytes = recv(conn->client.fd, buffer, sizeof(buffer) - 1, 0);
+        if (bytes > 0) {
+            // 첫 바이트로 연결 방식 결정 (0x00 이면 길이 머리)
+            if (conn->client.framed < 0) {
+                conn->client.framed = (buffer[0] == 0);
+            }
+            if (!conn->client.framed) {
+                buffer[bytes] = '\0';
+                handle_command(conn, buffer, bytes, use_pool);
+                continue;
+            }
+            if (frame_buffer_append(&conn->in, buffer, bytes) != 0) {
+                return -1;
+            }
+            const char* payload;
+            size_t len;
+            int ret;
+            while ((ret = frame_buffer_next(&conn->in, &payload, &len)) > 0 && !atomic_load(&conn->client.detached)) {
+                handle_command(conn, payload, len, use_pool);
+            }
+            if (ret < 0) {
+                fprintf(stderr, ">> Frame too large, closing connection\n");
+                return -1;
+            }
+            continue;
+        }
+        if (bytes == 0) {
+            return finish_reading(conn);
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return 0;
+        }
+        return -1;
+    }
+}
+
+static void* event_loop_main(void* arg) {
+    EventLoop* loop = arg;
+    struct epoll_event events[MAX_EVENTS];
+
+    while (1) {
+        int n = epoll_wait(loop->epfd, events, MAX_EVENTS, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("epoll_wait() failed");
+            break;
+        }
+        for (int i = 0; i < n; i++) {
+            Conn* conn = events[i].data.ptr;
+            int ret = 0;
+            if (events[i].events & EPOLLOUT) {
+                ret = flush_output(conn);
+            }
+            // 오류/끊김 이벤트라도 남은 데이터는 먼저 처리
+            if (ret < 0 || drain_client(conn) < 0 || (events[i].events & (EPOLLERR | EPOLLHUP))) {
+                close_client(conn);
+            }
+        }
+    }
+    return NULL;
+}
+
+// loop_count 개의 이벤트 루프 스레드를 생성
+int reactor_start(int loop_count) {
+    if (loop_count < 1) loop_count = 1;
+
+    loops = calloc(loop_count, sizeof(EventLoop));
+    if (!loops) return -1;
+
+    for (int i = 0; i < loop_count; i++) {
+        loops[i].epfd = epoll_create1(EPOLL_CLOEXEC);
+        if (loops[i].epfd < 0) {
+            perror("epoll_create1() failed");
+            return -1;
+        }
+        if (pthread_create(&loops[i].tid, NULL, event_loop_main, &loops[i]) != 0) {
+            perror("pthread_create() failed");
+            return -1;
+        }
+        pthread_detach(loops[i].tid);
+    }
+    loop_total = loop_count;
+    return 0;
+}
+
+// accept된 소켓을 논블로킹으로 바꾸고 이벤트 루프 중 하나에 등록
+void reactor_add_client(int client_fd) {
+    EventLoop* loop = &loops[next_loop++ % loop_total];
+    struct epoll_event ev;
+    Conn* conn;
+
+    if (set_nonblocking(client_fd) < 0) {
+        perror("fcntl() failed");
+        close(client_fd);
+        return;
+    }
+
+    conn = pool_alloc(&conn_pool);
+    if (!conn) {
+        close(client_fd);
+        return;
+    }
+    conn->client.fd     = client_fd;
+    conn->client.framed = -1;
+    conn->client.conn   = conn;
+    conn->loop = loop;
+    pthread_mutex_init(&conn->lock, NULL);
+    atomic_init(&conn->refs, 1); // 이벤트 루프가 가진 참조
+    stats_connection_opened();
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events   = EPOLLIN | EPOLLRDHUP | EPOLLET;
+    ev.data.ptr = conn;
+    if (epoll_ctl(loop->epfd, EPOLL_CTL_ADD, client_fd, &ev) < 0) {
+        perror("epoll_ctl() failed");
+        conn_release(conn);
+    }
+}
+
+int reactor_hand_over_output(Client* client, OutputTakeFn take, void* arg) {
+    Conn* conn = client->conn;
+    char* pending = NULL;
+    size_t len = 0;
+    int ret;
+
+    pthread_mutex_lock(&conn->lock);
+    if (conn->out_bytes > 0) {
+        pending = buffer_alloc(conn->out_bytes);
+        if (!pending) {
+            pthread_mutex_unlock(&conn->lock);
+            return -1;
+        }
+        for (OutChunk* c = conn->out_head; c; c = c->next) {
+            memcpy(pending + len, c->data + c->off, c->len - c->off);
+            len += c->len - c->off;
+        }
+    }
+    ret = take(arg, pending, len);
+    if (ret == 0) {
+        free_output(conn);
+        conn->out_closed = 1;
+    }
+    pthread_mutex_unlock(&conn->lock);
+    if (pending) buffer_free(pending, len);
+    return ret;
+}
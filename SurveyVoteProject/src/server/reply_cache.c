@@ -0,0 +1,62 @@
+// reply_cache.c: 버전별 응답 버퍼 보관
+#include <stdlib.h>
+#include <string.h>
+#include "reply_cache.h"
+#include "pool.h"
+
+// 응답 버퍼는 크기에 맞는 I/O 버퍼 풀에서, 칸은 칸 전용 풀에서 꺼냄
+static Pool slot_pool = POOL_INITIALIZER("reply_slot", sizeof(ReplySlot));
+
+CachedReply* cached_reply_create(unsigned long version, const char* data, size_t len) {
+    CachedReply* reply = buffer_alloc(sizeof(CachedReply) + len);
+    if (!reply) return NULL;
+    atomic_init(&reply->refs, 1);
+    reply->version = version;
+    reply->len = len;
+    memcpy(reply->data, data, len);
+    return reply;
+}
+
+void cached_reply_retain(CachedReply* reply) {
+    atomic_fetch_add_explicit(&reply->refs, 1, memory_order_relaxed);
+}
+
+void cached_reply_release(CachedReply* reply) {
+    if (reply && atomic_fetch_sub_explicit(&reply->refs, 1, memory_order_acq_rel) == 1) {
+        buffer_free(reply, sizeof(CachedReply) + reply->len);
+    }
+}
+
+ReplySlot* reply_slot_create(void) {
+    ReplySlot* slot = pool_alloc(&slot_pool);
+    if (!slot) return NULL;
+    pthread_mutex_init(&slot->lock, NULL);
+    slot->reply = NULL;
+    return slot;
+}
+
+CachedReply* reply_slot_get(ReplySlot* slot, unsigned long version) {
+    CachedReply* reply = NULL;
+    if (!slot) return NULL;
+    pthread_mutex_lock(&slot->lock);
+    if (slot->reply && slot->reply->version == version) {
+        reply = slot->reply;
+        atomic_fetch_add_explicit(&reply->refs, 1, memory_order_relaxed);
+    }
+    pthread_mutex_unlock(&slot->lock);
+    return reply;
+}
+
+void reply_slot_put(ReplySlot* slot, CachedReply* reply) {
+    CachedReply* old = NULL;
+    if (!slot) return;
+    pthread_mutex_lock(&slot->lock);
+    // 늦게 끝난 이전 버전이 더 새 응답을 덮어쓰지 않도록 버전이 커질 때만 교체
+    if (!slot->reply || reply->version > slot->reply->version) {
+        old = slot->reply;
+        atomic_fetch_add_explicit(&reply->refs, 1, memory_order_relaxed);
+        slot->reply = reply;
+    }
+    pthread_mutex_unlock(&slot->lock);
+    cached_reply_release(old);
+}
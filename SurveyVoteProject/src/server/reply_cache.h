@@ -0,0 +1,36 @@
+// reply_cache.h: 만들어 둔 응답 문자열을 버전과 함께 보관해 같은 내용의 요청에 그대로 보냄
+// 응답 버퍼는 만든 뒤 바뀌지 않고 참조 수로 수명을 관리하므로, 보내는 도중에 새 버전으로
+// 교체되어도 이미 꺼낸 버퍼는 마지막 참조가 놓일 때까지 유효하다.
+#ifndef SURVEY_VOTE_REPLY_CACHE_H
+#define SURVEY_VOTE_REPLY_CACHE_H
+
+#include <stddef.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+typedef struct CachedReply {
+    atomic_uint   refs;
+    unsigned long version; // 이 응답을 만든 시점의 항목(목록) 버전
+    size_t        len;
+    char          data[];
+} CachedReply;
+
+// 칸 하나에 최신 응답 하나 - lock 은 포인터를 꺼내 참조를 올리는 동안만 잡음
+typedef struct ReplySlot {
+    pthread_mutex_t lock;
+    CachedReply*    reply;
+} ReplySlot;
+
+// 참조 수 1 로 생성 (메모리 부족 시 NULL)
+CachedReply* cached_reply_create(unsigned long version, const char* data, size_t len);
+void         cached_reply_retain(CachedReply* reply);
+void         cached_reply_release(CachedReply* reply);
+
+// 칸을 만들지 못했으면(NULL) get 은 항상 NULL, put 은 아무것도 하지 않음 - 캐시 없이 동작
+ReplySlot* reply_slot_create(void);
+// 보관 중인 응답이 version 과 같으면 참조를 올려 반환, 아니면 NULL
+CachedReply* reply_slot_get(ReplySlot* slot, unsigned long version);
+// 보관 중인 것보다 새 버전이면 교체 (칸이 참조를 하나 더 가짐) - 호출자의 참조는 그대로
+void reply_slot_put(ReplySlot* slot, CachedReply* reply);
+
+#endif  // SURVEY_VOTE_REPLY_CACHE_H
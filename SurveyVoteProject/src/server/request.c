@@ -0,0 +1,93 @@
+// request.c: 명령 파서와 명령어 조회 표
+// 예전에는 명령마다 버퍼 전체를 복사한 뒤 CMD_* 문자열과 strncmp 를 차례로 최대 열 번 비교하고,
+// 핸들러 안에서 다시 strtok_r 로 나눴다. 지금은 '|' 위치만 한 번 훑어 필드 view 를 만들고,
+// 명령어는 (길이, 첫 글자)로 만든 해시로 표를 한 번 찾아 memcmp 한 번으로 확인한다.
+#include "request.h"
+#include "../include/common.h"
+
+// (길이 * 4 + 첫 글자) & 31 로 칸을 정하며, 기존 명령어 열 개는 서로 겹치지 않음
+// 겹치는 명령어는 다음 칸에 들어가므로 조회는 많아야 몇 칸만 더 봄
+#define REQUEST_SLOTS 32
+
+typedef struct VerbEntry {
+    const char* name;
+    size_t      len;
+    RequestType type;
+} VerbEntry;
+
+static const VerbEntry verbs[] = {
+    { CMD_CREATE_SURVEY,  sizeof(CMD_CREATE_SURVEY) - 1,  REQ_CREATE_SURVEY },
+    { CMD_RESPOND_SURVEY, sizeof(CMD_RESPOND_SURVEY) - 1, REQ_RESPOND_SURVEY },
+    { CMD_RESULT_SURVEY,  sizeof(CMD_RESULT_SURVEY) - 1,  REQ_RESULT_SURVEY },
+    { CMD_CLOSE_SURVEY,   sizeof(CMD_CLOSE_SURVEY) - 1,   REQ_CLOSE_SURVEY },
+    { CMD_LIST_SURVEY,    sizeof(CMD_LIST_SURVEY) - 1,    REQ_LIST_SURVEY },
+    { CMD_CREATE_VOTE,    sizeof(CMD_CREATE_VOTE) - 1,    REQ_CREATE_VOTE },
+    { CMD_RESPOND_VOTE,   sizeof(CMD_RESPOND_VOTE) - 1,   REQ_RESPOND_VOTE },
+    { CMD_RESULT_VOTE,    sizeof(CMD_RESULT_VOTE) - 1,    REQ_RESULT_VOTE },
+    { CMD_CLOSE_VOTE,     sizeof(CMD_CLOSE_VOTE) - 1,     REQ_CLOSE_VOTE },
+    { CMD_LIST_VOTE,      sizeof(CMD_LIST_VOTE) - 1,      REQ_LIST_VOTE },
+    { CMD_RESPOND_BATCH,  sizeof(CMD_RESPOND_BATCH) - 1,  REQ_RESPOND_BATCH },
+    { CMD_SUBSCRIBE_SURVEY, sizeof(CMD_SUBSCRIBE_SURVEY) - 1, REQ_SUBSCRIBE_SURVEY },
+    { CMD_SUBSCRIBE_VOTE,   sizeof(CMD_SUBSCRIBE_VOTE) - 1,   REQ_SUBSCRIBE_VOTE },
+    { CMD_STATS,          sizeof(CMD_STATS) - 1,          REQ_STATS },
+};
+
+#define VERB_COUNT (sizeof(verbs) / sizeof(verbs[0]))
+
+// 각 칸에는 verbs 의 인덱스 + 1 (0 이면 빈 칸)
+static unsigned char slots[REQUEST_SLOTS];
+
+static inline unsigned verb_hash(const char* s, size_t len) {
+    return (unsigned)(len * 4 + (unsigned char)s[0]) & (REQUEST_SLOTS - 1);
+}
+
+void request_table_init(void) {
+    memset(slots, 0, sizeof(slots));
+    for (size_t i = 0; i < VERB_COUNT; i++) {
+        unsigned h = verb_hash(verbs[i].name, verbs[i].len);
+        while (slots[h]) h = (h + 1) & (REQUEST_SLOTS - 1);
+        slots[h] = (unsigned char)(i + 1);
+    }
+}
+
+static RequestType lookup_verb(const char* s, size_t len) {
+    if (len == 0) return REQ_UNKNOWN;
+    for (unsigned h = verb_hash(s, len);; h = (h + 1) & (REQUEST_SLOTS - 1)) {
+        unsigned char slot = slots[h];
+        if (!slot) return REQ_UNKNOWN;
+        const VerbEntry* e = &verbs[slot - 1];
+        if (e->len == len && memcmp(e->name, s, len) == 0) return e->type;
+    }
+}
+
+void request_parse(const char* buf, size_t len, Request* req) {
+    StrView rest = { buf, len };
+    const char* bar = memchr(buf, '|', len);
+    size_t verb_len = bar ? (size_t)(bar - buf) : len;
+
+    // 명령어만 보내는 LIST_* 를 터미널에서 치면 끝에 줄바꿈이 붙으므로 잘라냄
+    while (verb_len > 0 && (buf[verb_len - 1] == '\n' || buf[verb_len - 1] == '\r' || buf[verb_len - 1] == ' ')) {
+        verb_len--;
+    }
+    req->verb.ptr = buf;
+    req->verb.len = verb_len;
+    req->type = lookup_verb(buf, verb_len);
+
+    req->argc = 0;
+    req->tail.ptr = buf + len;
+    req->tail.len = 0;
+    if (!bar) return;
+    rest.ptr = bar + 1;
+    rest.len = len - (size_t)(bar + 1 - buf);
+    req->tail = rest;
+    while (req->argc < REQUEST_MAX_ARGS && strview_next(&rest, '|', &req->args[req->argc])) {
+        req->argc++;
+    }
+}
+
+const char* request_type_name(RequestType type) {
+    for (size_t i = 0; i < VERB_COUNT; i++) {
+        if (verbs[i].type == type) return verbs[i].name;
+    }
+    return "UNKNOWN";
+}
@@ -0,0 +1,110 @@
+// request.h: 수신한 명령 한 건을 복사 없이 한 번에 나누는 파서와 명령어 -> 종류 조회 표
+#ifndef SURVEY_VOTE_REQUEST_H
+#define SURVEY_VOTE_REQUEST_H
+
+#include <stddef.h>
+#include <string.h>
+
+// 명령어 뒤에 올 수 있는 필드 수의 상한 (넘는 필드는 무시)
+#define REQUEST_MAX_ARGS 8
+
+// 수신 버퍼 안의 문자열 조각 - '\0' 으로 끝나지 않으므로 항상 len 과 함께 사용
+typedef struct StrView {
+    const char* ptr;
+    size_t      len;
+} StrView;
+
+typedef enum {
+    REQ_UNKNOWN = 0,
+    REQ_CREATE_SURVEY,
+    REQ_RESPOND_SURVEY,
+    REQ_RESULT_SURVEY,
+    REQ_CLOSE_SURVEY,
+    REQ_LIST_SURVEY,
+    REQ_CREATE_VOTE,
+    REQ_RESPOND_VOTE,
+    REQ_RESULT_VOTE,
+    REQ_CLOSE_VOTE,
+    REQ_LIST_VOTE,
+    REQ_RESPOND_BATCH,
+    REQ_SUBSCRIBE_SURVEY,
+    REQ_SUBSCRIBE_VOTE,
+    REQ_STATS,
+    REQ_TYPE_COUNT
+} RequestType;
+
+// COMMAND|ARG1|ARG2|... 를 나눈 결과 - args 는 원본 버퍼를 가리키므로 버퍼보다 오래 쓰지 않음
+typedef struct Request {
+    RequestType type;
+    StrView     verb;
+    int         argc;
+    StrView     args[REQUEST_MAX_ARGS];
+    StrView     tail;  // 명령어 뒤 첫 '|' 다음부터 끝까지 - 필드 수 제한 없이 직접 나눌 때 사용
+} Request;
+
+// 명령어 조회 표 생성 - 서버 시작 시 한 번 호출
+void request_table_init(void);
+// buf 의 len 바이트를 '|' 기준으로 나누고 명령어 종류를 결정 (할당 없음, 원본 변경 없음)
+// 빈 필드는 건너뜀 (예전 strtok_r 방식과 같은 결과)
+void request_parse(const char* buf, size_t len, Request* req);
+const char* request_type_name(RequestType type);
+
+// 필드가 있으면 그 view, 없으면 빈 view
+static inline StrView request_arg(const Request* req, int i) {
+    StrView none = { "", 0 };
+    return i < req->argc ? req->args[i] : none;
+}
+
+// view 를 dst 에 '\0' 으로 끝나게 복사 (size - 1 바이트에서 자름) - 복사한 길이 반환
+static inline size_t strview_copy(char* dst, size_t size, StrView v) {
+    size_t n = v.len < size - 1 ? v.len : size - 1;
+    memcpy(dst, v.ptr, n);
+    dst[n] = '\0';
+    return n;
+}
+
+// rest 의 앞에서 sep 까지를 잘라 out 에 담고 rest 를 그 뒤로 옮김 (빈 조각은 건너뜀)
+// 더 꺼낼 조각이 없으면 0
+static inline int strview_next(StrView* rest, char sep, StrView* out) {
+    while (rest->len > 0 && rest->ptr[0] == sep) {
+        rest->ptr++;
+        rest->len--;
+    }
+    if (rest->len == 0) return 0;
+    const char* end = memchr(rest->ptr, sep, rest->len);
+    size_t n = end ? (size_t)(end - rest->ptr) : rest->len;
+    out->ptr = rest->ptr;
+    out->len = n;
+    rest->ptr += n;
+    rest->len -= n;
+    return 1;
+}
+
+// atoi 와 같은 규칙으로 앞부분의 정수를 읽음 (앞 공백, 부호 허용 / 숫자가 아니면 멈춤)
+static inline int strview_to_int(StrView v) {
+    size_t i = 0;
+    int sign = 1, value = 0;
+    while (i < v.len && (v.ptr[i] == ' ' || v.ptr[i] == '\t')) i++;
+    if (i < v.len && (v.ptr[i] == '-' || v.ptr[i] == '+')) {
+        if (v.ptr[i] == '-') sign = -1;
+        i++;
+    }
+    for (; i < v.len && v.ptr[i] >= '0' && v.ptr[i] <= '9'; i++) {
+        if (value < 100000000) value = value * 10 + (v.ptr[i] - '0'); // 보기 번호로 쓰므로 넘치지 않게만
+    }
+    return sign * value;
+}
+
+// 조건부 RESULT/LIST 의 버전 인자를 읽음 - 숫자만 허용하고 아니면 0
+// 서버가 주는 버전은 0 이 아니므로 잘못된 값은 항상 "바뀜"으로 처리되어 전체 응답을 받음
+static inline unsigned long strview_to_version(StrView v) {
+    unsigned long value = 0;
+    if (v.len == 0 || v.len > 20) return 0;
+    for (size_t i = 0; i < v.len; i++) {
+        if (v.ptr[i] < '0' || v.ptr[i] > '9') return 0;
+        value = value * 10 + (unsigned long)(v.ptr[i] - '0');
+    }
+    return value;
+}
+
+#endif  // SURVEY_VOTE_REQUEST_H
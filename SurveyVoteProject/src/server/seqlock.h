@@ -0,0 +1,38 @@
+// seqlock.h: 쓰는 쪽끼리는 기존 잠금으로 배제하고, 읽는 쪽은 잠금 없이 일련번호로 일관성을 확인
+// 쓰기 전후로 번호를 하나씩 올려 쓰는 중에는 홀수가 되게 하고, 읽는 쪽은 읽기 전후 번호가 같고
+// 짝수일 때만 읽은 값을 사용한다 (다르면 다시 읽음). 읽는 쪽은 공유 메모리에 쓰지 않으므로
+// 아무리 많아도 쓰는 쪽이나 서로를 막지 않는다.
+#ifndef SURVEY_VOTE_SEQLOCK_H
+#define SURVEY_VOTE_SEQLOCK_H
+
+#include <stdatomic.h>
+
+// 호출자는 쓰는 쪽끼리의 배제를 위한 잠금(항목 lock)을 잡고 있어야 함
+static inline void seqlock_write_begin(atomic_uint* seq) {
+    unsigned s = atomic_load_explicit(seq, memory_order_relaxed);
+    atomic_store_explicit(seq, s + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+}
+
+static inline void seqlock_write_end(atomic_uint* seq) {
+    unsigned s = atomic_load_explicit(seq, memory_order_relaxed);
+    atomic_store_explicit(seq, s + 1, memory_order_release);
+}
+
+static inline unsigned seqlock_read_begin(const atomic_uint* seq) {
+    unsigned s;
+    while ((s = atomic_load_explicit((atomic_uint*)seq, memory_order_acquire)) & 1) {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#endif
+    }
+    return s;
+}
+
+// 읽는 동안 쓰기가 있었으면 1 (다시 읽어야 함)
+static inline int seqlock_read_retry(const atomic_uint* seq, unsigned start) {
+    atomic_thread_fence(memory_order_acquire);
+    return atomic_load_explicit((atomic_uint*)seq, memory_order_relaxed) != start;
+}
+
+#endif  // SURVEY_VOTE_SEQLOCK_H
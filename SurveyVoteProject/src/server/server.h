@@ -0,0 +1,96 @@
+// server.h: 서버 내부 모듈(이벤트 루프 등)이 함께 사용하는 선언
+#ifndef SURVEY_VOTE_SERVER_H
+#define SURVEY_VOTE_SERVER_H
+
+#include <stddef.h>
+#include <stdatomic.h>
+#include <sys/uio.h>
+#include "../include/common.h"
+#include "request.h"
+
+// 스레드 모드 연결의 송신 제한 시간(ms, SO_SNDTIMEO) - 이 동안 보내지 못하면 연결을 끊음. epoll 모드는 기다리지 않고 대기열에 쌓음
+#define SEND_TIMEOUT_MS  5000
+
+// 클라이언트 연결을 처리하는 방식
+typedef enum {
+    SERVER_MODE_THREAD, // 클라이언트마다 스레드 하나 (기존 방식)
+    SERVER_MODE_EPOLL   // 소수의 epoll 이벤트 루프 스레드가 모든 소켓을 다중화
+} ServerMode;
+
+// 핸들러가 응답을 보낼 대상 - 프레임 방식 연결이면 응답 앞에 길이 머리를 붙임
+typedef struct Client {
+    int fd;
+    int framed;  // -1: 아직 모름(첫 바이트를 받기 전), 0: 기존 방식, 1: 길이 접두 프레임
+    atomic_int detached;  // 구독 연결로 넘겨짐 - 이후 받은 명령은 처리하지 않고 연결을 정리
+    struct Conn* conn;    // epoll 모드 연결의 상태 - 응답은 그 연결의 송신 대기열을 거침 (스레드 모드는 NULL)
+} Client;
+
+// 응답 전송 - 부분 전송과 EAGAIN을 처리하여 끝까지 보냄 (실패 시 -1)
+int send_reply(Client* client, const char* buf, size_t len);
+
+// 수신한 명령 한 건(len 바이트)을 해당 *_handler로 분배
+void dispatch_command(Client* client, const char* buffer, size_t len);
+
+// server_main.c: 명령 처리와 항목 저장 - main() 은 main.c 에 있고, bench/server_bench.c 도 이 코드를 그대로 링크함
+void create_survey_handler(Client* client, const Request* req);
+void respond_survey_handler(Client* client, const Request* req);
+void result_survey_handler(Client* client, const Request* req);
+void close_survey_handler(Client* client, const Request* req);
+void list_survey_handler(Client* client, const Request* req);
+void create_vote_handler(Client* client, const Request* req);
+void respond_vote_handler(Client* client, const Request* req);
+void result_vote_handler(Client* client, const Request* req);
+void close_vote_handler(Client* client, const Request* req);
+void list_vote_handler(Client* client, const Request* req);
+void respond_batch_handler(Client* client, const Request* req);
+void subscribe_survey_handler(Client* client, const Request* req);
+void subscribe_vote_handler(Client* client, const Request* req);
+void stats_handler(Client* client, const Request* req);
+
+// 스레드 모드의 연결 하나를 처리하는 스레드 (인자는 소켓 번호를 담은 포인터 값)
+void* handle_client(void* arg);
+
+// 빈 항목 저장소(인덱스, LIST 응답 캐시) 준비 - recover_data() 가 먼저 호출하며, 복구 없이 load_text_files() 만 쓸 때는 직접 호출
+void item_store_init(void);
+// 시작 시 스냅샷(없거나 import_text 이면 텍스트 파일)을 읽고 로그를 재생한 뒤 로그를 엶 (실패 시 -1)
+int  recover_data(int import_text);
+// data/survey, data/vote 의 텍스트 파일을 모두 읽어 목록/인덱스에 넣음 (다른 스레드가 항목에 접근하기 전에 호출)
+void load_text_files(void);
+int  save_survey_to_file(Survey* survey);
+int  save_vote_to_file(Vote* vote);
+// 로그 크기/주기에 따라 체크포인트를 수행하는 스레드
+void* checkpoint_main(void* arg);
+
+Survey* find_survey(const char* id);
+Vote*   find_vote(const char* id);
+// 제목을 ID 의 기본 부분으로 변환 (영문은 소문자, 공백은 하이픈 하나, 한글 등은 UTF-8 그대로)
+void slugify(const char* input, char* output, size_t max_len);
+// STATS 응답과 -s 출력의 계측 보고를 buf 에 씀 - 쓴 길이 반환
+size_t render_stats(char* buf, size_t size);
+
+// 프레임 방식 연결의 수신 재조립 버퍼 - recv() 로 받은 조각을 이어 붙이고 완성된 프레임을 꺼냄
+typedef struct FrameBuffer {
+    char*  data;
+    size_t start; // 아직 꺼내지 않은 첫 바이트 위치
+    size_t len;   // 채워진 끝 위치
+    size_t cap;
+} FrameBuffer;
+
+int  frame_buffer_append(FrameBuffer* fb, const char* data, size_t len);
+// 완성된 프레임이 있으면 1 (payload/len 은 다음 append 전까지 유효), 더 받아야 하면 0,
+// 길이가 MAX_FRAME_LEN 을 넘으면 -1
+int  frame_buffer_next(FrameBuffer* fb, const char** payload, size_t* len);
+void frame_buffer_free(FrameBuffer* fb);
+
+// reactor.c: edge-triggered epoll 이벤트 루프
+int  reactor_start(int loop_count);
+void reactor_add_client(int client_fd);
+// epoll 모드 연결로 응답 전송 - 보낼 수 있는 만큼 바로 보내고, 나머지는 송신 대기열에 복사해 두었다가
+// 소켓이 쓰기 가능해지면 이벤트 루프가 이어 보냄 (기다리지 않음). 연결이 닫혔거나 메모리가 부족하면 -1
+int  reactor_send(Client* client, struct iovec* iov, int iovcnt, int more);
+// 구독 전환: 아직 보내지 못한 응답을 take 에 넘기고, take 가 0 을 반환하면 그 응답을 대기열에서 지우고
+// 이후의 출력을 막음 (take 가 넘겨받은 바이트를 대신 보냄). take 의 반환값을 그대로 반환
+typedef int (*OutputTakeFn)(void* arg, const char* pending, size_t len);
+int  reactor_hand_over_output(Client* client, OutputTakeFn take, void* arg);
+
+#endif  // SURVEY_VOTE_SERVER_H
@@ -2,56 +2,154 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
-#include <arpa/inet.h>
 #include <pthread.h>
 #include <ctype.h>
 #include "../include/common.h"
+#include "server.h"
+#include "thread_pool.h"
+#include "item_index.h"
+#include "voter_set.h"
+#include "hash.h"
+#include "wal.h"
+#include "snapshot.h"
+#include "request.h"
+#include "seqlock.h"
+#include "hot_item.h"
+#include "reply_cache.h"
+#include "pool.h"
+#include "id_registry.h"
+#include "subscription.h"
+#include "stats.h"
 #include <time.h>
-#include <sys/stat.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
 #include <dirent.h>
 
-#define SERVER_PORT 9000
-#define BACKLOG     5
-
-void* handle_client(void* arg);
-void create_survey_handler(int sockfd, char* msg);
-void respond_survey_handler(int sockfd, char* msg);
-void result_survey_handler(int sockfd, char* msg);
-void close_survey_handler(int sockfd, char* msg);
-void list_survey_handler(int sockfd, char* msg);
-void create_vote_handler(int sockfd, char* msg);
-void respond_vote_handler(int sockfd, char* msg);
-void result_vote_handler(int sockfd, char* msg);
-void close_vote_handler(int sockfd, char* msg);
-void list_vote_handler(int sockfd, char* msg);
-void load_surveys();
-void load_votes();
-void save_survey_to_file(Survey* survey);
-void save_vote_to_file(Vote* vote);
-void slugify(const char* input, char* output, size_t max_len);
-int id_exists(const char* id, const char* type);
+// 텍스트 파일을 읽을 때 디렉토리마다 쓰는 파싱 스레드 수의 상한과, 스레드 하나당 최소 파일 수
+#define MAX_LOAD_THREADS      8
+#define LOAD_FILES_PER_THREAD 64
+
+// RESPOND_BATCH 한 요청에 담을 수 있는 응답 수의 상한
+#define MAX_BATCH_BALLOTS 8192
+// RESPOND_BATCH 응답 한 건에서 반영하는 보기 수의 상한 (같은 보기를 여러 번 적어도 여기까지만)
+#define BATCH_MAX_CHOICES 32
+
+// LIST_*|커서|개수 에서 개수를 생략하거나 잘못 줬을 때의 기본값과 상한
+#define LIST_PAGE_DEFAULT 100
+#define LIST_PAGE_MAX     1000
+
+// 로그 크기와 상관없이 변경이 있으면 이 주기(초)마다 체크포인트 (스냅샷, 텍스트 파일 갱신)
+#define CHECKPOINT_INTERVAL_SEC 60
 
 // 전역 변수
-static Survey* survey_head = NULL;
-static Vote* vote_head = NULL;
-pthread_mutex_t data_lock;
+// 목록 머리는 쓰기 잠금 안에서만 바뀌지만, 목록을 훑기만 하는 쪽은 잠금 없이 읽음
+static Survey* _Atomic survey_head = NULL;
+static Vote* _Atomic vote_head = NULL;
+// 리스트 구조(노드 추가, 순회)만 보호하는 잠금 - 항목 내용은 각 항목의 lock 이 보호
+// 항목은 삭제되지 않으므로, 찾은 노드 포인터는 목록 잠금을 푼 뒤에도 계속 유효
+static pthread_rwlock_t survey_list_lock = PTHREAD_RWLOCK_INITIALIZER;
+static pthread_rwlock_t vote_list_lock   = PTHREAD_RWLOCK_INITIALIZER;
+// ID -> 항목 해시 인덱스 (각 목록 잠금으로 함께 보호)
+static ItemIndex survey_index;
+static ItemIndex vote_index;
+// 새 ID 를 정할 때 쓰는 기본 ID 별 다음 번호와 메모리에 없는 항목 파일 이름 (각 목록 잠금으로 함께 보호)
+static IdRegistry survey_ids;
+static IdRegistry vote_ids;
+// 항목 본체와 문자열(ItemText)은 종류별 풀에서 잘라 씀 (항목은 지워지지 않으므로 돌려주지 않음)
+static Pool survey_pool = POOL_INITIALIZER("survey", sizeof(Survey));
+static Pool survey_text_pool = POOL_INITIALIZER("survey_text", sizeof(ItemText));
+static Pool vote_pool = POOL_INITIALIZER("vote", sizeof(Vote));
+static Pool vote_text_pool = POOL_INITIALIZER("vote_text", sizeof(ItemText));
+// LIST 응답 캐시 - 목록 버전은 항목이 추가되거나 종료될 때(목록에 보이는 내용이 바뀔 때) 증가
+// 조건부 LIST 에도 쓰이므로, 재시작 뒤 이전 실행에서 준 버전과 겹치지 않게 시작할 때 시각(us)으로 다시 맞춤
+static ReplySlot* survey_list_reply;
+static ReplySlot* vote_list_reply;
+static atomic_ulong survey_list_version = 1;
+static atomic_ulong vote_list_version = 1;
+
+// UTF-8 글자 하나를 읽어 코드 포인트를 *cp 에 쓰고 바이트 수를 반환
+// 잘못된 바이트열(잘린 글자, 과잉 길이 인코딩, 서로게이트 등)이면 *cp = -1 로 하고 1 바이트만 건너뜀
+static int utf8_decode(const unsigned char* s, long* cp) {
+    int len = s[0] >= 0xF0 ? 4 : s[0] >= 0xE0 ? 3 : s[0] >= 0xC0 ? 2 : 1;
+    long min = len == 4 ? 0x10000 : len == 3 ? 0x800 : 0x80;
+    long value = len == 4 ? (s[0] & 0x07) : len == 3 ? (s[0] & 0x0F) : (s[0] & 0x1F);
+
+    *cp = -1;
+    if (len == 1 || s[0] >= 0xF8) return 1;
+    for (int k = 1; k < len; k++) {
+        if ((s[k] & 0xC0) != 0x80) return 1;
+        value = (value << 6) | (s[k] & 0x3F);
+    }
+    if (value < min || value > 0x10FFFF || (value >= 0xD800 && value <= 0xDFFF)) return 1;
+    *cp = value;
+    return len;
+}
+
+// 영문/숫자가 아닌 글자를 ID 에서 어떻게 다룰지: 1 = 글자로 남김, 0 = 공백(하이픈), -1 = 버림
+// 한글/한자/가나 등 문자는 남기고, 유니코드 공백은 ASCII 공백처럼, 구두점/기호/이모지는 ASCII 구두점처럼 다룸
+static int slug_class(long cp) {
+    if (cp == 0xA0 || cp == 0x1680 || (cp >= 0x2000 && cp <= 0x200A) ||
+        cp == 0x2028 || cp == 0x2029 || cp == 0x202F || cp == 0x205F || cp == 0x3000) {
+        return 0;
+    }
+    if (cp < 0xC0 || cp == 0xD7 || cp == 0xF7 ||
+        (cp >= 0x2000 && cp <= 0x2BFF) ||   // 일반 구두점, 화살표, 수학/도형 기호
+        (cp >= 0x3000 && cp <= 0x303F) ||   // CJK 기호와 구두점
+        (cp >= 0xE000 && cp <= 0xF8FF) ||   // 사용자 정의 영역
+        (cp >= 0xFE00 && cp <= 0xFE0F) ||   // 이체자 선택자
+        (cp >= 0xFF00 && cp <= 0xFF65) ||   // 전각 ASCII (영문/숫자는 먼저 ASCII 로 바꿈)
+        (cp >= 0xFFF0 && cp <= 0xFFFF) ||   // 특수 문자
+        (cp >= 0x1F000 && cp <= 0x1FAFF)) { // 이모지
+        return -1;
+    }
+    return 1;
+}
 
-// 문자열을 소문자 및 하이픈(-)으로 구성된 ID로 변환
+// 문자열을 ID로 변환 - 영문은 소문자로, 공백은 하이픈(-) 하나로, 한글 등 영문 이외의 문자는 UTF-8 그대로 남김
+// 글자 단위로 자르므로 max_len 에 걸려도 UTF-8 글자가 중간에서 잘리지 않음
 void slugify(const char* input, char* output, size_t max_len) {
+    const unsigned char* in = (const unsigned char*)input;
     size_t i = 0, j = 0;
     int last_char_is_hyphen = 0;
 
-    while (input[i] != '\0' && j < max_len - 1) {
-        if (isalnum(input[i])) {
-            output[j++] = tolower(input[i]);
+    while (in[i] != '\0' && j < max_len - 1) {
+        unsigned char c = in[i];
+        if (c < 0x80) {
+            // isalnum/isspace 에는 unsigned char 범위의 값만 넘김 (음수 char 는 정의되지 않은 동작)
+            if (isalnum(c)) {
+                output[j++] = (char)tolower(c);
+                last_char_is_hyphen = 0;
+            } else if (isspace(c) && !last_char_is_hyphen) {
+                output[j++] = '-';
+                last_char_is_hyphen = 1;
+            }
+            i++;
+            continue;
+        }
+
+        long cp;
+        int len = utf8_decode(in + i, &cp);
+        // 전각 영문/숫자는 ASCII 로 바꿔 같은 제목이 같은 ID 가 되게 함
+        if ((cp >= 0xFF10 && cp <= 0xFF19) || (cp >= 0xFF21 && cp <= 0xFF3A) || (cp >= 0xFF41 && cp <= 0xFF5A)) {
+            output[j++] = (char)tolower((int)(cp - 0xFF00 + 0x20));
             last_char_is_hyphen = 0;
-        } else if (isspace(input[i])) {
-            if (!last_char_is_hyphen) {
+        } else if (cp >= 0) {
+            int kind = slug_class(cp);
+            if (kind > 0) {
+                if (j + (size_t)len > max_len - 1) break;
+                memcpy(output + j, in + i, (size_t)len);
+                j += (size_t)len;
+                last_char_is_hyphen = 0;
+            } else if (kind == 0 && !last_char_is_hyphen) {
                 output[j++] = '-';
                 last_char_is_hyphen = 1;
             }
         }
-        i++;
+        i += (size_t)len;
     }
     if (j > 0 && output[j - 1] == '-') {
         output[j - 1] = '\0';
@@ -60,753 +158,2193 @@ void slugify(const char* input, char* output, size_t max_len) {
     }
 }
 
-// ID에 해당하는 파일이 존재하는지 확인
-int id_exists(const char* id, const char* type) {
-    char filename[256];
-    snprintf(filename, sizeof(filename), "data/%s/%s.txt", type, id);
-    if (access(filename, F_OK) == 0) {
-        return 1;
+// iovec 들을 끝까지 전송 - epoll 모드 연결은 바로 못 보낸 나머지를 연결의 송신 대기열에 넘기고 돌아옴
+// 스레드 모드 연결은 블로킹 소켓이라 그 연결 전용 스레드가 다 보낼 때까지 기다림 - 받는 쪽이 읽지 않아
+// SEND_TIMEOUT_MS 동안 보내지 못하면 sendmsg 가 EAGAIN 으로 끝나므로(SO_SNDTIMEO) 실패로 처리하고,
+// 소켓을 shutdown 해 남은 명령의 응답은 바로 실패하고 연결 스레드는 다음 recv() 에서 끝나게 함
+// 보내는 동안 iov 의 내용을 바꾸므로 호출자는 다시 쓰지 않아야 함
+// more 이면 이어서 보낼 내용이 있다고 알려(MSG_MORE) 덜 찬 패킷이 ACK 를 기다리며 멈추지 않게 함
+static int send_iov(Client* client, struct iovec* cur, int iovcnt, int more) {
+    if (client->conn) {
+        return reactor_send(client, cur, iovcnt, more);
+    }
+    while (iovcnt > 0) {
+        struct msghdr mh = { .msg_iov = cur, .msg_iovlen = iovcnt };
+        ssize_t n = sendmsg(client->fd, &mh, MSG_NOSIGNAL | (more ? MSG_MORE : 0));
+        if (n >= 0) {
+            // 보낸 만큼 iovec 을 앞으로 밀기 (부분 전송)
+            while (iovcnt > 0 && (size_t)n >= cur->iov_len) {
+                n -= cur->iov_len;
+                cur++;
+                iovcnt--;
+            }
+            if (iovcnt > 0) {
+                cur->iov_base = (char*)cur->iov_base + n;
+                cur->iov_len -= n;
+            }
+            continue;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        shutdown(client->fd, SHUT_RDWR);
+        return -1;
     }
     return 0;
 }
 
-// 서버 프로그램의 진입점 - 클라이언트 요청을 기다리고 각 요청을 새 스레드로 처리
-int main() {
-    int server_fd, client_fd;
-    struct sockaddr_in server_addr, client_addr;
-    socklen_t addr_len = sizeof(client_addr);
-    pthread_t tid;
-
-    server_fd = socket(AF_INET, SOCK_STREAM, 0);
-    if (server_fd < 0) {
-        perror("socket() failed");
-        exit(EXIT_FAILURE);
-    }
-
-    memset(&server_addr, 0, sizeof(server_addr));
-    server_addr.sin_family      = AF_INET;
-    server_addr.sin_addr.s_addr = INADDR_ANY;
-    server_addr.sin_port        = htons(SERVER_PORT);
-
-    if (bind(server_fd, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
-        perror("bind() failed");
-        close(server_fd);
-        exit(EXIT_FAILURE);
-    }
+static void encode_frame_header(unsigned char* header, size_t len) {
+    header[0] = (unsigned char)(len >> 24);
+    header[1] = (unsigned char)(len >> 16);
+    header[2] = (unsigned char)(len >> 8);
+    header[3] = (unsigned char)len;
+}
 
-    if (listen(server_fd, BACKLOG) < 0) {
-        perror("listen() failed");
-        close(server_fd);
-        exit(EXIT_FAILURE);
+// 응답 전송 - 프레임 방식 연결이면 4바이트 길이 머리와 본문을 한 번의 sendmsg() 로 함께 보냄
+int send_reply(Client* client, const char* buf, size_t len) {
+    unsigned char header[FRAME_HEADER_LEN];
+    struct iovec iov[2];
+    int iovcnt = 0;
+
+    if (client->framed == 1) {
+        encode_frame_header(header, len);
+        iov[iovcnt].iov_base = header;
+        iov[iovcnt].iov_len = sizeof(header);
+        iovcnt++;
     }
+    iov[iovcnt].iov_base = (void*)buf;
+    iov[iovcnt].iov_len = len;
+    iovcnt++;
+    return send_iov(client, iov, iovcnt, 0);
+}
 
-    if (pthread_mutex_init(&data_lock, NULL) != 0) {
-        perror("mutex init failed");
-        exit(EXIT_FAILURE);
+// 조건부 요청의 응답: 본문 뒤에 "[VERSION] 버전" 줄을 붙여 한 번에 보냄 (version 이 0 이면 send_reply 와 같음)
+static int send_versioned_reply(Client* client, const char* buf, size_t len, unsigned long version) {
+    if (version == 0) return send_reply(client, buf, len);
+
+    char line[40];
+    size_t line_len = (size_t)snprintf(line, sizeof(line), "[VERSION] %lu\n", version);
+    unsigned char header[FRAME_HEADER_LEN];
+    struct iovec iov[3];
+    int iovcnt = 0;
+
+    if (client->framed == 1) {
+        encode_frame_header(header, len + line_len);
+        iov[iovcnt].iov_base = header;
+        iov[iovcnt].iov_len = sizeof(header);
+        iovcnt++;
     }
-    
-    mkdir("data", 0755);
-    mkdir("data/survey", 0755);
-    mkdir("data/vote", 0755);
+    iov[iovcnt].iov_base = (void*)buf;
+    iov[iovcnt].iov_len = len;
+    iovcnt++;
+    iov[iovcnt].iov_base = line;
+    iov[iovcnt].iov_len = line_len;
+    iovcnt++;
+    return send_iov(client, iov, iovcnt, 0);
+}
 
-    load_surveys();
-    load_votes();
-    printf(">> Server listening on port %d\n", SERVER_PORT);
+// 클라이언트가 가진 버전(known)이 지금 버전과 같으면 "[NOT MODIFIED] 버전" 만 보내고 1 반환
+static int send_if_not_modified(Client* client, StrView known, unsigned long version) {
+    if (strview_to_version(known) != version) return 0;
+    char resp[48];
+    int len = snprintf(resp, sizeof(resp), "[NOT MODIFIED] %lu", version);
+    send_reply(client, resp, (size_t)len);
+    return 1;
+}
 
-    while (1) {
-        client_fd = accept(server_fd, (struct sockaddr*)&client_addr, &addr_len);
-        if (client_fd < 0) {
-            perror("accept() failed");
-            continue;
-        }
-        printf(">> Client connected: %s:%d\n",
-               inet_ntoa(client_addr.sin_addr),
-               ntohs(client_addr.sin_port));
-
-        // --- [수정] --- 스레드에 안전한 방식으로 인자 전달 ---
-        int* p_client_fd = malloc(sizeof(int));
-        *p_client_fd = client_fd;
-        if (pthread_create(&tid, NULL, handle_client, p_client_fd) != 0) {
-            perror("pthread_create() failed");
-            close(client_fd);
-            free(p_client_fd);
-        }
-        // --- 수정 끝 ---
-        pthread_detach(tid);
+// STATS 응답과 -s 출력에 쓰는 계측 보고 - 명령은 한 번이라도 처리한 것만, 나머지 계측은 항상 출력
+// 시간은 us 단위이며 백분위는 히스토그램 칸의 중간값 (상대 오차 25% 이내)
+size_t render_stats(char* buf, size_t size) {
+    StatsReport* report = buffer_alloc(sizeof(StatsReport));
+    if (!report) return (size_t)snprintf(buf, size, "[ERROR] Server is out of memory.");
+    stats_collect(report);
+
+    ThreadPoolStats pool;
+    SubscriptionStats subs;
+    thread_pool_get_stats(&pool);
+    subscription_get_stats(&subs);
+
+    size_t offset = 0;
+#define STATS_APPEND(...) \
+    do { if (offset < size) offset += (size_t)snprintf(buf + offset, size - offset, __VA_ARGS__); } while (0)
+    STATS_APPEND("[OK] Server stats: uptime %.1fs, connections %ld open / %llu accepted, threads %d "
+                 "(workers %d, recording %d), subscribers %zu\n",
+                 report->uptime_sec, report->connections, report->accepted, report->threads,
+                 pool.workers, report->stat_threads, subs.subscribers);
+    STATS_APPEND("%-16s %10s %9s %9s %9s %9s %9s\n", "metric", "count", "avg_us", "p50_us", "p99_us", "p999_us", "max_us");
+    for (int m = 0; m < STATS_METRIC_COUNT; m++) {
+        const StatsSummary* h = &report->metrics[m];
+        if (m < REQ_TYPE_COUNT && h->count == 0) continue;
+        STATS_APPEND("%-16s %10llu %9.1f %9.1f %9.1f %9.1f %9.1f\n",
+                     stats_metric_name(m), h->count,
+                     h->count ? (double)h->sum_ns / h->count / 1000.0 : 0.0,
+                     stats_percentile(h, 0.50) / 1000.0, stats_percentile(h, 0.99) / 1000.0,
+                     stats_percentile(h, 0.999) / 1000.0, h->max_ns / 1000.0);
     }
-
-    pthread_mutex_destroy(&data_lock);
-    close(server_fd);
-    return 0;
+#undef STATS_APPEND
+    buffer_free(report, sizeof(StatsReport));
+    return offset < size ? offset : size - 1;
 }
 
 void* handle_client(void* arg)
 {
-    // --- [수정] --- 스레드 시작 시 인자를 안전하게 복사하고 메모리 해제 ---
-    int sockfd = *(int*)arg;
-    free(arg);
-    // --- 수정 끝 ---
+    int sockfd = (int)(intptr_t)arg;
 
+    Client client = { .fd = sockfd, .framed = -1 };
+    FrameBuffer frames = { 0 };
     char buffer[BUFFER_SIZE];
     int bytes;
 
+    stats_connection_opened();
     while ((bytes = recv(sockfd, buffer, sizeof(buffer) - 1, 0)) > 0) {
-        // 클라이언트로부터 메시지 수신
-        buffer[bytes] = '\0';
-        
-        // 원본 메시지를 변경하지 않기 위해 복사본 생성
-        char msg_copy[BUFFER_SIZE];
-        strncpy(msg_copy, buffer, sizeof(msg_copy));
-
-        // 설문 생성 요청 처리
-        if (strncmp(msg_copy, CMD_CREATE_SURVEY, strlen(CMD_CREATE_SURVEY)) == 0) {
-            create_survey_handler(sockfd, msg_copy);
-        }
-        // 설문 응답 요청 처리
-        else if (strncmp(msg_copy, CMD_RESPOND_SURVEY, strlen(CMD_RESPOND_SURVEY)) == 0) {
-            respond_survey_handler(sockfd, msg_copy);
-        }
-        // 설문 결과 요청 처리
-        else if (strncmp(msg_copy, CMD_RESULT_SURVEY, strlen(CMD_RESULT_SURVEY)) == 0) {
-            result_survey_handler(sockfd, msg_copy);
-        }
-        // 설문 종료 요청 처리
-        else if (strncmp(msg_copy, CMD_CLOSE_SURVEY, strlen(CMD_CLOSE_SURVEY)) == 0) {
-            close_survey_handler(sockfd, msg_copy);
-        }
-        // 투표 생성 요청 처리
-        else if (strncmp(msg_copy, CMD_CREATE_VOTE, strlen(CMD_CREATE_VOTE)) == 0) {
-            create_vote_handler(sockfd, msg_copy);
+        // 첫 바이트로 연결 방식 결정 - 명령어는 영문자로 시작하므로 0x00 이면 길이 머리
+        if (client.framed < 0) {
+            client.framed = (buffer[0] == 0);
         }
-        // 투표 응답 요청 처리
-        else if (strncmp(msg_copy, CMD_RESPOND_VOTE, strlen(CMD_RESPOND_VOTE)) == 0) {
-            respond_vote_handler(sockfd, msg_copy);
-        }
-        // 투표 결과 요청 처리
-        else if (strncmp(msg_copy, CMD_RESULT_VOTE, strlen(CMD_RESULT_VOTE)) == 0) {
-            result_vote_handler(sockfd, msg_copy);
-        }
-        // 투표 종료 요청 처리
-        else if (strncmp(msg_copy, CMD_CLOSE_VOTE, strlen(CMD_CLOSE_VOTE)) == 0) {
-            close_vote_handler(sockfd, msg_copy);
+        // 기존 방식: recv() 한 번에 받은 내용을 명령 한 건으로 처리
+        if (!client.framed) {
+            buffer[bytes] = '\0';
+            dispatch_command(&client, buffer, bytes);
+            if (atomic_load(&client.detached)) break;
+            continue;
         }
-        // 설문 목록 요청 처리
-        else if (strncmp(msg_copy, CMD_LIST_SURVEY, strlen(CMD_LIST_SURVEY)) == 0) {
-            list_survey_handler(sockfd, msg_copy);
+        // 프레임 방식: 완성된 프레임을 받은 순서대로 모두 처리 (파이프라이닝)
+        if (frame_buffer_append(&frames, buffer, bytes) != 0) {
+            break;
         }
-        // 투표 목록 요청 처리
-        else if (strncmp(msg_copy, CMD_LIST_VOTE, strlen(CMD_LIST_VOTE)) == 0) {
-            list_vote_handler(sockfd, msg_copy);
+        const char* payload;
+        size_t len;
+        int ret;
+        while ((ret = frame_buffer_next(&frames, &payload, &len)) > 0) {
+            dispatch_command(&client, payload, len);
+            if (atomic_load(&client.detached)) break;
         }
-        else {
-            send(sockfd, "[ERROR] Unknown command", strlen("[ERROR] Unknown command"), 0);
+        // 구독으로 넘겨진 연결은 이 스레드가 가진 번호만 닫음 (fan-out 스레드가 dup 한 번호로 계속 보냄)
+        if (atomic_load(&client.detached)) break;
+        if (ret < 0) {
+            fprintf(stderr, ">> Frame too large, closing connection\n");
+            break;
         }
     }
 
     printf(">> Client disconnected\n");
+    stats_connection_closed();
+    frame_buffer_free(&frames);
     close(sockfd);
     return NULL;
 }
 
-void save_survey_to_file(Survey* survey) {
+static void unknown_command_handler(Client* client, const Request* req) {
+    (void)req;
+    send_reply(client, "[ERROR] Unknown command", strlen("[ERROR] Unknown command"));
+}
+
+// 명령 종류 -> *_handler 표 (REQ_UNKNOWN 은 오류 응답)
+typedef void (*request_handler)(Client* client, const Request* req);
+static const request_handler request_handlers[REQ_TYPE_COUNT] = {
+    [REQ_UNKNOWN]        = unknown_command_handler,
+    [REQ_CREATE_SURVEY]  = create_survey_handler,
+    [REQ_RESPOND_SURVEY] = respond_survey_handler,
+    [REQ_RESULT_SURVEY]  = result_survey_handler,
+    [REQ_CLOSE_SURVEY]   = close_survey_handler,
+    [REQ_LIST_SURVEY]    = list_survey_handler,
+    [REQ_CREATE_VOTE]    = create_vote_handler,
+    [REQ_RESPOND_VOTE]   = respond_vote_handler,
+    [REQ_RESULT_VOTE]    = result_vote_handler,
+    [REQ_CLOSE_VOTE]     = close_vote_handler,
+    [REQ_LIST_VOTE]      = list_vote_handler,
+    [REQ_RESPOND_BATCH]  = respond_batch_handler,
+    [REQ_SUBSCRIBE_SURVEY] = subscribe_survey_handler,
+    [REQ_SUBSCRIBE_VOTE]   = subscribe_vote_handler,
+    [REQ_STATS]          = stats_handler,
+};
+
+// 수신한 명령 한 건을 나눠서 명령어에 맞는 *_handler로 분배
+// 핸들러는 수신 버퍼를 직접 가리키는 필드 view 를 받으므로 메시지를 복사하지 않음
+// 파싱부터 응답 전송까지 걸린 시간을 명령 종류별 히스토그램에 기록 (이 스레드의 카운터)
+void dispatch_command(Client* client, const char* buffer, size_t len)
+{
+    Request req;
+    long long start = stats_now_ns();
+    request_parse(buffer, len, &req);
+    request_handlers[req.type](client, &req);
+    stats_record(req.type, stats_now_ns() - start);
+}
+
+// 잠금이 초기화된 빈 설문 노드 생성
+static Survey* new_survey_node(void) {
+    Survey* node = pool_alloc(&survey_pool);
+    ItemText* text = pool_alloc(&survey_text_pool);
+    VoterSet* voters = voter_set_create();
+    ReplySlot* reply = reply_slot_create();
+    if (!node || !text || !voters || !reply) {
+        perror("failed to allocate survey");
+        exit(EXIT_FAILURE);
+    }
+    node->question = text->title;
+    node->options = text->options;
+    node->voters = voters;
+    node->result_reply = reply;
+    pthread_mutex_init(&node->lock, NULL);
+    pthread_mutex_init(&node->file_lock, NULL);
+    return node;
+}
+
+// 잠금이 초기화된 빈 투표 노드 생성
+static Vote* new_vote_node(void) {
+    Vote* node = pool_alloc(&vote_pool);
+    ItemText* text = pool_alloc(&vote_text_pool);
+    VoterSet* voters = voter_set_create();
+    ReplySlot* reply = reply_slot_create();
+    if (!node || !text || !voters || !reply) {
+        perror("failed to allocate vote");
+        exit(EXIT_FAILURE);
+    }
+    node->title = text->title;
+    node->options = text->options;
+    node->voters = voters;
+    node->result_reply = reply;
+    pthread_mutex_init(&node->lock, NULL);
+    pthread_mutex_init(&node->file_lock, NULL);
+    return node;
+}
+
+// ID로 설문 찾기 - survey_list_lock 을 잡은 상태에서 호출
+static Survey* find_survey_locked(const char* id) {
+    return item_index_find(&survey_index, id);
+}
+
+// ID로 투표 찾기 - vote_list_lock 을 잡은 상태에서 호출
+static Vote* find_vote_locked(const char* id) {
+    return item_index_find(&vote_index, id);
+}
+
+// id_registry_assign 이 메모리의 항목을 확인할 때 쓰는 함수 - 각 목록 쓰기 잠금을 잡은 상태에서 호출됨
+static int survey_id_in_use(const char* id) {
+    return find_survey_locked(id) != NULL;
+}
+
+static int vote_id_in_use(const char* id) {
+    return find_vote_locked(id) != NULL;
+}
+
+// 새 설문을 목록과 인덱스에 추가 - survey_list_lock 쓰기 잠금 상태에서 호출
+static void insert_survey_locked(Survey* node) {
+    node->next = atomic_load_explicit(&survey_head, memory_order_relaxed);
+    atomic_store_explicit(&survey_head, node, memory_order_release);
+    item_index_insert(&survey_index, node);
+    atomic_fetch_add_explicit(&survey_list_version, 1, memory_order_release);
+}
+
+static void insert_vote_locked(Vote* node) {
+    node->next = atomic_load_explicit(&vote_head, memory_order_relaxed);
+    atomic_store_explicit(&vote_head, node, memory_order_release);
+    item_index_insert(&vote_index, node);
+    atomic_fetch_add_explicit(&vote_list_version, 1, memory_order_release);
+}
+
+Survey* find_survey(const char* id) {
+    pthread_rwlock_rdlock(&survey_list_lock);
+    Survey* cur = find_survey_locked(id);
+    pthread_rwlock_unlock(&survey_list_lock);
+    return cur;
+}
+
+Vote* find_vote(const char* id) {
+    pthread_rwlock_rdlock(&vote_list_lock);
+    Vote* cur = find_vote_locked(id);
+    pthread_rwlock_unlock(&vote_list_lock);
+    return cur;
+}
+
+// 요청 필드의 ID 로 찾기 - id 는 view 를 복사해 둔 버퍼 (ID_LENGTH 보다 길면 잘린 값이 다른 항목과
+// 겹치지 않도록 찾지 않음)
+static Survey* find_survey_view(StrView view, const char* id) {
+    return view.len < ID_LENGTH ? find_survey(id) : NULL;
+}
+
+static Vote* find_vote_view(StrView view, const char* id) {
+    return view.len < ID_LENGTH ? find_vote(id) : NULL;
+}
+
+// 설문/투표에서 응답 반영에 쓰는 필드만 가리키는 묶음 - 두 구조체를 한 코드로 처리
+typedef struct BallotTarget {
+    pthread_mutex_t* lock;
+    ItemStatus* status;
+    struct VoterSet* voters;
+    int* voter_count;
+    int* votes;
+    int option_count;
+    unsigned long* change_seq;
+    atomic_uint* tally_seq;
+    atomic_uint* contention;
+    atomic_uint* contention_window;
+    HotItem* _Atomic* hot;
+    const char* id;
+} BallotTarget;
+
+static BallotTarget survey_target(Survey* cur) {
+    return (BallotTarget){ &cur->lock, &cur->status, cur->voters, &cur->voter_count, cur->votes,
+                           cur->option_count, &cur->change_seq, &cur->tally_seq, &cur->contention,
+                           &cur->contention_window, &cur->hot, cur->id };
+}
+
+static BallotTarget vote_target(Vote* cur) {
+    return (BallotTarget){ &cur->lock, &cur->status, cur->voters, &cur->voter_count, cur->votes,
+                           cur->option_count, &cur->change_seq, &cur->tally_seq, &cur->contention,
+                           &cur->contention_window, &cur->hot, cur->id };
+}
+
+// 집계(보기별 득표, 참여자 수, 상태)를 잠금 없이 일관되게 떠 둔 사본
+// 쓰는 쪽은 항목 lock 안에서 tally_seq 로 감싸 바꾸므로, 읽는 쪽은 항목 lock 을 잡지 않음
+typedef struct Tally {
+    int votes[MAX_OPTIONS];
+    int voter_count;
+    ItemStatus status;
+    unsigned long version; // 항목 버전 (tally_version) - 응답이 반영되거나 종료될 때마다 커짐
+} Tally;
+
+// 항목 버전: 1 + 2 * 참여자 수 + (종료면 1)
+// 응답 하나는 참여자 수를 정확히 하나 올리고 종료된 항목은 응답을 더 받지 않으므로 응답/종료마다 커짐.
+// 같은 버전이면 집계도 같은 것은 read_tally 가 한 시점의 집계만 돌려주기 때문 - 응답들은 반영을 끝낸 순서로
+// 줄 세울 수 있고, 한 시점의 집계는 그 순서의 앞에서부터 참여자 수만큼의 응답이므로 참여자 수가 같으면 같은
+// 응답들임. 샤드로 전환된 항목은 샤드마다 따로 반영되므로, 샤드들을 서로 다른 시점에 읽어 더하면 이 성질이
+// 깨짐 (hot_item_add_tally 가 모든 샤드를 한 시점의 값으로 읽는 이유).
+// 저장된 집계에서 바로 나오므로 따로 저장하지 않아도 재시작 뒤에 이어지고, 샤드를 본체로 합쳐도 바뀌지 않음
+static unsigned long tally_version(int voter_count, ItemStatus status) {
+    return 1 + 2 * (unsigned long)voter_count + (status == STATUS_CLOSED);
+}
+
+// 샤드로 전환된 항목은 샤드 집계도 더함 - 샤드를 본체로 합치는 동안에는 본체 tally_seq 가 홀수이므로
+// 합치기와 겹친 읽기는 다시 읽게 되어 같은 응답을 두 번 세지 않음
+static void read_tally(const BallotTarget* t, Tally* out) {
+    HotItem* hot = atomic_load_explicit(t->hot, memory_order_acquire);
+    unsigned start;
+    do {
+        start = seqlock_read_begin(t->tally_seq);
+        memcpy(out->votes, t->votes, sizeof(out->votes));
+        out->voter_count = *t->voter_count;
+        out->status = *t->status;
+        if (hot) hot_item_add_tally(hot, out->votes, &out->voter_count);
+    } while (seqlock_read_retry(t->tally_seq, start));
+    out->version = tally_version(out->voter_count, out->status);
+}
+
+static void read_survey_tally(Survey* survey, Tally* out) {
+    BallotTarget t = survey_target(survey);
+    read_tally(&t, out);
+}
+
+static void read_vote_tally(Vote* vote, Tally* out) {
+    BallotTarget t = vote_target(vote);
+    read_tally(&t, out);
+}
+
+// 샤드에 쌓인 응답을 항목 본체로 합침 - 항목 lock 을 잡은 상태에서 호출
+// 저장 코드는 본체(voters/votes/voter_count)만 보므로 저장 직전에 부름
+// 다 합치지 못하면 -1 - 본체에 빠진 응답이 있으므로 스냅샷을 확정하지 않음 (로그를 남겨 둠)
+static int fold_hot_item(const BallotTarget* t) {
+    HotItem* hot = atomic_load_explicit(t->hot, memory_order_relaxed);
+    size_t moved;
+    int ret;
+    if (!hot) return 0;
+    hot_item_lock_all(hot);
+    ret = hot_item_fold(hot, t->voters, t->votes, t->voter_count, t->tally_seq, &moved);
+    if (moved > 0) (*t->change_seq)++;
+    hot_item_unlock_all(hot);
+    if (ret < 0) {
+        fprintf(stderr, ">> Out of memory while folding hot item %s, keeping its shards\n", t->id);
+    }
+    return ret;
+}
+
+// 항목 lock 안에서 떠 둔 스냅샷을 잠금 밖에서 파일로 저장
+// 같은 항목을 여러 스레드가 저장할 때 더 오래된 스냅샷이 나중에 덮어쓰지 않도록
+// file_lock 아래에서 change_seq 를 비교한다
+static int persist_survey(Survey* survey, Survey* snapshot, unsigned long seq) {
+    int ret = 0;
+    pthread_mutex_lock(&survey->file_lock);
+    if (seq > survey->saved_seq) {
+        long long start = stats_now_ns();
+        ret = save_survey_to_file(snapshot);
+        stats_record(STATS_PERSIST, stats_now_ns() - start);
+        if (ret == 0) survey->saved_seq = seq;
+    }
+    pthread_mutex_unlock(&survey->file_lock);
+    return ret;
+}
+
+static int persist_vote(Vote* vote, Vote* snapshot, unsigned long seq) {
+    int ret = 0;
+    pthread_mutex_lock(&vote->file_lock);
+    if (seq > vote->saved_seq) {
+        long long start = stats_now_ns();
+        ret = save_vote_to_file(snapshot);
+        stats_record(STATS_PERSIST, stats_now_ns() - start);
+        if (ret == 0) vote->saved_seq = seq;
+    }
+    pthread_mutex_unlock(&vote->file_lock);
+    return ret;
+}
+
+// 임시 파일에 다 쓴 내용을 디스크에 내린 뒤 원래 이름으로 교체
+// rename()은 원자적이므로 저장 도중 서버가 죽어도 기존 파일이 잘린 채로 남지 않음
+static int commit_item_file(FILE* fp, const char* tmp_path, const char* path) {
+    int ok = fflush(fp) == 0 && fsync(fileno(fp)) == 0;
+    if (fclose(fp) != 0) ok = 0;
+    if (!ok || rename(tmp_path, path) != 0) {
+        perror("failed to save item file");
+        unlink(tmp_path);
+        return -1;
+    }
+    return 0;
+}
+
+int save_survey_to_file(Survey* survey) {
     // 설문 정보를 파일로 저장
-    char filename[256];
+    char filename[256], tmp_name[256];
     snprintf(filename, sizeof(filename), "data/survey/%s.txt", survey->id);
-    FILE* fp = fopen(filename, "w");
-    if (fp) {
-        fprintf(fp, "%s\n", survey->question);
-        fprintf(fp, "%d\n", survey->status);
-        for (int i = 0; i < survey->option_count; i++) {
-            fprintf(fp, "%s:%d\n", survey->options[i], survey->votes[i]);
-        }
-        fprintf(fp, "---VOTERS---\n");
-        for (int i = 0; i < survey->voter_count; i++) {
-            fprintf(fp, "%s\n", survey->voters[i]);
-        }
-        fclose(fp);
+    snprintf(tmp_name, sizeof(tmp_name), "data/survey/%s.tmp", survey->id);
+    FILE* fp = fopen(tmp_name, "w");
+    if (!fp) return -1;
+
+    fprintf(fp, "%s\n", survey->question);
+    fprintf(fp, "%d\n", survey->status);
+    for (int i = 0; i < survey->option_count; i++) {
+        fprintf(fp, "%s:%d\n", survey->options[i], survey->votes[i]);
+    }
+    fprintf(fp, "---VOTERS---\n");
+    VoterIter it;
+    voter_iter_init(&it, survey->voters);
+    for (int i = 0; i < survey->voter_count; i++) {
+        fprintf(fp, "%s\n", voter_iter_next(&it));
     }
+    return commit_item_file(fp, tmp_name, filename);
 }
 
-void save_vote_to_file(Vote* vote) {
+int save_vote_to_file(Vote* vote) {
     // 투표 정보를 파일로 저장
-    char filename[256];
+    char filename[256], tmp_name[256];
     snprintf(filename, sizeof(filename), "data/vote/%s.txt", vote->id);
-    FILE* fp = fopen(filename, "w");
-    if (fp) {
-        fprintf(fp, "%s\n", vote->title);
-        fprintf(fp, "%d\n", vote->status);
-        for (int i = 0; i < vote->option_count; i++) {
-            fprintf(fp, "%s:%d\n", vote->options[i], vote->votes[i]);
+    snprintf(tmp_name, sizeof(tmp_name), "data/vote/%s.tmp", vote->id);
+    FILE* fp = fopen(tmp_name, "w");
+    if (!fp) return -1;
+
+    fprintf(fp, "%s\n", vote->title);
+    fprintf(fp, "%d\n", vote->status);
+    for (int i = 0; i < vote->option_count; i++) {
+        fprintf(fp, "%s:%d\n", vote->options[i], vote->votes[i]);
+    }
+    fprintf(fp, "---VOTERS---\n");
+    VoterIter it;
+    voter_iter_init(&it, vote->voters);
+    for (int i = 0; i < vote->voter_count; i++) {
+        fprintf(fp, "%s\n", voter_iter_next(&it));
+    }
+    return commit_item_file(fp, tmp_name, filename);
+}
+
+// 디렉토리 엔트리(rename 결과)까지 디스크에 반영
+static void sync_dir(const char* path) {
+    int fd = open(path, O_RDONLY | O_DIRECTORY);
+    if (fd >= 0) {
+        fsync(fd);
+        close(fd);
+    }
+}
+
+// 마지막 저장 이후 바뀐 항목을 모두 파일로 저장 - 하나라도 실패하면 -1
+// 노드는 앞쪽에만 추가되고 next 는 바뀌지 않으므로, 시작 시점의 head 부터는 잠금 없이 순회 가능
+static int persist_dirty_items(void) {
+    int ret = 0;
+
+    pthread_rwlock_rdlock(&survey_list_lock);
+    Survey* survey = survey_head;
+    pthread_rwlock_unlock(&survey_list_lock);
+    for (; survey; survey = survey->next) {
+        BallotTarget t = survey_target(survey);
+        pthread_mutex_lock(&survey->lock);
+        if (fold_hot_item(&t) < 0) ret = -1;
+        Survey snapshot = *survey;
+        unsigned long seq = survey->change_seq;
+        pthread_mutex_unlock(&survey->lock);
+        if (persist_survey(survey, &snapshot, seq) < 0) ret = -1;
+    }
+
+    pthread_rwlock_rdlock(&vote_list_lock);
+    Vote* vote = vote_head;
+    pthread_rwlock_unlock(&vote_list_lock);
+    for (; vote; vote = vote->next) {
+        BallotTarget t = vote_target(vote);
+        pthread_mutex_lock(&vote->lock);
+        if (fold_hot_item(&t) < 0) ret = -1;
+        Vote snapshot = *vote;
+        unsigned long seq = vote->change_seq;
+        pthread_mutex_unlock(&vote->lock);
+        if (persist_vote(vote, &snapshot, seq) < 0) ret = -1;
+    }
+
+    sync_dir("data/survey");
+    sync_dir("data/vote");
+    return ret;
+}
+
+// 모든 항목을 바이너리 스냅샷으로 저장
+// 항목마다 잠금 안에서 고정 필드와 참여자 수만 떠 두고, 이름은 잠금 밖에서 그 수만큼 읽음
+static int write_snapshot(void) {
+    SnapshotWriter* w = snapshot_begin(SNAPSHOT_PATH);
+    SnapshotItem item;
+    int folded = 1;
+    if (!w) return -1;
+
+    pthread_rwlock_rdlock(&survey_list_lock);
+    Survey* survey = survey_head;
+    pthread_rwlock_unlock(&survey_list_lock);
+    for (; survey; survey = survey->next) {
+        memset(&item, 0, sizeof(item));
+        item.kind = 'S';
+        BallotTarget t = survey_target(survey);
+        pthread_mutex_lock(&survey->lock);
+        if (fold_hot_item(&t) < 0) folded = 0;
+        item.status = (uint8_t)survey->status;
+        item.option_count = (uint8_t)survey->option_count;
+        item.voter_count = survey->voter_count;
+        memcpy(item.id, survey->id, sizeof(item.id));
+        memcpy(item.title, survey->question, sizeof(item.title));
+        memcpy(item.options, survey->options, sizeof(item.options));
+        for (int i = 0; i < MAX_OPTIONS; i++) item.votes[i] = survey->votes[i];
+        pthread_mutex_unlock(&survey->lock);
+        if (snapshot_add(w, &item, survey->voters) < 0) break;
+    }
+
+    pthread_rwlock_rdlock(&vote_list_lock);
+    Vote* vote = vote_head;
+    pthread_rwlock_unlock(&vote_list_lock);
+    for (; vote; vote = vote->next) {
+        memset(&item, 0, sizeof(item));
+        item.kind = 'V';
+        BallotTarget t = vote_target(vote);
+        pthread_mutex_lock(&vote->lock);
+        if (fold_hot_item(&t) < 0) folded = 0;
+        item.status = (uint8_t)vote->status;
+        item.option_count = (uint8_t)vote->option_count;
+        item.voter_count = vote->voter_count;
+        memcpy(item.id, vote->id, sizeof(item.id));
+        memcpy(item.title, vote->title, sizeof(item.title));
+        memcpy(item.options, vote->options, sizeof(item.options));
+        for (int i = 0; i < MAX_OPTIONS; i++) item.votes[i] = vote->votes[i];
+        pthread_mutex_unlock(&vote->lock);
+        if (snapshot_add(w, &item, vote->voters) < 0) break;
+    }
+
+    // 샤드에 남은 응답은 로그에만 있으므로, 그것을 뺀 스냅샷으로 로그를 비우지 않음
+    if (!folded) {
+        snapshot_abort(w);
+        return -1;
+    }
+    if (snapshot_commit(w) < 0) return -1;
+    sync_dir("data");
+    return 0;
+}
+
+static pthread_mutex_t checkpoint_run_lock = PTHREAD_MUTEX_INITIALIZER;
+static int old_log_pending = 0; // 이전 체크포인트가 실패해 WAL_OLD_PATH 가 아직 필요함 (checkpoint_run_lock 으로 보호)
+
+// 체크포인트: 로그를 교체한 뒤 모든 항목을 스냅샷으로 저장하고, 이전 로그를 지움
+// 교체 전에 기록된 변경은 이미 메모리에 반영되어 있으므로 이후에 뜬 스냅샷에 모두 포함된다
+// 바뀐 항목은 텍스트 파일(data/survey, data/vote)로도 내보냄
+static int run_checkpoint(void) {
+    int ret = 0;
+
+    pthread_mutex_lock(&checkpoint_run_lock);
+    // 남아 있는 이전 로그를 덮어쓰지 않도록, 그것이 정리될 때까지는 교체하지 않음
+    if (!old_log_pending && wal_rotate() == 0) {
+        old_log_pending = 1;
+    }
+    if (persist_dirty_items() < 0) {
+        fprintf(stderr, ">> failed to export some item files\n");
+    }
+    if (write_snapshot() == 0) {
+        if (old_log_pending) {
+            wal_remove_old();
+            old_log_pending = 0;
+        }
+    } else {
+        // 이전 로그를 남겨 두면 다음 시작 시 다시 재생됨
+        fprintf(stderr, ">> checkpoint failed, keeping write-ahead log\n");
+        ret = -1;
+    }
+    pthread_mutex_unlock(&checkpoint_run_lock);
+    return ret;
+}
+
+static pthread_mutex_t checkpoint_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  checkpoint_cond = PTHREAD_COND_INITIALIZER;
+static int checkpoint_requested = 0;
+
+static void request_checkpoint(void) {
+    pthread_mutex_lock(&checkpoint_lock);
+    if (!checkpoint_requested) {
+        checkpoint_requested = 1;
+        pthread_cond_signal(&checkpoint_cond);
+    }
+    pthread_mutex_unlock(&checkpoint_lock);
+}
+
+// 로그가 WAL_CHECKPOINT_BYTES 를 넘거나 CHECKPOINT_INTERVAL_SEC 가 지날 때마다
+// (그 사이 변경이 있었으면) 체크포인트를 수행하는 스레드
+void* checkpoint_main(void* arg) {
+    (void)arg;
+    while (1) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += CHECKPOINT_INTERVAL_SEC;
+
+        pthread_mutex_lock(&checkpoint_lock);
+        while (!checkpoint_requested &&
+               pthread_cond_timedwait(&checkpoint_cond, &checkpoint_lock, &deadline) == 0) {
+        }
+        checkpoint_requested = 0;
+        pthread_mutex_unlock(&checkpoint_lock);
+
+        if (wal_size() > 0) {
+            run_checkpoint();
+        }
+    }
+    return NULL;
+}
+
+// wal_append 결과를 정책에 따라 커밋 - 로그에 남기지 못한 변경은 곧바로 체크포인트로 스냅샷에 반영
+// 반환값: 0 = 로그나 스냅샷에 남음, -1 = 둘 다 실패 (호출자는 [OK] 대신 send_not_saved 로 응답)
+static int commit_change(long size, const WalTicket* ticket) {
+    long long start = stats_now_ns();
+    int committed = size >= 0 && wal_commit(ticket) == 0;
+    stats_record(STATS_WAL_COMMIT, stats_now_ns() - start);
+    if (!committed) {
+        return run_checkpoint();
+    }
+    if (size >= WAL_CHECKPOINT_BYTES) {
+        request_checkpoint();
+    }
+    return 0;
+}
+
+// 변경은 메모리에 반영되었지만 디스크에 남기지 못함 - 다음 체크포인트가 성공하기 전에 서버가 멈추면 사라짐
+static void send_not_saved(Client* client) {
+    send_reply(client, "[ERROR] Failed to save the change.", strlen("[ERROR] Failed to save the change."));
+}
+
+// 시작 시 로그 재생 - 이미 반영된 변경은 (같은 ID의 항목 존재, 참여자 중복 확인으로) 걸러지므로
+// 같은 레코드를 여러 번 재생해도 결과가 같다. 응답은 기록 당시 진행 중이었으므로 상태는 보지 않음
+static void apply_wal_record(const WalRecord* rec) {
+    if (rec->field_count < 1) return;
+    const char* id = rec->fields[0];
+
+    if (rec->kind == 'S') {
+        Survey* cur = find_survey(id);
+        if (rec->op == WAL_CREATE && !cur && rec->field_count >= 2) {
+            Survey* node = new_survey_node();
+            strncpy(node->id, id, ID_LENGTH - 1);
+            strncpy(node->question, rec->fields[1], MAX_QUESTION_LEN - 1);
+            for (int i = 2; i < rec->field_count && node->option_count < MAX_OPTIONS; i++) {
+                strncpy(node->options[node->option_count++], rec->fields[i], MAX_OPTION_LEN - 1);
+            }
+            node->status = STATUS_ACTIVE;
+            node->change_seq = 1;
+            pthread_rwlock_wrlock(&survey_list_lock);
+            insert_survey_locked(node);
+            pthread_rwlock_unlock(&survey_list_lock);
+        } else if (rec->op == WAL_BALLOT && cur && rec->field_count >= 3) {
+            uint64_t voter_hash = str_hash64(rec->fields[1]);
+            if (voter_set_contains(cur->voters, rec->fields[1], voter_hash)) return;
+            if (!voter_set_add(cur->voters, rec->fields[1], voter_hash)) return;
+            cur->voter_count++;
+            for (size_t i = 0; i < rec->lens[2]; i++) {
+                unsigned char idx = (unsigned char)rec->fields[2][i];
+                if (idx < cur->option_count) cur->votes[idx]++;
+            }
+            cur->change_seq++;
+        } else if (rec->op == WAL_CLOSE && cur && cur->status != STATUS_CLOSED) {
+            cur->status = STATUS_CLOSED;
+            cur->change_seq++;
         }
-        fprintf(fp, "---VOTERS---\n");
-        for (int i = 0; i < vote->voter_count; i++) {
-            fprintf(fp, "%s\n", vote->voters[i]);
+    } else if (rec->kind == 'V') {
+        Vote* cur = find_vote(id);
+        if (rec->op == WAL_CREATE && !cur && rec->field_count >= 2) {
+            Vote* node = new_vote_node();
+            strncpy(node->id, id, ID_LENGTH - 1);
+            strncpy(node->title, rec->fields[1], MAX_QUESTION_LEN - 1);
+            for (int i = 2; i < rec->field_count && node->option_count < MAX_OPTIONS; i++) {
+                strncpy(node->options[node->option_count++], rec->fields[i], MAX_OPTION_LEN - 1);
+            }
+            node->status = STATUS_ACTIVE;
+            node->change_seq = 1;
+            pthread_rwlock_wrlock(&vote_list_lock);
+            insert_vote_locked(node);
+            pthread_rwlock_unlock(&vote_list_lock);
+        } else if (rec->op == WAL_BALLOT && cur && rec->field_count >= 3) {
+            uint64_t voter_hash = str_hash64(rec->fields[1]);
+            if (voter_set_contains(cur->voters, rec->fields[1], voter_hash)) return;
+            if (!voter_set_add(cur->voters, rec->fields[1], voter_hash)) return;
+            cur->voter_count++;
+            for (size_t i = 0; i < rec->lens[2]; i++) {
+                unsigned char idx = (unsigned char)rec->fields[2][i];
+                if (idx < cur->option_count) cur->votes[idx]++;
+            }
+            cur->change_seq++;
+        } else if (rec->op == WAL_CLOSE && cur && cur->status != STATUS_CLOSED) {
+            cur->status = STATUS_CLOSED;
+            cur->change_seq++;
         }
-        fclose(fp);
     }
 }
 
-void load_surveys() {
-    // 저장된 설문 파일들을 읽어서 메모리로 복구
-    DIR* d = opendir("data/survey");
+// 스냅샷의 참여자 명단을 노드에 붙임 - 실패하면(메모리 부족) 득표 수만 있고 명단이 빈 항목이 되어
+// 같은 사람이 다시 응답할 수 있게 되므로, 그대로 띄우지 않고 서버 시작을 멈춤 (노드 할당 실패와 같음)
+static void adopt_snapshot_voters(const SnapshotItem* item, const uint64_t* hashes, const char* names,
+                                  VoterSet* voters, int* voter_count) {
+    if (item->voter_count == 0) return;
+    if (!voters || voter_set_adopt(voters, names, item->names_bytes, hashes, item->voter_count) != 0) {
+        fprintf(stderr, ">> Failed to load %llu participants of %.*s from snapshot (out of memory)\n",
+                (unsigned long long)item->voter_count, ID_LENGTH, item->id);
+        exit(EXIT_FAILURE);
+    }
+    *voter_count = (int)item->voter_count;
+}
+
+// 스냅샷의 항목 레코드 하나를 노드로 복원 - 참여자 명단은 mmap 된 파일을 그대로 가리킴
+static void load_snapshot_item(const SnapshotItem* item, const uint64_t* hashes, const char* names) {
+    if (item->kind == 'S') {
+        Survey* node = new_survey_node();
+        memcpy(node->id, item->id, ID_LENGTH);
+        memcpy(node->question, item->title, MAX_QUESTION_LEN);
+        memcpy(node->options, item->options, sizeof(item->options));
+        for (int i = 0; i < MAX_OPTIONS; i++) node->votes[i] = item->votes[i];
+        node->id[ID_LENGTH - 1] = '\0';
+        node->question[MAX_QUESTION_LEN - 1] = '\0';
+        node->option_count = item->option_count;
+        node->status = (ItemStatus)item->status;
+        adopt_snapshot_voters(item, hashes, names, node->voters, &node->voter_count);
+        insert_survey_locked(node);
+    } else if (item->kind == 'V') {
+        Vote* node = new_vote_node();
+        memcpy(node->id, item->id, ID_LENGTH);
+        memcpy(node->title, item->title, MAX_QUESTION_LEN);
+        memcpy(node->options, item->options, sizeof(item->options));
+        for (int i = 0; i < MAX_OPTIONS; i++) node->votes[i] = item->votes[i];
+        node->id[ID_LENGTH - 1] = '\0';
+        node->title[MAX_QUESTION_LEN - 1] = '\0';
+        node->option_count = item->option_count;
+        node->status = (ItemStatus)item->status;
+        adopt_snapshot_voters(item, hashes, names, node->voters, &node->voter_count);
+        insert_vote_locked(node);
+    }
+}
+
+static double elapsed_ms(const struct timespec* since) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - since->tv_sec) * 1000.0 + (now.tv_nsec - since->tv_nsec) / 1e6;
+}
+
+// 디렉토리의 "<ID>.txt" 중 메모리에 항목이 없는 파일 이름을 ID 기록에 넣음
+static void register_orphan_files(const char* dir, IdRegistry* reg, IdInUseFn in_use) {
+    DIR* d = opendir(dir);
     if (!d) return;
+
     struct dirent* e;
     while ((e = readdir(d)) != NULL) {
-        if (e->d_type == DT_REG && strstr(e->d_name, ".txt")) {
-            char path[256];
-            snprintf(path, sizeof(path), "data/survey/%s", e->d_name);
-            FILE* f = fopen(path, "r");
-            if (!f) continue;
-
-            Survey* node = malloc(sizeof(Survey));
-            memset(node, 0, sizeof(Survey));
-
-            strncpy(node->id, e->d_name, strlen(e->d_name) - 4);
-            node->id[strlen(e->d_name) - 4] = '\0';
-            
-            fgets(node->question, sizeof(node->question), f);
-            node->question[strcspn(node->question, "\n")] = '\0';
-            
-            char status_line[16];
-            if (fgets(status_line, sizeof(status_line), f)) {
-                node->status = (ItemStatus)atoi(status_line);
-            } else {
-                node->status = STATUS_ACTIVE;
-            }
-            
-            char line[BUFFER_SIZE];
-            int idx = 0;
-            int parsing_options = 1;
-
-            while (fgets(line, sizeof(line), f)) {
-                line[strcspn(line, "\n")] = 0;
-                if (strlen(line) == 0) continue;
-
-                if (strcmp(line, "---VOTERS---") == 0) {
-                    parsing_options = 0;
-                    continue;
-                }
+        size_t len = strlen(e->d_name);
+        if (e->d_type != DT_REG || len <= 4 || len - 4 >= ID_LENGTH || strcmp(e->d_name + len - 4, ".txt") != 0) {
+            continue;
+        }
+        char id[ID_LENGTH];
+        snprintf(id, sizeof(id), "%.*s", (int)(len - 4), e->d_name);
+        if (!in_use(id)) id_registry_add_file(reg, id);
+    }
+    closedir(d);
+}
+
+// 복구가 끝난 뒤 ID 기록을 채움 - 이미 있는 "기본 ID-번호" 의 다음 번호부터 쓰고, 남아 있는 파일은 피함
+// 이후 ID 를 정할 때는 파일 시스템을 보지 않으므로, 서버가 도는 중에 데이터 디렉토리에 직접 넣은 파일은 고려하지 않음
+static void build_id_registries(void) {
+    id_registry_init(&survey_ids);
+    id_registry_init(&vote_ids);
+    for (Survey* cur = survey_head; cur; cur = cur->next) {
+        id_registry_note_id(&survey_ids, cur->id);
+    }
+    for (Vote* cur = vote_head; cur; cur = cur->next) {
+        id_registry_note_id(&vote_ids, cur->id);
+    }
+    register_orphan_files("data/survey", &survey_ids, survey_id_in_use);
+    register_orphan_files("data/vote", &vote_ids, vote_id_in_use);
+}
 
-                if (parsing_options) {
-                    if (idx < MAX_OPTIONS) {
-                        char* vote_str = strrchr(line, ':');
-                        if (vote_str) {
-                            *vote_str = '\0';
-                            node->votes[idx] = atoi(vote_str + 1);
-                        } else {
-                            node->votes[idx] = 0;
-                        }
-                        strncpy(node->options[idx], line, MAX_OPTION_LEN);
-                        idx++;
-                    }
+// 빈 항목 목록의 인덱스와 LIST 응답 캐시 준비 - recover_data() 가 처음에 호출
+void item_store_init(void) {
+    item_index_init(&survey_index, offsetof(Survey, id));
+    item_index_init(&vote_index, offsetof(Vote, id));
+    survey_list_reply = reply_slot_create();
+    vote_list_reply = reply_slot_create();
+}
+
+// 서버 시작 시 데이터 복구: 스냅샷(없거나 import_text 이면 항목별 텍스트 파일)을 읽고 로그를 재생한 뒤,
+// 그 결과를 새 스냅샷으로 저장하고 로그를 비움
+int recover_data(int import_text) {
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    item_store_init();
+    long items = import_text ? -1 : snapshot_load(SNAPSHOT_PATH, load_snapshot_item);
+    if (items >= 0) {
+        double ms = elapsed_ms(&start);
+        printf(">> Loaded %ld items from %s in %.1f ms (%.0f items/s)\n",
+               items, SNAPSHOT_PATH, ms, ms > 0 ? items * 1000.0 / ms : 0.0);
+    } else {
+        load_text_files();
+        size_t imported = survey_index.count + vote_index.count;
+        double ms = elapsed_ms(&start);
+        printf(">> Imported %zu surveys and %zu votes from text files in %.1f ms (%.0f items/s)\n",
+               survey_index.count, vote_index.count, ms, ms > 0 ? imported * 1000.0 / ms : 0.0);
+    }
+
+    long replayed = wal_replay(WAL_OLD_PATH, apply_wal_record);
+    replayed += wal_replay(WAL_PATH, apply_wal_record);
+    if (replayed > 0) {
+        printf(">> Replayed %ld records from write-ahead log\n", replayed);
+    }
+    build_id_registries();
+
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    unsigned long boot_version = (unsigned long)ts.tv_sec * 1000000UL + (unsigned long)ts.tv_nsec / 1000;
+    atomic_store(&survey_list_version, boot_version);
+    atomic_store(&vote_list_version, boot_version);
+
+    if (replayed > 0 || items < 0) {
+        persist_dirty_items();
+        if (write_snapshot() < 0) {
+            // 재생 결과를 저장하지 못했으면 로그를 지우지 않고 이어서 기록
+            old_log_pending = access(WAL_OLD_PATH, F_OK) == 0;
+            return wal_open(0);
+        }
+    }
+    wal_remove_old();
+    return wal_open(1);
+}
+
+// 설문 파일 하나를 읽어 노드로 만듦 (name 은 "<ID>.txt")
+static Survey* parse_survey_file(const char* path, const char* name) {
+    FILE* f = fopen(path, "r");
+    if (!f) return NULL;
+
+    Survey* node = new_survey_node();
+
+    strncpy(node->id, name, strlen(name) - 4);
+    node->id[strlen(name) - 4] = '\0';
+
+    fgets(node->question, MAX_QUESTION_LEN, f);
+    node->question[strcspn(node->question, "\n")] = '\0';
+
+    char status_line[16];
+    if (fgets(status_line, sizeof(status_line), f)) {
+        node->status = (ItemStatus)atoi(status_line);
+    } else {
+        node->status = STATUS_ACTIVE;
+    }
+
+    char line[BUFFER_SIZE];
+    int idx = 0;
+    int parsing_options = 1;
+
+    while (fgets(line, sizeof(line), f)) {
+        line[strcspn(line, "\n")] = 0;
+        if (strlen(line) == 0) continue;
+
+        if (strcmp(line, "---VOTERS---") == 0) {
+            parsing_options = 0;
+            continue;
+        }
+
+        if (parsing_options) {
+            if (idx < MAX_OPTIONS) {
+                char* vote_str = strrchr(line, ':');
+                if (vote_str) {
+                    *vote_str = '\0';
+                    node->votes[idx] = atoi(vote_str + 1);
                 } else {
-                    if (node->voter_count < MAX_VOTERS) {
-                        strncpy(node->voters[node->voter_count], line, MAX_USERNAME_LEN);
-                        node->voter_count++;
-                    }
+                    node->votes[idx] = 0;
                 }
+                strncpy(node->options[idx], line, MAX_OPTION_LEN);
+                idx++;
+            }
+        } else {
+            if (strlen(line) >= MAX_USERNAME_LEN) {
+                line[MAX_USERNAME_LEN - 1] = '\0';
+            }
+            if (voter_set_add(node->voters, line, str_hash64(line))) {
+                node->voter_count++;
             }
-            node->option_count = idx;
-            
-            fclose(f);
-            node->next = survey_head;
-            survey_head = node;
         }
     }
-    closedir(d);
+    node->option_count = idx;
+
+    fclose(f);
+    return node;
 }
 
-void load_votes() {
-    // 저장된 투표 파일들을 읽어서 메모리로 복구
-    DIR* d = opendir("data/vote");
-    if (!d) return;
-    struct dirent* e;
-    while ((e = readdir(d)) != NULL) {
-        if (e->d_type == DT_REG && strstr(e->d_name, ".txt")) {
-            char path[256];
-            snprintf(path, sizeof(path), "data/vote/%s", e->d_name);
-            FILE* f = fopen(path, "r");
-            if (!f) continue;
-            
-            Vote* node = malloc(sizeof(Vote));
-            memset(node, 0, sizeof(Vote));
-
-            strncpy(node->id, e->d_name, strlen(e->d_name) - 4);
-            node->id[strlen(e->d_name) - 4] = '\0';
-            
-            fgets(node->title, sizeof(node->title), f);
-            node->title[strcspn(node->title, "\n")] = '\0';
-            
-            char status_line[16];
-            if (fgets(status_line, sizeof(status_line), f)) {
-                node->status = (ItemStatus)atoi(status_line);
-            } else {
-                node->status = STATUS_ACTIVE;
-            }
-            
-            char line[BUFFER_SIZE];
-            int idx = 0;
-            int parsing_options = 1;
-
-            while (fgets(line, sizeof(line), f)) {
-                line[strcspn(line, "\n")] = 0;
-                if (strlen(line) == 0) continue;
-
-                if (strcmp(line, "---VOTERS---") == 0) {
-                    parsing_options = 0;
-                    continue;
-                }
+// 투표 파일 하나를 읽어 노드로 만듦 (name 은 "<ID>.txt")
+static Vote* parse_vote_file(const char* path, const char* name) {
+    FILE* f = fopen(path, "r");
+    if (!f) return NULL;
 
-                if (parsing_options) {
-                    if (idx < MAX_OPTIONS) {
-                        char* vote_str = strrchr(line, ':');
-                        if (vote_str) {
-                            *vote_str = '\0';
-                            node->votes[idx] = atoi(vote_str + 1);
-                        } else {
-                            node->votes[idx] = 0;
-                        }
-                        strncpy(node->options[idx], line, MAX_OPTION_LEN);
-                        idx++;
-                    }
+    Vote* node = new_vote_node();
+
+    strncpy(node->id, name, strlen(name) - 4);
+    node->id[strlen(name) - 4] = '\0';
+
+    fgets(node->title, MAX_QUESTION_LEN, f);
+    node->title[strcspn(node->title, "\n")] = '\0';
+
+    char status_line[16];
+    if (fgets(status_line, sizeof(status_line), f)) {
+        node->status = (ItemStatus)atoi(status_line);
+    } else {
+        node->status = STATUS_ACTIVE;
+    }
+
+    char line[BUFFER_SIZE];
+    int idx = 0;
+    int parsing_options = 1;
+
+    while (fgets(line, sizeof(line), f)) {
+        line[strcspn(line, "\n")] = 0;
+        if (strlen(line) == 0) continue;
+
+        if (strcmp(line, "---VOTERS---") == 0) {
+            parsing_options = 0;
+            continue;
+        }
+
+        if (parsing_options) {
+            if (idx < MAX_OPTIONS) {
+                char* vote_str = strrchr(line, ':');
+                if (vote_str) {
+                    *vote_str = '\0';
+                    node->votes[idx] = atoi(vote_str + 1);
                 } else {
-                     if (node->voter_count < MAX_VOTERS) {
-                        strncpy(node->voters[node->voter_count], line, MAX_USERNAME_LEN);
-                        node->voter_count++;
-                    }
+                    node->votes[idx] = 0;
                 }
+                strncpy(node->options[idx], line, MAX_OPTION_LEN);
+                idx++;
+            }
+        } else {
+            if (strlen(line) >= MAX_USERNAME_LEN) {
+                line[MAX_USERNAME_LEN - 1] = '\0';
             }
-            node->option_count = idx;
-            
-            fclose(f);
-            node->next = vote_head;
-            vote_head = node;
+            if (voter_set_add(node->voters, line, str_hash64(line))) {
+                node->voter_count++;
+            }
+        }
+    }
+    node->option_count = idx;
+
+    fclose(f);
+    return node;
+}
+
+// 한 디렉토리의 텍스트 파일을 여러 스레드가 나눠 읽기 위한 작업 정보
+typedef struct DirLoad {
+    const char* dir;
+    char**  names;        // 디렉토리의 "*.txt" 파일 이름 (readdir 순서)
+    void**  nodes;        // nodes[i] = names[i] 를 파싱한 노드 - 칸마다 그 파일을 맡은 스레드만 씀
+    size_t  count;
+    atomic_size_t next;   // 다음에 읽을 파일 번호 - 스레드마다 하나씩 가져감
+    int     is_survey;
+} DirLoad;
+
+static void* parse_files_main(void* arg) {
+    DirLoad* load = arg;
+    char path[512];
+
+    for (;;) {
+        size_t i = atomic_fetch_add_explicit(&load->next, 1, memory_order_relaxed);
+        if (i >= load->count) break;
+        snprintf(path, sizeof(path), "%s/%s", load->dir, load->names[i]);
+        if (load->is_survey) {
+            load->nodes[i] = parse_survey_file(path, load->names[i]);
+        } else {
+            load->nodes[i] = parse_vote_file(path, load->names[i]);
         }
     }
+    return NULL;
+}
+
+// 디렉토리를 훑어 파일 이름을 모은 뒤, 코어 수만큼의 스레드가 나눠 파싱하고 마지막에 한 번에 목록/인덱스에 합침
+// 합칠 때는 파일 순서대로 넣으므로 목록 순서는 한 스레드로 읽을 때와 같음
+// 설문/투표 디렉토리는 각각 다른 스레드에서 동시에 이 함수를 실행함
+static void* load_dir_main(void* arg) {
+    DirLoad* load = arg;
+    size_t cap = 0;
+    DIR* d = opendir(load->dir);
+    if (!d) return NULL;
+
+    struct dirent* e;
+    while ((e = readdir(d)) != NULL) {
+        if (e->d_type != DT_REG || !strstr(e->d_name, ".txt")) continue;
+        if (load->count == cap) {
+            cap = cap ? cap * 2 : 256;
+            char** names = realloc(load->names, cap * sizeof(char*));
+            if (!names) break;
+            load->names = names;
+        }
+        load->names[load->count++] = strdup(e->d_name);
+    }
     closedir(d);
+
+    load->nodes = calloc(load->count ? load->count : 1, sizeof(void*));
+    if (!load->nodes) load->count = 0;
+
+    int cores = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int threads = cores < 1 ? 1 : cores > MAX_LOAD_THREADS ? MAX_LOAD_THREADS : cores;
+    // 파일이 적으면 스레드를 만드는 비용이 더 큼
+    if (load->count < (size_t)threads * LOAD_FILES_PER_THREAD) {
+        threads = 1;
+    }
+
+    pthread_t tids[MAX_LOAD_THREADS];
+    int started = 0;
+    for (int i = 1; i < threads; i++) {
+        if (pthread_create(&tids[i], NULL, parse_files_main, load) != 0) break;
+        started = i;
+    }
+    parse_files_main(load);
+    for (int i = 1; i <= started; i++) {
+        pthread_join(tids[i], NULL);
+    }
+
+    // 이 디렉토리의 목록/인덱스는 이 스레드만 건드리므로 잠금 없이 합침
+    for (size_t i = 0; i < load->count; i++) {
+        if (!load->nodes[i]) continue;
+        if (load->is_survey) insert_survey_locked(load->nodes[i]);
+        else insert_vote_locked(load->nodes[i]);
+    }
+
+    for (size_t i = 0; i < load->count; i++) {
+        free(load->names[i]);
+    }
+    free(load->names);
+    free(load->nodes);
+    return NULL;
+}
+
+// 저장된 설문/투표 텍스트 파일들을 읽어서 메모리로 복구 (서버 시작 시, 다른 스레드가 항목에 접근하기 전에 호출)
+void load_text_files(void) {
+    DirLoad surveys = { "data/survey", NULL, NULL, 0, 0, 1 };
+    DirLoad votes   = { "data/vote",   NULL, NULL, 0, 0, 0 };
+    pthread_t tid;
+
+    // 투표 디렉토리는 새 스레드에서, 설문 디렉토리는 현재 스레드에서 동시에 읽음
+    if (pthread_create(&tid, NULL, load_dir_main, &votes) != 0) {
+        load_dir_main(&surveys);
+        load_dir_main(&votes);
+        return;
+    }
+    load_dir_main(&surveys);
+    pthread_join(tid, NULL);
 }
 
 // - create_survey_handler: 설문 생성 요청 처리
-void create_survey_handler(int sockfd, char* msg)
+void create_survey_handler(Client* client, const Request* req)
 {
     char resp[BUFFER_SIZE];
-    char* saveptr;
-    
-    pthread_mutex_lock(&data_lock);
-
-    strtok_r(msg, "|", &saveptr);
-    char* question = strtok_r(NULL, "|", &saveptr);
-    char* opts_csv = strtok_r(NULL, "|", &saveptr);
 
-    if (question == NULL || opts_csv == NULL) {
-        pthread_mutex_unlock(&data_lock);
+    if (req->argc < 2) {
         snprintf(resp, sizeof(resp), "[ERROR] Invalid format for CREATE_SURVEY");
-        send(sockfd, resp, strlen(resp), 0);
+        send_reply(client, resp, strlen(resp));
         return;
     }
 
-    char base_id[ID_LENGTH];
-    char final_id[ID_LENGTH];
-    slugify(question, base_id, sizeof(base_id));
-    
-    if (strlen(base_id) == 0) {
-        strncpy(base_id, "survey", sizeof(base_id));
-    }
-
-    strncpy(final_id, base_id, sizeof(final_id));
-    int suffix = 2;
-    while (id_exists(final_id, "survey")) {
-        snprintf(final_id, sizeof(final_id), "%s-%d", base_id, suffix++);
-    }
-
-    Survey* node = malloc(sizeof(Survey));
-    memset(node, 0, sizeof(Survey));
-    strncpy(node->id, final_id, ID_LENGTH);
-    strncpy(node->question, question, MAX_QUESTION_LEN);
+    Survey* node = new_survey_node();
+    strview_copy(node->question, MAX_QUESTION_LEN, req->args[0]);
     node->status = STATUS_ACTIVE;
     node->voter_count = 0;
-    
+
     int i = 0;
-    char* saveptr_opts;
-    char* opt = strtok_r(opts_csv, ",", &saveptr_opts);
-    while(opt && i < MAX_OPTIONS) {
-        strncpy(node->options[i], opt, MAX_OPTION_LEN);
+    StrView opts_csv = req->args[1];
+    StrView opt;
+    while (i < MAX_OPTIONS && strview_next(&opts_csv, ',', &opt)) {
+        strview_copy(node->options[i], MAX_OPTION_LEN, opt);
         node->votes[i] = 0;
         i++;
-        opt = strtok_r(NULL, ",", &saveptr_opts);
     }
     node->option_count = i;
-    
-    save_survey_to_file(node);
 
-    node->next = survey_head;
-    survey_head = node;
+    char base_id[ID_LENGTH];
+    char final_id[ID_LENGTH];
+    slugify(node->question, base_id, sizeof(base_id));
+
+    if (strlen(base_id) == 0) {
+        strncpy(base_id, "survey", sizeof(base_id));
+    }
+
+    // ID 결정과 리스트 삽입은 목록 쓰기 잠금 안에서 한 번에 처리
+    // (메모리의 항목은 인덱스로, 메모리에 없는 파일은 시작 시 모아 둔 ID 기록으로 확인 - 파일 시스템에 묻지 않음)
+    pthread_rwlock_wrlock(&survey_list_lock);
+    id_registry_assign(&survey_ids, base_id, survey_id_in_use, final_id, sizeof(final_id));
+    strncpy(node->id, final_id, ID_LENGTH);
+
+    // 생성 기록은 목록에 넣기 전에 남겨, 이 항목에 대한 응답 기록보다 항상 앞에 오게 함
+    WalRecord rec;
+    WalTicket ticket;
+    wal_record_init(&rec, WAL_CREATE, 'S');
+    wal_add_field(&rec, node->id, strlen(node->id));
+    wal_add_field(&rec, node->question, strlen(node->question));
+    for (int k = 0; k < node->option_count; k++) {
+        wal_add_field(&rec, node->options[k], strlen(node->options[k]));
+    }
+    long wal_bytes = wal_append(&rec, &ticket);
+    node->change_seq = 1;
+    insert_survey_locked(node);
+    pthread_rwlock_unlock(&survey_list_lock);
 
-    pthread_mutex_unlock(&data_lock);
+    if (commit_change(wal_bytes, &ticket) < 0) {
+        send_not_saved(client);
+        return;
+    }
 
     snprintf(resp, sizeof(resp), "[OK] Survey created with ID: %s", final_id);
-    send(sockfd, resp, strlen(resp), 0);
+    send_reply(client, resp, strlen(resp));
 }
 
 // - create_vote_handler: 투표 생성 요청 처리
-void create_vote_handler(int sockfd, char* msg) {
+void create_vote_handler(Client* client, const Request* req) {
     char resp[BUFFER_SIZE];
-    char* saveptr;
-    
-    pthread_mutex_lock(&data_lock);
-    
-    strtok_r(msg, "|", &saveptr);
-    char* title = strtok_r(NULL, "|", &saveptr);
-    char* opts_csv = strtok_r(NULL, "|", &saveptr);
-
-    if (title == NULL || opts_csv == NULL) {
-        pthread_mutex_unlock(&data_lock);
+
+    if (req->argc < 2) {
         snprintf(resp, sizeof(resp), "[ERROR] Invalid format for CREATE_VOTE");
-        send(sockfd, resp, strlen(resp), 0);
+        send_reply(client, resp, strlen(resp));
         return;
     }
 
-    char base_id[ID_LENGTH];
-    char final_id[ID_LENGTH];
-    slugify(title, base_id, sizeof(base_id));
-    
-    if (strlen(base_id) == 0) {
-        strncpy(base_id, "vote", sizeof(base_id));
-    }
-    
-    strncpy(final_id, base_id, sizeof(final_id));
-    int suffix = 2;
-    while (id_exists(final_id, "vote")) {
-        snprintf(final_id, sizeof(final_id), "%s-%d", base_id, suffix++);
-    }
-    
-    Vote* node = malloc(sizeof(Vote));
-    memset(node, 0, sizeof(Vote));
-    strncpy(node->id, final_id, ID_LENGTH);
-    strncpy(node->title, title, MAX_QUESTION_LEN);
+    Vote* node = new_vote_node();
+    strview_copy(node->title, MAX_QUESTION_LEN, req->args[0]);
     node->status = STATUS_ACTIVE;
     node->voter_count = 0;
 
     int i = 0;
-    char* saveptr_opts;
-    char* opt = strtok_r(opts_csv, ",", &saveptr_opts);
-    while(opt && i < MAX_OPTIONS) {
-        strncpy(node->options[i], opt, MAX_OPTION_LEN);
+    StrView opts_csv = req->args[1];
+    StrView opt;
+    while (i < MAX_OPTIONS && strview_next(&opts_csv, ',', &opt)) {
+        strview_copy(node->options[i], MAX_OPTION_LEN, opt);
         node->votes[i] = 0;
         i++;
-        opt = strtok_r(NULL, ",", &saveptr_opts);
     }
     node->option_count = i;
 
-    save_vote_to_file(node);
+    char base_id[ID_LENGTH];
+    char final_id[ID_LENGTH];
+    slugify(node->title, base_id, sizeof(base_id));
 
-    node->next = vote_head;
-    vote_head = node;
+    if (strlen(base_id) == 0) {
+        strncpy(base_id, "vote", sizeof(base_id));
+    }
+
+    pthread_rwlock_wrlock(&vote_list_lock);
+    id_registry_assign(&vote_ids, base_id, vote_id_in_use, final_id, sizeof(final_id));
+    strncpy(node->id, final_id, ID_LENGTH);
 
-    pthread_mutex_unlock(&data_lock);
+    WalRecord rec;
+    WalTicket ticket;
+    wal_record_init(&rec, WAL_CREATE, 'V');
+    wal_add_field(&rec, node->id, strlen(node->id));
+    wal_add_field(&rec, node->title, strlen(node->title));
+    for (int k = 0; k < node->option_count; k++) {
+        wal_add_field(&rec, node->options[k], strlen(node->options[k]));
+    }
+    long wal_bytes = wal_append(&rec, &ticket);
+    node->change_seq = 1;
+    insert_vote_locked(node);
+    pthread_rwlock_unlock(&vote_list_lock);
+
+    if (commit_change(wal_bytes, &ticket) < 0) {
+        send_not_saved(client);
+        return;
+    }
 
     snprintf(resp, sizeof(resp), "[OK] Vote created with ID: %s", final_id);
-    send(sockfd, resp, strlen(resp), 0);
+    send_reply(client, resp, strlen(resp));
 }
 
-// - respond_survey_handler: 설문 응답 요청 처리
-void respond_survey_handler(int sockfd, char* msg) 
-{
-    char* saveptr;
-    pthread_mutex_lock(&data_lock);
+typedef enum {
+    BALLOT_OK,
+    BALLOT_CLOSED,
+    BALLOT_DUPLICATE,
+    BALLOT_NO_MEMORY
+} BallotResult;
+
+// 보기 목록에서 반영할 보기 번호(0부터)를 chosen 에 모음 - 반영한 보기만 로그에 남기므로 cap 을 넘는 보기는 버림
+// 설문(multi)은 쉼표로 나열한 보기 모두, 투표는 필드 전체를 보기 번호 하나로 읽음
+static size_t collect_choices(StrView opts, int option_count, int multi, unsigned char* chosen, size_t cap) {
+    size_t count = 0;
+    if (!multi) {
+        int idx = strview_to_int(opts) - 1;
+        if (idx >= 0 && idx < option_count && cap > 0) chosen[count++] = (unsigned char)idx;
+        return count;
+    }
+    StrView token;
+    while (count < cap && strview_next(&opts, ',', &token)) {
+        int idx = strview_to_int(token) - 1;
+        if (idx >= 0 && idx < option_count) chosen[count++] = (unsigned char)idx;
+    }
+    return count;
+}
 
-    strtok_r(msg, "|", &saveptr);
-    char* id = strtok_r(NULL, "|", &saveptr);
-    char* opts_csv = strtok_r(NULL, "|", &saveptr);
-    char* username = strtok_r(NULL, "|", &saveptr);
+// 항목 lock 을 잡은 상태에서 응답 한 건 반영
+static BallotResult apply_ballot_locked(const BallotTarget* t, const char* username, uint64_t voter_hash,
+                                        const unsigned char* chosen, size_t chosen_count) {
+    if (*t->status == STATUS_CLOSED) return BALLOT_CLOSED;
+    if (voter_set_contains(t->voters, username, voter_hash)) return BALLOT_DUPLICATE;
+    if (!voter_set_add(t->voters, username, voter_hash)) return BALLOT_NO_MEMORY;
+
+    seqlock_write_begin(t->tally_seq);
+    (*t->voter_count)++;
+    for (size_t i = 0; i < chosen_count; i++) t->votes[chosen[i]]++;
+    seqlock_write_end(t->tally_seq);
+    (*t->change_seq)++;
+    return BALLOT_OK;
+}
 
-    if (id == NULL || opts_csv == NULL || username == NULL) {
-        pthread_mutex_unlock(&data_lock);
-        send(sockfd, "[ERROR] Invalid format for RESPOND_SURVEY", strlen("[ERROR] Invalid format for RESPOND_SURVEY"), 0);
+// 샤드로 전환된 항목에 응답 한 건 반영 - 항목 lock 없이 이름으로 고른 샤드 잠금만 잡음
+// 본체 명단은 모든 샤드를 잡은 합치기에서만 바뀌므로 샤드 잠금 안에서 읽어도 안전
+// change_seq 는 합치기가 올리므로 여기서는 건드리지 않음
+static BallotResult apply_ballot_hot(const BallotTarget* t, HotItem* hot, const char* username, uint64_t voter_hash,
+                                     const unsigned char* chosen, size_t chosen_count) {
+    HotShard* shard = hot_item_shard(hot, voter_hash);
+    BallotResult result = BALLOT_OK;
+
+    pthread_mutex_lock(&shard->lock);
+    if (*t->status == STATUS_CLOSED) {
+        result = BALLOT_CLOSED;
+    } else if (voter_set_contains(t->voters, username, voter_hash) ||
+               voter_set_contains(shard->voters, username, voter_hash)) {
+        result = BALLOT_DUPLICATE;
+    } else if (!voter_set_add(shard->voters, username, voter_hash)) {
+        result = BALLOT_NO_MEMORY;
+    } else {
+        seqlock_write_begin(&shard->tally_seq);
+        shard->voter_count++;
+        for (size_t i = 0; i < chosen_count; i++) shard->votes[chosen[i]]++;
+        seqlock_write_end(&shard->tally_seq);
+    }
+    pthread_mutex_unlock(&shard->lock);
+    return result;
+}
+
+// 지금 구간에서 항목 lock 경합이 잦아진 항목을 샤드 방식으로 전환 - 항목 lock 을 잡은 상태에서 호출
+static void maybe_promote_hot_item(const BallotTarget* t) {
+    if (atomic_load_explicit(t->contention, memory_order_relaxed) < HOT_ITEM_CONTENTION) return;
+    if (*t->status == STATUS_CLOSED || atomic_load_explicit(t->hot, memory_order_relaxed)) return;
+
+    HotItem* hot = hot_item_create();
+    if (!hot) {
+        // 다음 전환 시도는 경합이 다시 쌓인 뒤에
+        atomic_store_explicit(t->contention, 0, memory_order_relaxed);
         return;
     }
-    
-    Survey* cur = survey_head;
-    while (cur && strcmp(cur->id, id) != 0) {
-        cur = cur->next;
+    atomic_store_explicit(t->hot, hot, memory_order_release);
+    printf(">> Item %s switched to hot mode (%zu shards)\n", t->id, hot->shard_count);
+}
+
+// 응답/종료 처리에서 항목 lock 을 잡고 잡은 시각을 반환 - 대기/보유 시간을 계측
+// 바로 잡으면 대기 0 으로 세고, 못 잡았을 때만 시각을 한 번 더 읽음. contention 이 있으면 못 잡은 횟수도 올림
+// 못 잡은 횟수는 구간(HOT_ITEM_WINDOW_SHIFT)마다 새로 세므로, 예전에 몰렸던 항목이 지금 한가해도 전환되지 않음
+// 구간 번호와 횟수는 따로 바뀌므로 구간이 바뀌는 순간의 경합 몇 번은 어느 쪽에 세어질지 모름 (근사치로 충분)
+static long long lock_item(pthread_mutex_t* lock, atomic_uint* contention, atomic_uint* window) {
+    if (pthread_mutex_trylock(lock) == 0) {
+        stats_record(STATS_LOCK_WAIT, 0);
+        return stats_now_ns();
+    }
+    long long start = stats_now_ns();
+    if (contention) {
+        unsigned now_window = (unsigned)((unsigned long long)start >> HOT_ITEM_WINDOW_SHIFT);
+        if (atomic_load_explicit(window, memory_order_relaxed) != now_window) {
+            atomic_store_explicit(window, now_window, memory_order_relaxed);
+            atomic_store_explicit(contention, 1, memory_order_relaxed);
+        } else {
+            atomic_fetch_add_explicit(contention, 1, memory_order_relaxed);
+        }
+    }
+    pthread_mutex_lock(lock);
+    long long locked_at = stats_now_ns();
+    stats_record(STATS_LOCK_WAIT, locked_at - start);
+    return locked_at;
+}
+
+static void unlock_item(pthread_mutex_t* lock, long long locked_at) {
+    long long held = stats_now_ns() - locked_at;
+    pthread_mutex_unlock(lock);
+    stats_record(STATS_LOCK_HOLD, held);
+}
+
+// 응답 한 건 반영 - 샤드로 전환된 항목은 샤드로, 아니면 항목 lock 안에서
+static BallotResult cast_ballot(const BallotTarget* t, const char* username,
+                                const unsigned char* chosen, size_t chosen_count) {
+    uint64_t voter_hash = str_hash64(username);
+    HotItem* hot = atomic_load_explicit(t->hot, memory_order_acquire);
+    if (hot) return apply_ballot_hot(t, hot, username, voter_hash, chosen, chosen_count);
+
+    long long locked_at = lock_item(t->lock, t->contention, t->contention_window);
+    // 기다리는 동안 다른 스레드가 전환했을 수 있음
+    hot = atomic_load_explicit(t->hot, memory_order_relaxed);
+    if (hot) {
+        unlock_item(t->lock, locked_at);
+        return apply_ballot_hot(t, hot, username, voter_hash, chosen, chosen_count);
     }
+    BallotResult result = apply_ballot_locked(t, username, voter_hash, chosen, chosen_count);
+    maybe_promote_hot_item(t);
+    unlock_item(t->lock, locked_at);
+    return result;
+}
+
+// 반영한 보기를 그대로 로그에 남김 (재생 시 같은 결과가 되도록)
+static int log_ballot(char kind, const char* id, const char* username, const unsigned char* chosen, size_t chosen_count) {
+    WalRecord rec;
+    WalTicket ticket;
+    wal_record_init(&rec, WAL_BALLOT, kind);
+    wal_add_field(&rec, id, strlen(id));
+    wal_add_field(&rec, username, strlen(username));
+    wal_add_field(&rec, chosen, chosen_count);
+    return commit_change(wal_append(&rec, &ticket), &ticket);
+}
+
+// 사용자 이름은 비어 있지 않고 '\0' 을 담지 않아야 함 - 명단에서 빈 이름은 블록 끝 표시로 쓰임
+static int valid_username(StrView name) {
+    return name.len > 0 && !memchr(name.ptr, '\0', name.len);
+}
+
+// - respond_survey_handler: 설문 응답 요청 처리
+void respond_survey_handler(Client* client, const Request* req) 
+{
+    if (req->argc < 3 || !valid_username(req->args[2])) {
+        send_reply(client, "[ERROR] Invalid format for RESPOND_SURVEY", strlen("[ERROR] Invalid format for RESPOND_SURVEY"));
+        return;
+    }
+
+    // ID 와 이름만 짧은 지역 버퍼로 옮김 - 이름은 저장되는 이름과 같은 기준으로 비교하도록 최대 길이에 맞춰 자름
+    char id[ID_LENGTH];
+    char username[MAX_USERNAME_LEN];
+    strview_copy(id, sizeof(id), req->args[0]);
+    strview_copy(username, sizeof(username), req->args[2]);
+
+    Survey* cur = find_survey_view(req->args[0], id);
     if (!cur) {
-        pthread_mutex_unlock(&data_lock);
-        send(sockfd, "[ERROR] Survey not found", strlen("[ERROR] Survey not found"), 0);
+        send_reply(client, "[ERROR] Survey not found", strlen("[ERROR] Survey not found"));
         return;
     }
 
-    if (cur->status == STATUS_CLOSED) {
-        pthread_mutex_unlock(&data_lock);
-        send(sockfd, "[ERROR] This survey is closed.", strlen("[ERROR] This survey is closed."), 0);
+    // 보기 번호는 만든 뒤 바뀌지 않는 option_count 로만 거르므로 잠금 밖에서 미리 모음
+    unsigned char chosen[BUFFER_SIZE / 2];
+    size_t chosen_count = collect_choices(req->args[1], cur->option_count, 1, chosen, sizeof(chosen));
+    BallotTarget t = survey_target(cur);
+
+    switch (cast_ballot(&t, username, chosen, chosen_count)) {
+    case BALLOT_CLOSED:
+        send_reply(client, "[ERROR] This survey is closed.", strlen("[ERROR] This survey is closed."));
+        return;
+    case BALLOT_DUPLICATE:
+        send_reply(client, "[ERROR] You have already participated in this survey.", strlen("[ERROR] You have already participated in this survey."));
+        return;
+    case BALLOT_NO_MEMORY:
+        send_reply(client, "[ERROR] Server is out of memory.", strlen("[ERROR] Server is out of memory."));
         return;
+    case BALLOT_OK:
+        break;
     }
 
-    for (int i = 0; i < cur->voter_count; i++) {
-        if (strcmp(cur->voters[i], username) == 0) {
-            pthread_mutex_unlock(&data_lock);
-            send(sockfd, "[ERROR] You have already participated in this survey.", strlen("[ERROR] You have already participated in this survey."), 0);
-            return;
-        }
+    int saved = log_ballot('S', cur->id, username, chosen, chosen_count);
+    subscription_notify(&cur->subs);
+    if (saved < 0) {
+        send_not_saved(client);
+        return;
     }
+    send_reply(client, "[OK] Your response has been recorded.", strlen("[OK] Your response has been recorded."));
+}
+
 
-    if (cur->voter_count >= MAX_VOTERS) {
-        pthread_mutex_unlock(&data_lock);
-        send(sockfd, "[ERROR] This survey has reached its maximum number of participants.", strlen("[ERROR] This survey has reached its maximum number of participants."), 0);
+// - respond_vote_handler: 투표 응답 요청 처리
+void respond_vote_handler(Client* client, const Request* req) {
+    if (req->argc < 3 || !valid_username(req->args[2])) {
+        send_reply(client, "[ERROR] Invalid format for RESPOND_VOTE", strlen("[ERROR] Invalid format for RESPOND_VOTE"));
         return;
     }
 
-    char* saveptr_opts;
-    char* token = strtok_r(opts_csv, ",", &saveptr_opts);
-    while (token) {
-        int idx = atoi(token) - 1;
-        if (idx >= 0 && idx < cur->option_count) {
-            cur->votes[idx]++;
-        }
-        token = strtok_r(NULL, ",", &saveptr_opts);
+    char id[ID_LENGTH];
+    char username[MAX_USERNAME_LEN];
+    strview_copy(id, sizeof(id), req->args[0]);
+    strview_copy(username, sizeof(username), req->args[2]);
+
+    Vote* cur = find_vote_view(req->args[0], id);
+    if (!cur) {
+        send_reply(client, "[ERROR] Vote not found", strlen("[ERROR] Vote not found"));
+        return;
     }
 
-    strncpy(cur->voters[cur->voter_count], username, MAX_USERNAME_LEN);
-    cur->voter_count++;
+    unsigned char chosen;
+    size_t chosen_count = collect_choices(req->args[1], cur->option_count, 0, &chosen, 1);
+    BallotTarget t = vote_target(cur);
 
-    save_survey_to_file(cur);
-    pthread_mutex_unlock(&data_lock);
-    
-    send(sockfd, "[OK] Your response has been recorded.", strlen("[OK] Your response has been recorded."), 0);
+    switch (cast_ballot(&t, username, &chosen, chosen_count)) {
+    case BALLOT_CLOSED:
+        send_reply(client, "[ERROR] This vote is closed.", strlen("[ERROR] This vote is closed."));
+        return;
+    case BALLOT_DUPLICATE:
+        send_reply(client, "[ERROR] You have already voted on this item.", strlen("[ERROR] You have already voted on this item."));
+        return;
+    case BALLOT_NO_MEMORY:
+        send_reply(client, "[ERROR] Server is out of memory.", strlen("[ERROR] Server is out of memory."));
+        return;
+    case BALLOT_OK:
+        break;
+    }
+
+    int saved = log_ballot('V', cur->id, username, &chosen, chosen_count);
+    subscription_notify(&cur->subs);
+    if (saved < 0) {
+        send_not_saved(client);
+        return;
+    }
+    send_reply(client, "[OK] Your vote has been recorded.", strlen("[OK] Your vote has been recorded."));
 }
 
+// RESPOND_BATCH 안의 응답 한 건
+typedef struct BatchBallot {
+    size_t  index;      // 요청 안에서의 순서
+    char    kind;       // 'S' / 'V'
+    void*   item;       // Survey* / Vote* (찾지 못했으면 NULL)
+    StrView opts;
+    const char* result; // 응답 줄에 쓸 결과
+    int     accepted;
+    char    id[ID_LENGTH];
+    char    username[MAX_USERNAME_LEN];
+    unsigned char chosen[BATCH_MAX_CHOICES];
+    size_t  chosen_count;
+} BatchBallot;
+
+static BallotTarget ballot_target(const BatchBallot* b) {
+    return b->kind == 'S' ? survey_target(b->item) : vote_target(b->item);
+}
 
-// - respond_vote_handler: 투표 응답 요청 처리
-void respond_vote_handler(int sockfd, char* msg) {
-    char* saveptr;
-    pthread_mutex_lock(&data_lock);
+static const char* batch_result_text(BallotResult result) {
+    switch (result) {
+    case BALLOT_OK:        return "OK";
+    case BALLOT_CLOSED:    return "ERROR Closed";
+    case BALLOT_DUPLICATE: return "ERROR Already participated";
+    default:               return "ERROR Server is out of memory";
+    }
+}
 
-    strtok_r(msg, "|", &saveptr);
-    char* id = strtok_r(NULL, "|", &saveptr);
-    char* opt_str = strtok_r(NULL, "|", &saveptr);
-    char* username = strtok_r(NULL, "|", &saveptr);
+// 같은 항목의 응답끼리 모이도록 항목 주소로 정렬하되, 같은 항목 안에서는 요청 순서 유지
+static int compare_ballots(const void* a, const void* b) {
+    const BatchBallot* x = *(BatchBallot* const*)a;
+    const BatchBallot* y = *(BatchBallot* const*)b;
+    if (x->item != y->item) return (uintptr_t)x->item < (uintptr_t)y->item ? -1 : 1;
+    return x->index < y->index ? -1 : (x->index > y->index);
+}
 
-    if (id == NULL || opt_str == NULL || username == NULL) {
-        pthread_mutex_unlock(&data_lock);
-        send(sockfd, "[ERROR] Invalid format for RESPOND_VOTE", strlen("[ERROR] Invalid format for RESPOND_VOTE"), 0);
-        return;
+// "종류:ID:보기:사용자" 한 건을 나눔 - 사용자 이름은 마지막 필드라 ':' 가 들어 있어도 그대로 둠
+static int parse_ballot(StrView field, BatchBallot* b) {
+    StrView parts[3];
+    for (int i = 0; i < 3; i++) {
+        const char* colon = memchr(field.ptr, ':', field.len);
+        if (!colon) return -1;
+        parts[i].ptr = field.ptr;
+        parts[i].len = (size_t)(colon - field.ptr);
+        field.len -= parts[i].len + 1;
+        field.ptr = colon + 1;
+    }
+    if (parts[0].len != 1 || (parts[0].ptr[0] != 'S' && parts[0].ptr[0] != 'V') ||
+        parts[1].len == 0 || parts[1].len >= ID_LENGTH || parts[2].len == 0 || !valid_username(field)) {
+        return -1;
     }
+    b->kind = parts[0].ptr[0];
+    strview_copy(b->id, sizeof(b->id), parts[1]);
+    b->opts = parts[2];
+    strview_copy(b->username, sizeof(b->username), field);
+    return 0;
+}
 
-    Vote* cur = vote_head;
-    while (cur && strcmp(cur->id, id) != 0) {
-        cur = cur->next;
+// 일괄 응답 처리에 빌린 버퍼들을 돌려줌
+static void free_batch_buffers(BatchBallot* ballots, BatchBallot** order, WalRecord* recs, char* resp,
+                               size_t count, size_t resp_cap) {
+    buffer_free(ballots, count * sizeof(BatchBallot));
+    buffer_free(order, count * sizeof(BatchBallot*));
+    buffer_free(recs, count * sizeof(WalRecord));
+    buffer_free(resp, resp_cap);
+}
+
+// - respond_batch_handler: 여러 항목에 대한 응답을 한 요청으로 처리
+// 응답을 항목별로 묶어 항목 잠금은 한 번씩만 잡고, 받아들인 응답은 모두 한 번의 로그 기록과
+// 한 번의 커밋으로 남긴 뒤 요청 순서대로 결과를 돌려줌
+void respond_batch_handler(Client* client, const Request* req) {
+    StrView rest = req->tail, field;
+    size_t count = 0;
+
+    for (StrView scan = rest; strview_next(&scan, '|', &field);) {
+        count++;
     }
-    if (!cur) {
-        pthread_mutex_unlock(&data_lock);
-        send(sockfd, "[ERROR] Vote not found", strlen("[ERROR] Vote not found"), 0);
+    if (count == 0) {
+        send_reply(client, "[ERROR] Invalid format for RESPOND_BATCH", strlen("[ERROR] Invalid format for RESPOND_BATCH"));
         return;
     }
-
-    if (cur->status == STATUS_CLOSED) {
-        pthread_mutex_unlock(&data_lock);
-        send(sockfd, "[ERROR] This vote is closed.", strlen("[ERROR] This vote is closed."), 0);
+    if (count > MAX_BATCH_BALLOTS) {
+        char resp[128];
+        snprintf(resp, sizeof(resp), "[ERROR] Too many ballots in one batch (max %d)", MAX_BATCH_BALLOTS);
+        send_reply(client, resp, strlen(resp));
         return;
     }
 
-    for (int i = 0; i < cur->voter_count; i++) {
-        if (strcmp(cur->voters[i], username) == 0) {
-            pthread_mutex_unlock(&data_lock);
-            send(sockfd, "[ERROR] You have already voted on this item.", strlen("[ERROR] You have already voted on this item."), 0);
-            return;
+    // 작업 배열은 I/O 버퍼 풀에서 꺼냄 (큰 묶음만 malloc)
+    BatchBallot* ballots = buffer_alloc(count * sizeof(BatchBallot));
+    BatchBallot** order = buffer_alloc(count * sizeof(BatchBallot*));
+    WalRecord* recs = buffer_alloc(count * sizeof(WalRecord));
+    // 결과 줄: "번호 결과\n" - 가장 긴 결과 문구 기준으로 넉넉하게
+    size_t resp_cap = 96 + count * 48;
+    char* resp = buffer_alloc(resp_cap);
+    if (!ballots || !order || !recs || !resp) {
+        free_batch_buffers(ballots, order, recs, resp, count, resp_cap);
+        send_reply(client, "[ERROR] Server is out of memory.", strlen("[ERROR] Server is out of memory."));
+        return;
+    }
+    memset(ballots, 0, count * sizeof(BatchBallot));
+
+    // 1. 나누기 - 항목 찾기는 목록 읽기 잠금을 종류별로 한 번만 잡고 처리
+    size_t valid = 0;
+    for (size_t i = 0; strview_next(&rest, '|', &field); i++) {
+        BatchBallot* b = &ballots[i];
+        b->index = i;
+        if (parse_ballot(field, b) < 0) {
+            b->result = "ERROR Invalid format";
+            continue;
         }
+        order[valid++] = b;
     }
-    
-    if (cur->voter_count >= MAX_VOTERS) {
-        pthread_mutex_unlock(&data_lock);
-        send(sockfd, "[ERROR] This vote has reached its maximum number of participants.", strlen("[ERROR] This vote has reached its maximum number of participants."), 0);
-        return;
+    pthread_rwlock_rdlock(&survey_list_lock);
+    for (size_t i = 0; i < valid; i++) {
+        if (order[i]->kind == 'S') order[i]->item = find_survey_locked(order[i]->id);
+    }
+    pthread_rwlock_unlock(&survey_list_lock);
+    pthread_rwlock_rdlock(&vote_list_lock);
+    for (size_t i = 0; i < valid; i++) {
+        if (order[i]->kind == 'V') order[i]->item = find_vote_locked(order[i]->id);
     }
+    pthread_rwlock_unlock(&vote_list_lock);
+
+    size_t found = 0;
+    for (size_t i = 0; i < valid; i++) {
+        if (order[i]->item) order[found++] = order[i];
+        else order[i]->result = order[i]->kind == 'S' ? "ERROR Survey not found" : "ERROR Vote not found";
+    }
+
+    // 2. 항목별로 묶어 잠금 한 번에 반영 - 샤드로 전환된 항목은 응답마다 샤드 잠금만 잡음
+    qsort(order, found, sizeof(BatchBallot*), compare_ballots);
+    for (size_t g = 0; g < found;) {
+        BallotTarget t = ballot_target(order[g]);
+        size_t end = g;
+        while (end < found && order[end]->item == order[g]->item) {
+            BatchBallot* b = order[end++];
+            // 투표는 첫 보기 하나만, 설문은 쉼표로 나열한 보기 모두 반영 (단건 명령과 같은 규칙)
+            b->chosen_count = collect_choices(b->opts, t.option_count, b->kind == 'S', b->chosen, sizeof(b->chosen));
+        }
 
-    int idx = atoi(opt_str) - 1;
-    if (idx >= 0 && idx < cur->option_count) {
-        cur->votes[idx]++;
+        long long locked_at = lock_item(t.lock, NULL, NULL);
+        HotItem* hot = atomic_load_explicit(t.hot, memory_order_relaxed);
+        for (size_t i = g; i < end; i++) {
+            BatchBallot* b = order[i];
+            BallotResult r = hot ? apply_ballot_hot(&t, hot, b->username, str_hash64(b->username), b->chosen, b->chosen_count)
+                                 : apply_ballot_locked(&t, b->username, str_hash64(b->username), b->chosen, b->chosen_count);
+            b->result = batch_result_text(r);
+            b->accepted = r == BALLOT_OK;
+        }
+        unlock_item(t.lock, locked_at);
+        g = end;
     }
 
-    strncpy(cur->voters[cur->voter_count], username, MAX_USERNAME_LEN);
-    cur->voter_count++;
+    // 3. 받아들인 응답 전체를 한 번에 기록하고 커밋
+    size_t accepted = 0;
+    for (size_t i = 0; i < found; i++) {
+        BatchBallot* b = order[i];
+        if (!b->accepted) continue;
+        wal_record_init(&recs[accepted], WAL_BALLOT, b->kind);
+        wal_add_field(&recs[accepted], b->id, strlen(b->id));
+        wal_add_field(&recs[accepted], b->username, strlen(b->username));
+        wal_add_field(&recs[accepted], b->chosen, b->chosen_count);
+        accepted++;
+    }
+    int saved = 0;
+    if (accepted > 0) {
+        WalTicket ticket;
+        saved = commit_change(wal_append_batch(recs, accepted, &ticket), &ticket);
+        // 받아들인 응답이 있는 항목마다 구독자에게 알림 (같은 항목은 정렬되어 이웃해 있음)
+        for (size_t i = 0; i < found; i++) {
+            BatchBallot* b = order[i];
+            if (!b->accepted || (i > 0 && order[i - 1]->item == b->item && order[i - 1]->accepted)) continue;
+            subscription_notify(b->kind == 'S' ? &((Survey*)b->item)->subs : &((Vote*)b->item)->subs);
+        }
+    }
 
-    save_vote_to_file(cur);
-    pthread_mutex_unlock(&data_lock);
+    if (saved < 0) {
+        send_not_saved(client);
+        free_batch_buffers(ballots, order, recs, resp, count, resp_cap);
+        return;
+    }
 
-    send(sockfd, "[OK] Your vote has been recorded.", strlen("[OK] Your vote has been recorded."), 0);
+    // 4. 요청 순서대로 결과 줄 작성
+    size_t offset = (size_t)snprintf(resp, resp_cap, "[OK] Batch processed: %zu ballots, %zu accepted\n", count, accepted);
+    for (size_t i = 0; i < count && offset < resp_cap; i++) {
+        offset += (size_t)snprintf(resp + offset, resp_cap - offset, "%zu %s\n", i + 1, ballots[i].result);
+    }
+    if (offset > resp_cap - 1) offset = resp_cap - 1;
+    send_reply(client, resp, offset);
+    free_batch_buffers(ballots, order, recs, resp, count, resp_cap);
 }
 
 // - close_survey_handler: 설문 종료 요청 처리
-void close_survey_handler(int sockfd, char* msg) {
-    char* saveptr;
-    pthread_mutex_lock(&data_lock);
-    strtok_r(msg, "|", &saveptr);
-    char* id = strtok_r(NULL, "|", &saveptr);
-    if (id == NULL) {
-        pthread_mutex_unlock(&data_lock);
-        send(sockfd, "[ERROR] Invalid format for CLOSE_SURVEY", strlen("[ERROR] Invalid format for CLOSE_SURVEY"), 0);
+void close_survey_handler(Client* client, const Request* req) {
+    if (req->argc < 1) {
+        send_reply(client, "[ERROR] Invalid format for CLOSE_SURVEY", strlen("[ERROR] Invalid format for CLOSE_SURVEY"));
         return;
     }
-    Survey* cur = survey_head;
-    while (cur && strcmp(cur->id, id) != 0) {
-        cur = cur->next;
-    }
+    char id[ID_LENGTH];
+    strview_copy(id, sizeof(id), req->args[0]);
+    Survey* cur = find_survey_view(req->args[0], id);
     if (!cur) {
-        pthread_mutex_unlock(&data_lock);
-        send(sockfd, "[ERROR] Survey not found", strlen("[ERROR] Survey not found"), 0);
+        send_reply(client, "[ERROR] Survey not found", strlen("[ERROR] Survey not found"));
         return;
     }
+    // 샤드로 전환된 항목은 샤드에서도 상태를 확인하므로 모든 샤드를 잡고 바꿈
+    long long locked_at = lock_item(&cur->lock, NULL, NULL);
+    HotItem* hot = atomic_load_explicit(&cur->hot, memory_order_relaxed);
+    if (hot) hot_item_lock_all(hot);
+    seqlock_write_begin(&cur->tally_seq);
     cur->status = STATUS_CLOSED;
-    save_survey_to_file(cur);
-    pthread_mutex_unlock(&data_lock);
+    seqlock_write_end(&cur->tally_seq);
+    cur->change_seq++;
+    if (hot) hot_item_unlock_all(hot);
+    unlock_item(&cur->lock, locked_at);
+    atomic_fetch_add_explicit(&survey_list_version, 1, memory_order_release);
+
+    WalRecord rec;
+    WalTicket ticket;
+    wal_record_init(&rec, WAL_CLOSE, 'S');
+    wal_add_field(&rec, cur->id, strlen(cur->id));
+    int saved = commit_change(wal_append(&rec, &ticket), &ticket);
+    subscription_notify(&cur->subs);
+    if (saved < 0) {
+        send_not_saved(client);
+        return;
+    }
     char resp[BUFFER_SIZE];
     snprintf(resp, sizeof(resp), "[OK] Survey %s is now closed.", id);
-    send(sockfd, resp, strlen(resp), 0);
+    send_reply(client, resp, strlen(resp));
 }
 
 // - close_vote_handler: 투표 종료 요청 처리
-void close_vote_handler(int sockfd, char* msg) {
-    char* saveptr;
-    pthread_mutex_lock(&data_lock);
-    strtok_r(msg, "|", &saveptr);
-    char* id = strtok_r(NULL, "|", &saveptr);
-    if (id == NULL) {
-        pthread_mutex_unlock(&data_lock);
-        send(sockfd, "[ERROR] Invalid format for CLOSE_VOTE", strlen("[ERROR] Invalid format for CLOSE_VOTE"), 0);
+void close_vote_handler(Client* client, const Request* req) {
+    if (req->argc < 1) {
+        send_reply(client, "[ERROR] Invalid format for CLOSE_VOTE", strlen("[ERROR] Invalid format for CLOSE_VOTE"));
         return;
     }
-    Vote* cur = vote_head;
-    while (cur && strcmp(cur->id, id) != 0) {
-        cur = cur->next;
-    }
+    char id[ID_LENGTH];
+    strview_copy(id, sizeof(id), req->args[0]);
+    Vote* cur = find_vote_view(req->args[0], id);
     if (!cur) {
-        pthread_mutex_unlock(&data_lock);
-        send(sockfd, "[ERROR] Vote not found", strlen("[ERROR] Vote not found"), 0);
+        send_reply(client, "[ERROR] Vote not found", strlen("[ERROR] Vote not found"));
         return;
     }
+    // 샤드로 전환된 항목은 샤드에서도 상태를 확인하므로 모든 샤드를 잡고 바꿈
+    long long locked_at = lock_item(&cur->lock, NULL, NULL);
+    HotItem* hot = atomic_load_explicit(&cur->hot, memory_order_relaxed);
+    if (hot) hot_item_lock_all(hot);
+    seqlock_write_begin(&cur->tally_seq);
     cur->status = STATUS_CLOSED;
-    save_vote_to_file(cur);
-    pthread_mutex_unlock(&data_lock);
+    seqlock_write_end(&cur->tally_seq);
+    cur->change_seq++;
+    if (hot) hot_item_unlock_all(hot);
+    unlock_item(&cur->lock, locked_at);
+    atomic_fetch_add_explicit(&vote_list_version, 1, memory_order_release);
+
+    WalRecord rec;
+    WalTicket ticket;
+    wal_record_init(&rec, WAL_CLOSE, 'V');
+    wal_add_field(&rec, cur->id, strlen(cur->id));
+    int saved = commit_change(wal_append(&rec, &ticket), &ticket);
+    subscription_notify(&cur->subs);
+    if (saved < 0) {
+        send_not_saved(client);
+        return;
+    }
     char resp[BUFFER_SIZE];
     snprintf(resp, sizeof(resp), "[OK] Vote %s is now closed.", id);
-    send(sockfd, resp, strlen(resp), 0);
-}
-
-// - list_survey_handler: 설문 목록 요청 처리
-void list_survey_handler(int sockfd, char* msg) {
-    char resp[BUFFER_SIZE] = {0};
-    int offset = 0;
-    pthread_mutex_lock(&data_lock);
-    Survey* cur = survey_head;
-    while (cur) {
-        const char* status_str = (cur->status == STATUS_ACTIVE) ? "Active" : "Closed";
-        offset += snprintf(resp + offset, sizeof(resp) - offset,
-                           "[%s] ID: %s, Question: %s\n", status_str, cur->id, cur->question);
-        cur = cur->next;
-        if (offset >= sizeof(resp) - 1) break;
-    }
-    pthread_mutex_unlock(&data_lock);
-    if (offset == 0) {
-        snprintf(resp, sizeof(resp), "No surveys available.");
+    send_reply(client, resp, strlen(resp));
+}
+
+// 방금 만든 응답을 캐시에 넣고 보낼 참조를 반환 (메모리 부족이면 NULL - 호출자가 만든 버퍼를 그대로 보냄)
+static CachedReply* store_reply(ReplySlot* slot, unsigned long version, const char* buf, size_t len) {
+    CachedReply* reply = cached_reply_create(version, buf, len);
+    if (reply) reply_slot_put(slot, reply);
+    return reply;
+}
+
+// 캐시된 응답을 보내고 참조를 놓음 - 캐시에 넣지 못했으면(NULL) 호출자가 만든 resp 를 보냄
+// version 이 0 이 아니면(조건부 요청) 끝에 버전 줄을 붙임
+static void send_result(Client* client, CachedReply* reply, const char* resp, size_t len, unsigned long version) {
+    if (reply) {
+        send_versioned_reply(client, reply->data, reply->len, version);
+        cached_reply_release(reply);
+    } else {
+        send_versioned_reply(client, resp, len, version);
     }
-    send(sockfd, resp, strlen(resp), 0);
 }
 
-// - list_vote_handler: 투표 목록 요청 처리
-void list_vote_handler(int sockfd, char* msg) {
-    char resp[BUFFER_SIZE] = {0};
-    int offset = 0;
-    pthread_mutex_lock(&data_lock);
-    Vote* cur = vote_head;
-    while (cur) {
-        const char* status_str = (cur->status == STATUS_ACTIVE) ? "Active" : "Closed";
-        offset += snprintf(resp + offset, sizeof(resp) - offset,
-                           "[%s] ID: %s, Title: %s\n", status_str, cur->id, cur->title);
-        cur = cur->next;
-        if (offset >= sizeof(resp) - 1) break;
+// LIST 한 줄: "[상태] ID: <id>, Question: <제목>\n" - 상태 문자열은 Active/Closed 모두 6글자라
+// 줄 길이는 항목을 만든 뒤 바뀌지 않음 (길이를 먼저 세고 나중에 보내도 머리의 길이와 맞음)
+#define LIST_STATUS_ACTIVE "[Active] ID: "
+#define LIST_STATUS_CLOSED "[Closed] ID: "
+#define LIST_STATUS_LEN    (sizeof(LIST_STATUS_ACTIVE) - 1)
+
+// 설문/투표 목록을 한 코드로 훑기 위한 접근 함수 묶음
+typedef struct ListOps {
+    const char* separator;  // ", Question: " / ", Title: "
+    const char* empty;      // 항목이 하나도 없을 때의 응답
+    void*       (*head)(void);
+    void*       (*next)(void* node);
+    void*       (*find)(StrView view, const char* id);
+    const char* (*id)(void* node);
+    const char* (*text)(void* node);
+    ItemStatus  (*status)(void* node);
+} ListOps;
+
+// 항목은 삭제되지 않고 앞에만 추가되므로 머리만 읽으면 목록 잠금 없이 끝까지 훑을 수 있음
+static void* survey_list_head(void) { return atomic_load_explicit(&survey_head, memory_order_acquire); }
+static void* survey_list_next(void* node) { return ((Survey*)node)->next; }
+static void* survey_list_find(StrView view, const char* id) { return find_survey_view(view, id); }
+static const char* survey_list_id(void* node) { return ((Survey*)node)->id; }
+static const char* survey_list_text(void* node) { return ((Survey*)node)->question; }
+static ItemStatus survey_list_status(void* node) {
+    Tally tally;
+    read_survey_tally(node, &tally);
+    return tally.status;
+}
+
+static void* vote_list_head(void) { return atomic_load_explicit(&vote_head, memory_order_acquire); }
+static void* vote_list_next(void* node) { return ((Vote*)node)->next; }
+static void* vote_list_find(StrView view, const char* id) { return find_vote_view(view, id); }
+static const char* vote_list_id(void* node) { return ((Vote*)node)->id; }
+static const char* vote_list_text(void* node) { return ((Vote*)node)->title; }
+static ItemStatus vote_list_status(void* node) {
+    Tally tally;
+    read_vote_tally(node, &tally);
+    return tally.status;
+}
+
+static const ListOps survey_list_ops = {
+    ", Question: ", "No surveys available.", survey_list_head, survey_list_next, survey_list_find,
+    survey_list_id, survey_list_text, survey_list_status
+};
+
+static const ListOps vote_list_ops = {
+    ", Title: ", "No votes available.", vote_list_head, vote_list_next, vote_list_find,
+    vote_list_id, vote_list_text, vote_list_status
+};
+
+// 한 버퍼에 목록을 씀 - 다 담지 못하면 잘린 채로 두고 *complete 를 0 으로
+static size_t render_list(const ListOps* ops, void* cur, char* resp, size_t size, int* complete) {
+    size_t offset = 0;
+    resp[0] = '\0';
+    *complete = 1;
+    for (; cur; cur = ops->next(cur)) {
+        offset += snprintf(resp + offset, size - offset, "%s%s%s%s\n",
+                           ops->status(cur) == STATUS_ACTIVE ? LIST_STATUS_ACTIVE : LIST_STATUS_CLOSED,
+                           ops->id(cur), ops->separator, ops->text(cur));
+        if (offset >= size - 1) {
+            *complete = 0;
+            break;
+        }
     }
-    pthread_mutex_unlock(&data_lock);
     if (offset == 0) {
-        snprintf(resp, sizeof(resp), "No votes available.");
+        snprintf(resp, size, "%s", ops->empty);
+    }
+    return strlen(resp);
+}
+
+// 목록 줄을 iovec 으로 모아 writev 처럼 한 번에 보내는 스트림
+// 줄의 ID/제목은 복사하지 않고 항목의 필드를 직접 가리키며 (만든 뒤 바뀌지 않음), 응답 전체를 담는 버퍼는 만들지 않음
+#define LIST_STREAM_IOV 512  // IOV_MAX(1024) 이하
+
+typedef struct ListStream {
+    Client*      client;
+    struct iovec iov[LIST_STREAM_IOV];
+    int          count;
+    int          failed;
+} ListStream;
+
+// more: 뒤에 더 보낼 조각이 있음 (마지막 flush 만 0)
+static void list_stream_flush(ListStream* st, int more) {
+    if (st->count > 0 && !st->failed && send_iov(st->client, st->iov, st->count, more) < 0) st->failed = 1;
+    st->count = 0;
+}
+
+static void list_stream_add(ListStream* st, const void* data, size_t len) {
+    if (st->count == LIST_STREAM_IOV) list_stream_flush(st, 1);
+    st->iov[st->count].iov_base = (void*)data;
+    st->iov[st->count].iov_len = len;
+    st->count++;
+}
+
+// start 부터 최대 limit 개 항목을 보냄 - trailer 가 있으면 목록 뒤에 붙임
+// 프레임 방식이면 길이를 먼저 세어 머리에 쓰고, 같은 항목들을 다시 훑으며 보냄
+// (시작 항목과 개수가 정해져 있고 줄 길이는 바뀌지 않으므로 두 번 훑어도 길이가 같음)
+static int stream_list(Client* client, const ListOps* ops, void* start, size_t limit, const char* trailer) {
+    size_t separator_len = strlen(ops->separator), trailer_len = trailer ? strlen(trailer) : 0;
+    size_t total = trailer_len, count = 0;
+    for (void* cur = start; cur && count < limit; cur = ops->next(cur), count++) {
+        total += LIST_STATUS_LEN + strlen(ops->id(cur)) + separator_len + strlen(ops->text(cur)) + 1;
     }
-    send(sockfd, resp, strlen(resp), 0);
+
+    ListStream* st = buffer_alloc(sizeof(ListStream));
+    unsigned char header[FRAME_HEADER_LEN];
+    if (!st) return -1;
+    st->client = client;
+    st->count = 0;
+    st->failed = 0;
+    if (client->framed == 1) {
+        encode_frame_header(header, total);
+        list_stream_add(st, header, sizeof(header));
+    }
+    void* cur = start;
+    for (size_t i = 0; i < count; i++, cur = ops->next(cur)) {
+        const char* id = ops->id(cur);
+        const char* text = ops->text(cur);
+        list_stream_add(st, ops->status(cur) == STATUS_ACTIVE ? LIST_STATUS_ACTIVE : LIST_STATUS_CLOSED, LIST_STATUS_LEN);
+        list_stream_add(st, id, strlen(id));
+        list_stream_add(st, ops->separator, separator_len);
+        list_stream_add(st, text, strlen(text));
+        list_stream_add(st, "\n", 1);
+    }
+    if (trailer_len > 0) list_stream_add(st, trailer, trailer_len);
+    list_stream_flush(st, 0);
+    int ret = st->failed ? -1 : 0;
+    buffer_free(st, sizeof(ListStream));
+    return ret;
 }
 
-// - result_survey_handler: 설문 결과 요청 처리
-void result_survey_handler(int sockfd, char* msg) 
+// LIST_*|커서|개수[|버전]: 커서("-" 이면 처음부터) 다음 항목부터 최대 개수만큼, 끝에 다음 커서를 붙여 보냄
+// 항목은 앞에만 추가되고 next 는 바뀌지 않으므로, 커서 뒤의 순서는 그 사이 새 항목이 생겨도 그대로임
+// 버전을 주면 목록 버전이 같을 때 짧은 응답만 보내고, 다르면 끝 줄 뒤에 지금 버전을 붙임
+static void list_page(Client* client, const Request* req, const ListOps* ops, atomic_ulong* version_counter) {
+    unsigned long version = 0;
+    if (req->argc > 2) {
+        version = atomic_load_explicit(version_counter, memory_order_acquire);
+        if (send_if_not_modified(client, req->args[2], version)) return;
+    }
+
+    void* start;
+    if (req->args[0].len == 1 && req->args[0].ptr[0] == '-') {
+        start = ops->head();
+    } else {
+        char id[ID_LENGTH];
+        strview_copy(id, sizeof(id), req->args[0]);
+        void* cursor = ops->find(req->args[0], id);
+        if (!cursor) {
+            send_reply(client, "[ERROR] Unknown list cursor", strlen("[ERROR] Unknown list cursor"));
+            return;
+        }
+        start = ops->next(cursor);
+    }
+
+    int limit = req->argc > 1 ? strview_to_int(req->args[1]) : LIST_PAGE_DEFAULT;
+    if (limit <= 0) limit = LIST_PAGE_DEFAULT;
+    if (limit > LIST_PAGE_MAX) limit = LIST_PAGE_MAX;
+
+    // 마지막으로 보낼 항목과 그 뒤에 남은 항목이 있는지 확인해 끝 줄을 정함
+    void* last = NULL;
+    void* cur = start;
+    for (int i = 0; cur && i < limit; i++, cur = ops->next(cur)) last = cur;
+    char trailer[ID_LENGTH + 48];
+    int offset;
+    if (cur && last) offset = snprintf(trailer, sizeof(trailer), "[NEXT] %s\n", ops->id(last));
+    else offset = snprintf(trailer, sizeof(trailer), "[END]\n");
+    if (version) snprintf(trailer + offset, sizeof(trailer) - offset, "[VERSION] %lu\n", version);
+    stream_list(client, ops, start, (size_t)limit, trailer);
+}
+
+// 전체 목록: 한 버퍼(BUFFER_SIZE)에 다 들어가면 목록 버전별로 캐시해 두고 그대로 보냄
+// 목록 버전은 바꾸는 쪽이 변경 뒤에 올리므로, 만들기 전에 읽은 버전으로 보관하면 내용이 버전보다
+// 오래될 일은 없음 (더 새로울 수는 있으나 다음 요청이 새 버전으로 다시 만듦)
+// 다 들어가지 않으면 프레임 방식 연결에는 전체를 스트리밍하고, recv() 한 번으로 받는 기존 방식
+// 연결에는 예전처럼 버퍼에 들어간 만큼만 보냄
+// 조건부 요청(LIST_*|*|버전)은 목록 버전이 같으면 짧은 응답만, 다르면 목록 뒤에 지금 버전을 붙임
+static void list_all(Client* client, const Request* req, const ListOps* ops, ReplySlot* slot, atomic_ulong* version_counter) {
+    unsigned long version = atomic_load_explicit(version_counter, memory_order_acquire);
+    int conditional = req->argc > 1;
+    if (conditional && send_if_not_modified(client, req->args[1], version)) return;
+    unsigned long reply_version = conditional ? version : 0;
+
+    CachedReply* reply = reply_slot_get(slot, version);
+    if (reply) {
+        send_result(client, reply, NULL, 0, reply_version);
+        return;
+    }
+
+    char resp[BUFFER_SIZE];
+    int complete;
+    void* head = ops->head();
+    size_t len = render_list(ops, head, resp, sizeof(resp), &complete);
+    if (complete) {
+        reply = store_reply(slot, version, resp, len);
+        send_result(client, reply, resp, len, reply_version);
+    } else if (client->framed == 1) {
+        char trailer[48];
+        snprintf(trailer, sizeof(trailer), "[VERSION] %lu\n", version);
+        stream_list(client, ops, head, SIZE_MAX, conditional ? trailer : NULL);
+    } else {
+        send_versioned_reply(client, resp, len, reply_version);
+    }
+}
+
+// 전체 목록 요청인지 - 인자가 없거나 커서가 "*" (LIST_*|*|버전 은 조건부 전체 목록)
+static int is_full_list(const Request* req) {
+    return req->argc == 0 || (req->args[0].len == 1 && req->args[0].ptr[0] == '*');
+}
+
+// - list_survey_handler: 설문 목록 요청 처리 (LIST_SURVEY[|*|버전] 또는 LIST_SURVEY|커서|개수[|버전])
+void list_survey_handler(Client* client, const Request* req) {
+    if (!is_full_list(req)) list_page(client, req, &survey_list_ops, &survey_list_version);
+    else list_all(client, req, &survey_list_ops, survey_list_reply, &survey_list_version);
+}
+
+// - list_vote_handler: 투표 목록 요청 처리 (LIST_VOTE[|*|버전] 또는 LIST_VOTE|커서|개수[|버전])
+void list_vote_handler(Client* client, const Request* req) {
+    if (!is_full_list(req)) list_page(client, req, &vote_list_ops, &vote_list_version);
+    else list_all(client, req, &vote_list_ops, vote_list_reply, &vote_list_version);
+}
+
+// 제목/보기는 만든 뒤 바뀌지 않으므로 결과 문자열은 집계 사본만으로 정해짐
+static size_t render_result(const char* label, const char* title, char options[][MAX_OPTION_LEN], int option_count,
+                            const Tally* tally, char* resp, size_t size) {
+    int total = 0;
+    for (int i = 0; i < option_count; i++) {
+        total += tally->votes[i];
+    }
+    size_t offset = 0;
+    const char* status_str = (tally->status == STATUS_ACTIVE) ? "Active" : "Closed";
+    offset += (size_t)snprintf(resp + offset, size - offset, "%s: %s [%s] (%d participants)\n",
+                               label, title, status_str, tally->voter_count);
+    for (int i = 0; i < option_count && offset < size - 1; i++) {
+        int pct = (total > 0) ? (tally->votes[i] * 100 / total) : 0;
+        offset += (size_t)snprintf(resp + offset, size - offset,
+                                   "  %d. %s - %d votes (%d%%)\n",
+                                   i + 1, options[i], tally->votes[i], pct);
+    }
+    return offset < size ? offset : size - 1;
+}
+
+// 집계 사본에 맞는 결과 응답을 캐시에서 꺼내거나 새로 만들어 넣고 참조를 반환
+// 메모리 부족이면 NULL - resp 에 만든 문자열이 남아 있으므로 호출자가 그대로 보낼 수 있음
+static CachedReply* result_reply(ReplySlot* slot, const char* label, const char* title, char options[][MAX_OPTION_LEN],
+                                 int option_count, const Tally* tally, char* resp, size_t size, size_t* len) {
+    CachedReply* reply = reply_slot_get(slot, tally->version);
+    if (reply) return reply;
+    *len = render_result(label, title, options, option_count, tally, resp, size);
+    return store_reply(slot, tally->version, resp, *len);
+}
+
+static CachedReply* survey_result_reply(Survey* cur, const Tally* tally, char* resp, size_t size, size_t* len) {
+    return result_reply(cur->result_reply, "Question", cur->question, cur->options, cur->option_count, tally, resp, size, len);
+}
+
+static CachedReply* vote_result_reply(Vote* cur, const Tally* tally, char* resp, size_t size, size_t* len) {
+    return result_reply(cur->result_reply, "Title", cur->title, cur->options, cur->option_count, tally, resp, size, len);
+}
+
+// - result_survey_handler: 설문 결과 요청 처리 (RESULT_SURVEY|ID 또는 조건부 RESULT_SURVEY|ID|버전)
+// 집계만 잠금 없이 떠 와서, 마지막으로 만든 응답과 집계 버전이 같으면 그 버퍼를 그대로 보냄
+// 조건부 요청은 버전이 같으면 결과를 만들지 않고 짧은 응답만 보냄
+void result_survey_handler(Client* client, const Request* req) 
 {
-    char resp[BUFFER_SIZE] = {0};
-    char* saveptr;
-    pthread_mutex_lock(&data_lock);
-    strtok_r(msg, "|", &saveptr);
-    char* id = strtok_r(NULL, "|", &saveptr);
-    if (id == NULL) {
-        pthread_mutex_unlock(&data_lock);
-        send(sockfd, "[ERROR] Invalid format for RESULT_SURVEY", strlen("[ERROR] Invalid format for RESULT_SURVEY"), 0);
+    if (req->argc < 1) {
+        send_reply(client, "[ERROR] Invalid format for RESULT_SURVEY", strlen("[ERROR] Invalid format for RESULT_SURVEY"));
         return;
     }
-    Survey* cur = survey_head;
-    while (cur && strcmp(cur->id, id) != 0) {
-        cur = cur->next;
+    char id[ID_LENGTH];
+    strview_copy(id, sizeof(id), req->args[0]);
+    Survey* cur = find_survey_view(req->args[0], id);
+    if (!cur) {
+        send_reply(client, "[ERROR] Survey not found", strlen("[ERROR] Survey not found"));
+        return;
     }
+    Tally tally;
+    read_survey_tally(cur, &tally);
+    int conditional = req->argc > 1;
+    if (conditional && send_if_not_modified(client, req->args[1], tally.version)) return;
+
+    char resp[BUFFER_SIZE];
+    size_t len;
+    CachedReply* reply = survey_result_reply(cur, &tally, resp, sizeof(resp), &len);
+    send_result(client, reply, resp, len, conditional ? tally.version : 0);
+}
+
+// - result_vote_handler: 투표 결과 요청 처리 (RESULT_VOTE|ID 또는 조건부 RESULT_VOTE|ID|버전)
+void result_vote_handler(Client* client, const Request* req) {
+    if (req->argc < 1) {
+        send_reply(client, "[ERROR] Invalid format for RESULT_VOTE", strlen("[ERROR] Invalid format for RESULT_VOTE"));
+        return;
+    }
+    char id[ID_LENGTH];
+    strview_copy(id, sizeof(id), req->args[0]);
+    Vote* cur = find_vote_view(req->args[0], id);
     if (!cur) {
-        pthread_mutex_unlock(&data_lock);
-        send(sockfd, "[ERROR] Survey not found", strlen("[ERROR] Survey not found"), 0);
+        send_reply(client, "[ERROR] Vote not found", strlen("[ERROR] Vote not found"));
         return;
     }
-    int total = 0;
-    for (int i = 0; i < cur->option_count; i++) {
-        total += cur->votes[i];
-    }
-    int offset = 0;
-    const char* status_str = (cur->status == STATUS_ACTIVE) ? "Active" : "Closed";
-    offset += snprintf(resp + offset, sizeof(resp) - offset, "Question: %s [%s] (%d participants)\n", cur->question, status_str, cur->voter_count);
-    for (int i = 0; i < cur->option_count; i++) {
-        int pct = (total > 0) ? (cur->votes[i] * 100 / total) : 0;
-        offset += snprintf(resp + offset, sizeof(resp) - offset,
-                           "  %d. %s - %d votes (%d%%)\n",
-                           i + 1, cur->options[i], cur->votes[i], pct);
-        if (offset >= sizeof(resp) - 1) break;
-    }
-    pthread_mutex_unlock(&data_lock);
-    send(sockfd, resp, strlen(resp), 0);
-}
-
-// - result_vote_handler: 투표 결과 요청 처리
-void result_vote_handler(int sockfd, char* msg) {
-    char resp[BUFFER_SIZE] = {0};
-    char* saveptr;
-    pthread_mutex_lock(&data_lock);
-    strtok_r(msg, "|", &saveptr);
-    char* id = strtok_r(NULL, "|", &saveptr);
-    if (id == NULL) {
-        pthread_mutex_unlock(&data_lock);
-        send(sockfd, "[ERROR] Invalid format for RESULT_VOTE", strlen("[ERROR] Invalid format for RESULT_VOTE"), 0);
-        return;
-    }
-    Vote* cur = vote_head;
-    while (cur && strcmp(cur->id, id) != 0) {
-        cur = cur->next;
+    Tally tally;
+    read_vote_tally(cur, &tally);
+    int conditional = req->argc > 1;
+    if (conditional && send_if_not_modified(client, req->args[1], tally.version)) return;
+
+    char resp[BUFFER_SIZE];
+    size_t len;
+    CachedReply* reply = vote_result_reply(cur, &tally, resp, sizeof(resp), &len);
+    send_result(client, reply, resp, len, conditional ? tally.version : 0);
+}
+
+// 구독 fan-out 스레드가 바뀐 항목의 결과를 가져갈 때 쓰는 함수 - RESULT 요청과 같은 캐시를 공유하므로
+// 구독자가 많아도 결과는 집계 버전마다 한 번만 만들어짐
+static CachedReply* survey_subscription_render(void* item) {
+    Tally tally;
+    char resp[BUFFER_SIZE];
+    size_t len;
+    read_survey_tally(item, &tally);
+    return survey_result_reply(item, &tally, resp, sizeof(resp), &len);
+}
+
+static CachedReply* vote_subscription_render(void* item) {
+    Tally tally;
+    char resp[BUFFER_SIZE];
+    size_t len;
+    read_vote_tally(item, &tally);
+    return vote_result_reply(item, &tally, resp, sizeof(resp), &len);
+}
+
+// 구독 간격 인자 (생략하거나 잘못 주면 기본값, 범위 밖이면 subscription_add 가 맞춤)
+static int subscribe_interval(const Request* req) {
+    if (req->argc < 2 || req->args[1].len == 0) return SUBSCRIBE_DEFAULT_INTERVAL_MS;
+    int ms = 0;
+    for (size_t i = 0; i < req->args[1].len; i++) {
+        char c = req->args[1].ptr[i];
+        if (c < '0' || c > '9') return SUBSCRIBE_DEFAULT_INTERVAL_MS;
+        if (ms < SUBSCRIBE_MAX_INTERVAL_MS) ms = ms * 10 + (c - '0');
+    }
+    return ms;
+}
+
+// 구독 등록 인자 - 구독 확인 응답은 등록이 끝난 뒤 fan-out 스레드가 보냄
+typedef struct SubscribeRequest {
+    Client* client;
+    SubTopic* _Atomic* slot;
+    void* item;
+    SubRenderFn render;
+    int fd;
+    int interval_ms;
+    const char* ok_msg;
+} SubscribeRequest;
+
+// 아직 보내지 못한 앞선 응답(pending) 뒤에 확인 응답을 붙여 구독자로 등록 (OutputTakeFn)
+static int add_subscriber(void* arg, const char* pending, size_t pending_len) {
+    SubscribeRequest* req = arg;
+    size_t ok_len = strlen(req->ok_msg);
+    size_t header_len = req->client->framed == 1 ? FRAME_HEADER_LEN : 0;
+    size_t len = pending_len + header_len + ok_len;
+    char* first = buffer_alloc(len);
+    int ret;
+
+    if (!first) return -1;
+    if (pending_len) memcpy(first, pending, pending_len);
+    if (header_len) encode_frame_header((unsigned char*)first + pending_len, ok_len);
+    memcpy(first + pending_len + header_len, req->ok_msg, ok_len);
+    ret = subscription_add(req->slot, req->item, req->render, req->fd, req->client->framed == 1, req->interval_ms,
+                           first, len);
+    buffer_free(first, len);
+    return ret;
+}
+
+// 연결을 구독자로 넘김 - 처리 스레드/이벤트 루프는 detached 를 보고 자기 번호를 닫고,
+// fan-out 스레드는 dup 한 번호로 연결이 끊길 때까지 결과를 보냄
+static void subscribe_client(Client* client, SubTopic* _Atomic* slot, void* item, SubRenderFn render,
+                             int interval_ms, const char* ok_msg) {
+    SubscribeRequest req = { client, slot, item, render, -1, interval_ms, ok_msg };
+    int ret;
+
+    req.fd = dup(client->fd);
+    if (req.fd < 0) {
+        send_reply(client, "[ERROR] Server is out of memory.", strlen("[ERROR] Server is out of memory."));
+        return;
+    }
+    // 등록에 성공해야 확인 응답이 나감 - epoll 모드는 밀려 있던 응답도 함께 넘겨 순서를 지킴
+    if (client->conn) {
+        ret = reactor_hand_over_output(client, add_subscriber, &req);
+    } else {
+        ret = add_subscriber(&req, NULL, 0);
+    }
+    if (ret < 0) {
+        close(req.fd);
+        send_reply(client, "[ERROR] Subscriptions are unavailable.", strlen("[ERROR] Subscriptions are unavailable."));
+        return;
+    }
+    atomic_store(&client->detached, 1);
+}
+
+// - subscribe_survey_handler: 설문 결과 구독 요청 처리 (SUBSCRIBE_SURVEY|ID[|간격ms])
+void subscribe_survey_handler(Client* client, const Request* req) {
+    if (req->argc < 1) {
+        send_reply(client, "[ERROR] Invalid format for SUBSCRIBE_SURVEY", strlen("[ERROR] Invalid format for SUBSCRIBE_SURVEY"));
+        return;
     }
+    char id[ID_LENGTH];
+    strview_copy(id, sizeof(id), req->args[0]);
+    Survey* cur = find_survey_view(req->args[0], id);
     if (!cur) {
-        pthread_mutex_unlock(&data_lock);
-        send(sockfd, "[ERROR] Vote not found", strlen("[ERROR] Vote not found"), 0);
+        send_reply(client, "[ERROR] Survey not found", strlen("[ERROR] Survey not found"));
         return;
     }
-    int total = 0;
-    for (int i = 0; i < cur->option_count; i++) {
-        total += cur->votes[i];
-    }
-    int offset = 0;
-    const char* status_str = (cur->status == STATUS_ACTIVE) ? "Active" : "Closed";
-    offset += snprintf(resp + offset, sizeof(resp) - offset, "Title: %s [%s] (%d participants)\n", cur->title, status_str, cur->voter_count);
-    for (int i = 0; i < cur->option_count; i++) {
-        int pct = (total > 0) ? (cur->votes[i] * 100 / total) : 0;
-        offset += snprintf(resp + offset, sizeof(resp) - offset,
-                           "  %d. %s - %d votes (%d%%)\n",
-                           i + 1, cur->options[i], cur->votes[i], pct);
-        if (offset >= sizeof(resp) - 1) break;
-    }
-    pthread_mutex_unlock(&data_lock);
-    send(sockfd, resp, strlen(resp), 0);
-}
\ No newline at end of file
+    char resp[BUFFER_SIZE];
+    snprintf(resp, sizeof(resp), "[OK] Subscribed to survey %s", cur->id);
+    subscribe_client(client, &cur->subs, cur, survey_subscription_render, subscribe_interval(req), resp);
+}
+
+// - subscribe_vote_handler: 투표 결과 구독 요청 처리 (SUBSCRIBE_VOTE|ID[|간격ms])
+void subscribe_vote_handler(Client* client, const Request* req) {
+    if (req->argc < 1) {
+        send_reply(client, "[ERROR] Invalid format for SUBSCRIBE_VOTE", strlen("[ERROR] Invalid format for SUBSCRIBE_VOTE"));
+        return;
+    }
+    char id[ID_LENGTH];
+    strview_copy(id, sizeof(id), req->args[0]);
+    Vote* cur = find_vote_view(req->args[0], id);
+    if (!cur) {
+        send_reply(client, "[ERROR] Vote not found", strlen("[ERROR] Vote not found"));
+        return;
+    }
+    char resp[BUFFER_SIZE];
+    snprintf(resp, sizeof(resp), "[OK] Subscribed to vote %s", cur->id);
+    subscribe_client(client, &cur->subs, cur, vote_subscription_render, subscribe_interval(req), resp);
+}
+
+// - stats_handler: 서버 계측 요청 처리 (STATS)
+void stats_handler(Client* client, const Request* req) {
+    (void)req;
+    char resp[BUFFER_SIZE * 4];
+    size_t len = render_stats(resp, sizeof(resp));
+    send_reply(client, resp, len);
+}
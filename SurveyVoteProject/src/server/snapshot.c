@@ -0,0 +1,211 @@
+// snapshot.c: 바이너리 스냅샷 쓰기/읽기
+// 항목별 텍스트 파일을 하나씩 열어 파싱하는 대신, 체크포인트마다 모든 항목을 한 파일에 기록해 두고
+// 시작할 때는 mmap 한 뒤 고정 크기 레코드를 복사하고 참여자 명단은 파일 내용을 그대로 가리킨다.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "snapshot.h"
+#include "hash.h"
+#include "wal.h"
+
+struct SnapshotWriter {
+    FILE*     fp;
+    char      path[256];
+    char      tmp_path[256];
+    uint32_t  crc;
+    uint64_t  offset;
+    uint64_t* table;
+    size_t    count;
+    size_t    capacity;
+    int       failed;
+};
+
+static const char zero_pad[8];
+
+static void write_bytes(SnapshotWriter* w, const void* buf, size_t len) {
+    if (w->failed || len == 0) return;
+    if (fwrite(buf, 1, len, w->fp) != len) {
+        w->failed = 1;
+        return;
+    }
+    w->crc = wal_crc32(w->crc, buf, len);
+    w->offset += len;
+}
+
+SnapshotWriter* snapshot_begin(const char* path) {
+    SnapshotWriter* w = calloc(1, sizeof(SnapshotWriter));
+    if (!w) return NULL;
+    snprintf(w->path, sizeof(w->path), "%s", path);
+    snprintf(w->tmp_path, sizeof(w->tmp_path), "%s.tmp", path);
+
+    w->fp = fopen(w->tmp_path, "w");
+    if (!w->fp) {
+        perror("fopen(snapshot) failed");
+        free(w);
+        return NULL;
+    }
+    // 머리는 내용을 다 쓴 뒤에 채우므로 자리만 비워 둠
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    if (fwrite(&header, 1, sizeof(header), w->fp) != sizeof(header)) w->failed = 1;
+    w->offset = sizeof(header);
+    return w;
+}
+
+int snapshot_add(SnapshotWriter* w, const SnapshotItem* item, const VoterSet* voters) {
+    size_t n = item->voter_count;
+    uint64_t* hashes = malloc((n ? n : 1) * sizeof(uint64_t));
+    size_t names_bytes = 1;
+    VoterIter it;
+
+    if (!hashes) {
+        w->failed = 1;
+        return -1;
+    }
+    voter_iter_init(&it, voters);
+    for (size_t i = 0; i < n; i++) {
+        const char* name = voter_iter_next(&it);
+        hashes[i] = str_hash64(name);
+        names_bytes += strlen(name) + 1;
+    }
+
+    if (w->count == w->capacity) {
+        size_t cap = w->capacity ? w->capacity * 2 : 256;
+        uint64_t* table = realloc(w->table, cap * sizeof(uint64_t));
+        if (!table) {
+            free(hashes);
+            w->failed = 1;
+            return -1;
+        }
+        w->table = table;
+        w->capacity = cap;
+    }
+    w->table[w->count++] = w->offset;
+
+    SnapshotItem head = *item;
+    head.names_bytes = names_bytes;
+    write_bytes(w, &head, sizeof(head));
+    write_bytes(w, hashes, n * sizeof(uint64_t));
+    voter_iter_init(&it, voters);
+    for (size_t i = 0; i < n; i++) {
+        const char* name = voter_iter_next(&it);
+        write_bytes(w, name, strlen(name) + 1);
+    }
+    write_bytes(w, zero_pad, 1);
+    write_bytes(w, zero_pad, (8 - w->offset % 8) % 8);
+    free(hashes);
+    return w->failed ? -1 : 0;
+}
+
+void snapshot_abort(SnapshotWriter* w) {
+    if (!w) return;
+    fclose(w->fp);
+    unlink(w->tmp_path);
+    free(w->table);
+    free(w);
+}
+
+int snapshot_commit(SnapshotWriter* w) {
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.item_count = w->count;
+    header.table_offset = w->offset;
+    write_bytes(w, w->table, w->count * sizeof(uint64_t));
+    header.file_size = w->offset;
+    header.crc = w->crc;
+
+    if (!w->failed &&
+        (fseek(w->fp, 0, SEEK_SET) != 0 || fwrite(&header, 1, sizeof(header), w->fp) != sizeof(header))) {
+        w->failed = 1;
+    }
+    if (w->failed || fflush(w->fp) != 0 || fsync(fileno(w->fp)) != 0) {
+        perror("failed to write snapshot");
+        snapshot_abort(w);
+        return -1;
+    }
+    fclose(w->fp);
+    w->fp = NULL;
+
+    int ret = rename(w->tmp_path, w->path);
+    if (ret != 0) {
+        perror("rename(snapshot) failed");
+        unlink(w->tmp_path);
+    }
+    free(w->table);
+    free(w);
+    return ret == 0 ? 0 : -1;
+}
+
+long snapshot_load(const char* path, snapshot_item_fn fn) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return -1;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(SnapshotHeader)) {
+        close(fd);
+        return -1;
+    }
+    size_t size = (size_t)st.st_size;
+    // 참여자 명단이 파일 내용을 직접 가리키므로 매핑은 해제하지 않음 (쓰기 없이 읽기 전용)
+    const char* base = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        perror("mmap(snapshot) failed");
+        return -1;
+    }
+    madvise((void*)base, size, MADV_SEQUENTIAL);
+
+    const SnapshotHeader* header = (const SnapshotHeader*)base;
+    const char* error = NULL;
+    if (memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(header->magic)) != 0) {
+        error = "bad magic";
+    } else if (header->version != SNAPSHOT_VERSION) {
+        error = "unsupported version";
+    } else if (header->file_size != size || header->table_offset > size ||
+               (size - header->table_offset) / sizeof(uint64_t) < header->item_count) {
+        error = "truncated";
+    } else if (wal_crc32(0, base + sizeof(SnapshotHeader), size - sizeof(SnapshotHeader)) != header->crc) {
+        error = "checksum mismatch";
+    }
+
+    // 항목 레코드 범위 확인은 콜백을 부르기 전에 모두 끝냄 (중간에 실패해도 일부만 올라가지 않도록)
+    const uint64_t* table = (const uint64_t*)(base + (error ? 0 : header->table_offset));
+    for (uint64_t i = 0; !error && i < header->item_count; i++) {
+        uint64_t off = table[i];
+        if (off % 8 != 0 || off > header->table_offset ||
+            header->table_offset - off < sizeof(SnapshotItem)) {
+            error = "bad item offset";
+            break;
+        }
+        const SnapshotItem* item = (const SnapshotItem*)(base + off);
+        uint64_t room = header->table_offset - off - sizeof(SnapshotItem);
+        if (item->option_count > MAX_OPTIONS || item->voter_count > room / sizeof(uint64_t) ||
+            item->names_bytes == 0 || item->names_bytes > room - item->voter_count * sizeof(uint64_t)) {
+            error = "bad item record";
+            break;
+        }
+        const char* names = (const char*)(item + 1) + item->voter_count * sizeof(uint64_t);
+        if (names[item->names_bytes - 1] != '\0') {
+            error = "bad voter block";
+        }
+    }
+    if (error) {
+        fprintf(stderr, ">> snapshot %s: %s, ignoring it\n", path, error);
+        munmap((void*)base, size);
+        return -1;
+    }
+
+    // 기록된 역순으로 넘김 - 받는 쪽이 목록 앞에 끼워 넣으면 저장 당시 목록 순서가 그대로 복원됨
+    for (uint64_t i = header->item_count; i-- > 0;) {
+        const SnapshotItem* item = (const SnapshotItem*)(base + table[i]);
+        const uint64_t* hashes = (const uint64_t*)(item + 1);
+        fn(item, hashes, (const char*)(hashes + item->voter_count));
+    }
+    return (long)header->item_count;
+}
@@ -0,0 +1,56 @@
+// snapshot.h: 모든 설문/투표를 한 파일에 담는 버전 있는 바이너리 스냅샷 (data/snapshot.bin)
+#ifndef SURVEY_VOTE_SNAPSHOT_H
+#define SURVEY_VOTE_SNAPSHOT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../include/common.h"
+#include "voter_set.h"
+
+#define SNAPSHOT_PATH    "data/snapshot.bin"
+#define SNAPSHOT_MAGIC   "SVSNAP\0"
+#define SNAPSHOT_VERSION 1
+
+// 파일 구성: [SnapshotHeader][항목 레코드 ...][오프셋 표: u64 x item_count]
+typedef struct SnapshotHeader {
+    char     magic[8];
+    uint32_t version;
+    uint32_t crc;          // 머리 뒤 전체 내용의 CRC-32
+    uint64_t item_count;
+    uint64_t table_offset; // 오프셋 표 위치 (파일 처음부터)
+    uint64_t file_size;
+} SnapshotHeader;
+
+// 항목 레코드 머리 - 뒤이어 참여자 이름 해시(u64 x voter_count)와 이름 블록(names_bytes)이 오며,
+// 다음 레코드는 8바이트 경계에서 시작. 이름 블록은 VoterSet arena 블록과 같은 모양
+// (추가 순서대로 '\0' 으로 이어 붙이고 끝에 빈 문자열 하나)이라 로딩 시 복사 없이 그대로 씀
+typedef struct SnapshotItem {
+    char     kind;         // 'S' 설문 / 'V' 투표
+    uint8_t  status;
+    uint8_t  option_count;
+    uint8_t  reserved[5];
+    uint64_t voter_count;
+    uint64_t names_bytes;
+    char     id[ID_LENGTH];
+    char     title[MAX_QUESTION_LEN];
+    char     options[MAX_OPTIONS][MAX_OPTION_LEN];
+    int32_t  votes[MAX_OPTIONS];
+} SnapshotItem;
+
+typedef struct SnapshotWriter SnapshotWriter;
+
+// path 의 임시 파일에 스냅샷 쓰기 시작 - snapshot_commit 으로 교체하거나 snapshot_abort 로 버림
+SnapshotWriter* snapshot_begin(const char* path);
+// 항목 하나 기록 - voters 에서 item->voter_count 개의 이름을 추가 순서대로 읽음
+int  snapshot_add(SnapshotWriter* w, const SnapshotItem* item, const VoterSet* voters);
+// 오프셋 표와 머리를 쓰고 디스크에 내린 뒤 원래 이름으로 교체
+int  snapshot_commit(SnapshotWriter* w);
+void snapshot_abort(SnapshotWriter* w);
+
+// hashes/names 는 mmap 된 파일 안을 가리키며 서버가 끝날 때까지 유효 (voter_set_adopt 에 그대로 넘김)
+typedef void (*snapshot_item_fn)(const SnapshotItem* item, const uint64_t* hashes, const char* names);
+
+// 스냅샷을 mmap 하여 항목마다 (기록된 역순으로) fn 호출 - 읽은 항목 수, 파일이 없거나 손상되었으면 -1
+long snapshot_load(const char* path, snapshot_item_fn fn);
+
+#endif  // SURVEY_VOTE_SNAPSHOT_H
@@ -0,0 +1,189 @@
+// stats.c: 스레드별 계측 카운터와 합산
+#include <stdio.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "stats.h"
+#include "pool.h"
+
+// 스레드 하나의 히스토그램 - 주인 스레드만 쓰고 합산하는 쪽은 읽기만 하므로, 원자적 변수지만 쓰기는
+// lock 접두어 없는 읽기-더하기-저장으로 함 (합산하는 쪽이 반쯤 쓴 값을 보지 않게 하는 용도)
+typedef struct StatsCounter {
+    atomic_ullong count;
+    atomic_ullong sum_ns;
+    atomic_ullong max_ns;
+    atomic_ullong buckets[STATS_BUCKETS];
+} StatsCounter;
+
+typedef struct ThreadStats {
+    StatsCounter metrics[STATS_METRIC_COUNT];
+    struct ThreadStats* prev;
+    struct ThreadStats* next;
+} ThreadStats;
+
+static Pool thread_stats_pool = POOL_INITIALIZER("thread_stats", sizeof(ThreadStats));
+
+// 기록 중인 스레드 목록과 끝난 스레드의 누적분 (registry_lock 으로 보호)
+static pthread_mutex_t registry_lock = PTHREAD_MUTEX_INITIALIZER;
+static ThreadStats* live_threads = NULL;
+static int live_count = 0;
+static StatsSummary retired[STATS_METRIC_COUNT];
+
+static pthread_key_t exit_key;
+static _Thread_local ThreadStats* thread_stats = NULL;
+static long long start_ns = 0;
+
+static atomic_long        connections_open = 0;
+static atomic_ullong      connections_accepted = 0;
+
+static inline void bump(atomic_ullong* counter, unsigned long long value) {
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + value, memory_order_relaxed);
+}
+
+static size_t bucket_index(unsigned long long ns) {
+    if (ns < (1ULL << STATS_SUB_BITS)) return (size_t)ns;
+    if (ns >= (1ULL << STATS_MAX_SHIFT)) return STATS_BUCKETS - 1;
+    int e = 63 - __builtin_clzll(ns);
+    return ((size_t)(e - STATS_SUB_BITS + 1) << STATS_SUB_BITS) +
+           (size_t)((ns >> (e - STATS_SUB_BITS)) & ((1ULL << STATS_SUB_BITS) - 1));
+}
+
+// 칸의 가장 작은 값과 폭
+static void bucket_range(size_t index, unsigned long long* low, unsigned long long* width) {
+    size_t group = index >> STATS_SUB_BITS;
+    size_t sub = index & ((1u << STATS_SUB_BITS) - 1);
+    if (group == 0) {
+        *low = index;
+        *width = 1;
+        return;
+    }
+    *low = ((1ULL << STATS_SUB_BITS) + sub) << (group - 1);
+    *width = 1ULL << (group - 1);
+}
+
+static void add_counter(StatsSummary* dst, const StatsCounter* src) {
+    unsigned long long max = atomic_load_explicit(&src->max_ns, memory_order_relaxed);
+    dst->count  += atomic_load_explicit(&src->count, memory_order_relaxed);
+    dst->sum_ns += atomic_load_explicit(&src->sum_ns, memory_order_relaxed);
+    if (max > dst->max_ns) dst->max_ns = max;
+    for (size_t i = 0; i < STATS_BUCKETS; i++) {
+        dst->buckets[i] += atomic_load_explicit(&src->buckets[i], memory_order_relaxed);
+    }
+}
+
+// 스레드가 끝날 때 그 스레드의 값을 누적분으로 옮기고 카운터를 돌려줌
+static void thread_exit(void* arg) {
+    ThreadStats* ts = arg;
+    pthread_mutex_lock(&registry_lock);
+    for (int m = 0; m < STATS_METRIC_COUNT; m++) {
+        add_counter(&retired[m], &ts->metrics[m]);
+    }
+    if (ts->prev) ts->prev->next = ts->next;
+    else live_threads = ts->next;
+    if (ts->next) ts->next->prev = ts->prev;
+    live_count--;
+    pthread_mutex_unlock(&registry_lock);
+    pool_free(&thread_stats_pool, ts);
+}
+
+static ThreadStats* attach_thread(void) {
+    ThreadStats* ts = pool_alloc(&thread_stats_pool);
+    if (!ts) return NULL;
+    pthread_mutex_lock(&registry_lock);
+    ts->next = live_threads;
+    if (live_threads) live_threads->prev = ts;
+    live_threads = ts;
+    live_count++;
+    pthread_mutex_unlock(&registry_lock);
+    pthread_setspecific(exit_key, ts);
+    thread_stats = ts;
+    return ts;
+}
+
+void stats_init(void) {
+    start_ns = stats_now_ns();
+    pthread_key_create(&exit_key, thread_exit);
+}
+
+void stats_record(int metric, long long ns) {
+    ThreadStats* ts = thread_stats ? thread_stats : attach_thread();
+    if (!ts) return;
+    if (ns < 0) ns = 0;
+
+    StatsCounter* c = &ts->metrics[metric];
+    bump(&c->count, 1);
+    bump(&c->sum_ns, (unsigned long long)ns);
+    bump(&c->buckets[bucket_index((unsigned long long)ns)], 1);
+    if ((unsigned long long)ns > atomic_load_explicit(&c->max_ns, memory_order_relaxed)) {
+        atomic_store_explicit(&c->max_ns, (unsigned long long)ns, memory_order_relaxed);
+    }
+}
+
+void stats_connection_opened(void) {
+    atomic_fetch_add_explicit(&connections_open, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&connections_accepted, 1, memory_order_relaxed);
+}
+
+void stats_connection_closed(void) {
+    atomic_fetch_sub_explicit(&connections_open, 1, memory_order_relaxed);
+}
+
+// /proc/self/status 의 Threads: 줄
+static int process_threads(void) {
+    FILE* fp = fopen("/proc/self/status", "r");
+    char line[128];
+    int threads = -1;
+    if (!fp) return -1;
+    while (fgets(line, sizeof(line), fp)) {
+        if (sscanf(line, "Threads: %d", &threads) == 1) break;
+    }
+    fclose(fp);
+    return threads;
+}
+
+void stats_collect(StatsReport* out) {
+    memset(out, 0, sizeof(*out));
+    pthread_mutex_lock(&registry_lock);
+    memcpy(out->metrics, retired, sizeof(retired));
+    for (ThreadStats* ts = live_threads; ts; ts = ts->next) {
+        for (int m = 0; m < STATS_METRIC_COUNT; m++) {
+            add_counter(&out->metrics[m], &ts->metrics[m]);
+        }
+    }
+    out->stat_threads = live_count;
+    pthread_mutex_unlock(&registry_lock);
+
+    out->uptime_sec  = (stats_now_ns() - start_ns) / 1e9;
+    out->connections = atomic_load_explicit(&connections_open, memory_order_relaxed);
+    out->accepted    = atomic_load_explicit(&connections_accepted, memory_order_relaxed);
+    out->threads     = process_threads();
+}
+
+unsigned long long stats_percentile(const StatsSummary* s, double q) {
+    if (s->count == 0) return 0;
+    unsigned long long rank = (unsigned long long)(q * (double)s->count);
+    if (rank >= s->count) rank = s->count - 1;
+
+    unsigned long long seen = 0;
+    for (size_t i = 0; i < STATS_BUCKETS; i++) {
+        seen += s->buckets[i];
+        if (seen > rank) {
+            unsigned long long low, width;
+            bucket_range(i, &low, &width);
+            unsigned long long mid = low + width / 2;
+            // 가장 큰 값이 든 칸이면 중간값이 실제 최댓값을 넘지 않게 함
+            return mid > s->max_ns ? s->max_ns : mid;
+        }
+    }
+    return s->max_ns;
+}
+
+const char* stats_metric_name(int metric) {
+    switch (metric) {
+    case STATS_LOCK_WAIT:  return "item_lock_wait";
+    case STATS_LOCK_HOLD:  return "item_lock_hold";
+    case STATS_WAL_COMMIT: return "wal_commit";
+    case STATS_PERSIST:    return "persist_file";
+    default:               return metric < REQ_TYPE_COUNT ? request_type_name((RequestType)metric) : "unknown";
+    }
+}
@@ -0,0 +1,61 @@
+// stats.h: 서버 계측 - 명령별 처리 시간 히스토그램, 항목 lock 대기/보유 시간, 로그 커밋/항목 파일 저장 시간, 연결 수
+// 기록은 스레드마다 따로 가진 카운터에 하므로(처음 기록할 때 만들어 등록) 기록하는 쪽끼리 캐시 라인이나 잠금을
+// 다투지 않는다. 카운터는 그 스레드만 쓰고 STATS 요청이나 -s 출력이 읽을 때만 모든 스레드의 값을 더한다.
+// 끝나는 스레드(스레드 모드의 클라이언트 스레드)의 값은 종료 시 누적분에 합쳐지므로 사라지지 않는다.
+#ifndef SURVEY_VOTE_STATS_H
+#define SURVEY_VOTE_STATS_H
+
+#include <stddef.h>
+#include <time.h>
+#include "request.h"
+
+// HDR 방식 히스토그램: 2의 거듭제곱 구간마다 4칸(상대 오차 25% 이내), 0ns ~ 약 68초
+#define STATS_SUB_BITS  2
+#define STATS_MAX_SHIFT 36
+#define STATS_BUCKETS   ((STATS_MAX_SHIFT - STATS_SUB_BITS + 1) << STATS_SUB_BITS)
+
+// 기록 대상 - 0 ~ REQ_TYPE_COUNT-1 은 명령 종류별 처리 시간(파싱부터 응답 전송까지)
+typedef enum {
+    STATS_LOCK_WAIT = REQ_TYPE_COUNT, // 응답/종료가 항목 lock 을 잡기까지 기다린 시간 (바로 잡으면 0)
+    STATS_LOCK_HOLD,                  // 항목 lock 을 잡고 있던 시간
+    STATS_WAL_COMMIT,                 // 변경 한 건을 로그에 커밋하기까지 기다린 시간 (fsync 정책에 따라 다름)
+    STATS_PERSIST,                    // save_*_to_file() 한 번의 시간 (fsync 포함, 체크포인트에서 호출)
+    STATS_METRIC_COUNT
+} StatsMetric;
+
+// 모든 스레드를 합친 히스토그램 하나
+typedef struct StatsSummary {
+    unsigned long long count;
+    unsigned long long sum_ns;
+    unsigned long long max_ns;
+    unsigned long long buckets[STATS_BUCKETS];
+} StatsSummary;
+
+typedef struct StatsReport {
+    StatsSummary metrics[STATS_METRIC_COUNT];
+    double       uptime_sec;
+    long         connections;       // 지금 열려 있는 클라이언트 연결 (구독으로 넘긴 연결 제외)
+    unsigned long long accepted;    // 지금까지 받은 연결
+    int          threads;           // 프로세스의 스레드 수 (/proc 에서 읽지 못하면 -1)
+    int          stat_threads;      // 기록 중인 스레드 수
+} StatsReport;
+
+static inline long long stats_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// 다른 스레드가 기록하기 전에 한 번 호출 (시작 시각, 스레드 종료 처리 등록)
+void stats_init(void);
+void stats_record(int metric, long long ns);
+void stats_connection_opened(void);
+void stats_connection_closed(void);
+
+// 모든 스레드의 값을 합침 - StatsReport 는 크므로(수십 KB) 호출자가 버퍼를 준비
+void stats_collect(StatsReport* out);
+// q (0~1) 백분위 값(ns) - 해당 칸의 중간값
+unsigned long long stats_percentile(const StatsSummary* s, double q);
+const char* stats_metric_name(int metric);
+
+#endif  // SURVEY_VOTE_STATS_H
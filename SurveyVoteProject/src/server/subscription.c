@@ -0,0 +1,417 @@
+// subscription.c: 구독 연결과 결과 fan-out 스레드
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include "../include/common.h"
+#include "subscription.h"
+#include "pool.h"
+
+// epoll_wait 한 번에 받아오는 최대 이벤트 수
+#define SUB_MAX_EVENTS 256
+
+typedef struct Subscriber {
+    int fd;
+    int framed;
+    int want_out;                // EPOLLOUT 을 등록해 두었는지
+    long long interval_ns;       // 최소 전송 간격
+    long long next_due_ns;       // 다음 결과를 보낼 수 있는 시각
+    int sent_any;                // 결과를 한 번이라도 보냈는지 (새 항목의 집계 버전은 0 부터 시작)
+    unsigned long sent_version;  // 마지막으로 보내기 시작한 결과의 버전
+    CachedReply* out;            // 보내는 중인 결과 - 다 보낼 때까지 참조를 가짐
+    size_t out_off;              // 프레임 머리를 포함해 보낸 바이트 수
+    int out_raw;                 // out 이 머리 없이 그대로 보낼 바이트(구독 확인 응답과 그 앞의 밀린 응답)인지
+    unsigned char header[FRAME_HEADER_LEN];
+    SubTopic* topic;
+    struct Subscriber* prev;
+    struct Subscriber* next;
+} Subscriber;
+
+struct SubTopic {
+    atomic_int watchers;      // 구독자 수 (fan-out 스레드만 바꾸고, 알리는 쪽은 0 인지만 봄)
+    atomic_int queued;        // 바뀐 항목 스택에 올라가 있음 - 내려갈 때까지 같은 항목의 알림은 합쳐짐
+    SubTopic* next_changed;   // 바뀐 항목 스택 연결
+    void* item;
+    SubRenderFn render;
+    // 이하 fan-out 스레드만 사용
+    CachedReply* latest;      // 마지막으로 만든(또는 캐시에서 꺼낸) 결과
+    Subscriber* subs;
+    int pending;              // latest 를 아직 받지 못한 구독자가 있을 수 있음
+    int active;               // active_topics 목록에 있음
+    SubTopic* next_active;
+};
+
+static Pool subscriber_pool = POOL_INITIALIZER("subscriber", sizeof(Subscriber));
+static Pool topic_pool = POOL_INITIALIZER("sub_topic", sizeof(SubTopic));
+
+// 처리 스레드가 넘긴 새 구독자 (fan-out 스레드가 꺼내 등록)
+static pthread_mutex_t incoming_lock = PTHREAD_MUTEX_INITIALIZER;
+static Subscriber* incoming = NULL;
+
+// 바뀐 항목 스택 - 여러 스레드가 앞에 넣고, fan-out 스레드가 통째로 꺼냄
+static SubTopic* _Atomic changed = NULL;
+// 이미 깨우기를 요청했으면 다시 eventfd 에 쓰지 않음
+static atomic_int wake_pending = 0;
+
+static int epfd = -1;
+static int wake_fd = -1;
+// 구독자가 하나 이상 있는 항목 (fan-out 스레드만 사용)
+static SubTopic* active_topics = NULL;
+
+static atomic_size_t     stat_subscribers = 0;
+static atomic_ullong     stat_pushes = 0;
+static atomic_ullong     stat_refreshes = 0;
+static atomic_ullong     stat_stalled = 0;
+
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void wake_fanout(void) {
+    if (atomic_exchange_explicit(&wake_pending, 1, memory_order_acq_rel) == 0) {
+        uint64_t one = 1;
+        if (write(wake_fd, &one, sizeof(one)) < 0) {
+            // eventfd 카운터가 넘칠 일은 없으므로 무시
+        }
+    }
+}
+
+void subscription_topic_changed(SubTopic* topic) {
+    if (atomic_load_explicit(&topic->watchers, memory_order_acquire) == 0) return;
+    if (atomic_exchange_explicit(&topic->queued, 1, memory_order_acq_rel)) return;
+
+    SubTopic* head = atomic_load_explicit(&changed, memory_order_relaxed);
+    do {
+        topic->next_changed = head;
+    } while (!atomic_compare_exchange_weak_explicit(&changed, &head, topic,
+                                                    memory_order_release, memory_order_relaxed));
+    wake_fanout();
+}
+
+int subscription_add(SubTopic* _Atomic* slot, void* item, SubRenderFn render, int fd, int framed, int interval_ms,
+                     const char* first, size_t first_len) {
+    if (epfd < 0) return -1;
+
+    SubTopic* topic = atomic_load_explicit(slot, memory_order_acquire);
+    if (!topic) {
+        SubTopic* fresh = pool_alloc(&topic_pool);
+        if (!fresh) return -1;
+        fresh->item = item;
+        fresh->render = render;
+        // 같은 항목을 동시에 처음 구독하면 먼저 붙인 쪽을 씀
+        if (atomic_compare_exchange_strong_explicit(slot, &topic, fresh, memory_order_acq_rel, memory_order_acquire)) {
+            topic = fresh;
+        } else {
+            pool_free(&topic_pool, fresh);
+        }
+    }
+
+    Subscriber* sub = pool_alloc(&subscriber_pool);
+    if (!sub) return -1;
+    if (first_len > 0) {
+        sub->out = cached_reply_create(0, first, first_len);
+        if (!sub->out) {
+            pool_free(&subscriber_pool, sub);
+            return -1;
+        }
+        sub->out_raw = 1;
+    }
+    if (interval_ms < SUBSCRIBE_MIN_INTERVAL_MS) interval_ms = SUBSCRIBE_MIN_INTERVAL_MS;
+    if (interval_ms > SUBSCRIBE_MAX_INTERVAL_MS) interval_ms = SUBSCRIBE_MAX_INTERVAL_MS;
+    sub->fd = fd;
+    sub->framed = framed;
+    sub->interval_ns = interval_ms * 1000000LL;
+    sub->topic = topic;
+
+    pthread_mutex_lock(&incoming_lock);
+    sub->next = incoming;
+    incoming = sub;
+    pthread_mutex_unlock(&incoming_lock);
+    wake_fanout();
+    return 0;
+}
+
+void subscription_get_stats(SubscriptionStats* out) {
+    out->subscribers = atomic_load_explicit(&stat_subscribers, memory_order_relaxed);
+    out->pushes      = atomic_load_explicit(&stat_pushes, memory_order_relaxed);
+    out->refreshes   = atomic_load_explicit(&stat_refreshes, memory_order_relaxed);
+    out->stalled     = atomic_load_explicit(&stat_stalled, memory_order_relaxed);
+}
+
+// ---- 이하 fan-out 스레드에서만 실행
+
+static void set_want_out(Subscriber* sub, int want) {
+    struct epoll_event ev;
+    if (sub->want_out == want) return;
+    memset(&ev, 0, sizeof(ev));
+    ev.events   = EPOLLIN | EPOLLRDHUP | (want ? EPOLLOUT : 0);
+    ev.data.ptr = sub;
+    epoll_ctl(epfd, EPOLL_CTL_MOD, sub->fd, &ev);
+    sub->want_out = want;
+}
+
+static void drop_subscriber(Subscriber* sub) {
+    SubTopic* topic = sub->topic;
+
+    epoll_ctl(epfd, EPOLL_CTL_DEL, sub->fd, NULL);
+    close(sub->fd);
+    cached_reply_release(sub->out);
+
+    if (sub->prev) sub->prev->next = sub->next;
+    else topic->subs = sub->next;
+    if (sub->next) sub->next->prev = sub->prev;
+    atomic_fetch_sub_explicit(&topic->watchers, 1, memory_order_release);
+
+    // 구독자가 모두 떠난 항목은 목록에서 빼고, 들고 있던 결과도 놓음 (다시 구독되면 새로 만듦)
+    if (!topic->subs) {
+        for (SubTopic** p = &active_topics; *p; p = &(*p)->next_active) {
+            if (*p == topic) {
+                *p = topic->next_active;
+                break;
+            }
+        }
+        topic->active = 0;
+        cached_reply_release(topic->latest);
+        topic->latest = NULL;
+    }
+    pool_free(&subscriber_pool, sub);
+    atomic_fetch_sub_explicit(&stat_subscribers, 1, memory_order_relaxed);
+    printf(">> Subscriber disconnected\n");
+}
+
+// 보내던 결과의 나머지를 보냄 - 소켓 버퍼가 차면 EPOLLOUT 을 기다림 (연결 오류 시 -1)
+static int flush_subscriber(Subscriber* sub) {
+    size_t header_len = sub->framed && !sub->out_raw ? FRAME_HEADER_LEN : 0;
+    size_t total = header_len + sub->out->len;
+
+    while (sub->out_off < total) {
+        struct iovec iov[2];
+        int count = 0;
+        if (sub->out_off < header_len) {
+            iov[count].iov_base = sub->header + sub->out_off;
+            iov[count++].iov_len = header_len - sub->out_off;
+            iov[count].iov_base = sub->out->data;
+            iov[count++].iov_len = sub->out->len;
+        } else {
+            iov[count].iov_base = sub->out->data + (sub->out_off - header_len);
+            iov[count++].iov_len = total - sub->out_off;
+        }
+        struct msghdr mh = { .msg_iov = iov, .msg_iovlen = count };
+        ssize_t n = sendmsg(sub->fd, &mh, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (n > 0) {
+            sub->out_off += (size_t)n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            if (!sub->want_out) atomic_fetch_add_explicit(&stat_stalled, 1, memory_order_relaxed);
+            set_want_out(sub, 1);
+            return 0;
+        }
+        return -1;
+    }
+    cached_reply_release(sub->out);
+    sub->out = NULL;
+    sub->out_raw = 0;
+    set_want_out(sub, 0);
+    // 보내는 동안 더 새 결과가 생겼을 수 있음
+    sub->topic->pending = 1;
+    return 0;
+}
+
+static int start_send(Subscriber* sub, CachedReply* reply, long long now) {
+    uint32_t len = (uint32_t)reply->len;
+    cached_reply_retain(reply);
+    sub->out = reply;
+    sub->out_off = 0;
+    sub->header[0] = (unsigned char)(len >> 24);
+    sub->header[1] = (unsigned char)(len >> 16);
+    sub->header[2] = (unsigned char)(len >> 8);
+    sub->header[3] = (unsigned char)len;
+    sub->sent_any = 1;
+    sub->sent_version = reply->version;
+    sub->next_due_ns = now + sub->interval_ns;
+    atomic_fetch_add_explicit(&stat_pushes, 1, memory_order_relaxed);
+    return flush_subscriber(sub);
+}
+
+// 항목의 지금 결과를 가져옴 - 바뀌었으면 구독자들에게 보낼 것이 생김
+static void refresh_topic(SubTopic* topic) {
+    CachedReply* reply = topic->render(topic->item);
+    if (!reply) return;
+    if (topic->latest && topic->latest->version == reply->version) {
+        cached_reply_release(reply);
+        return;
+    }
+    cached_reply_release(topic->latest);
+    topic->latest = reply;
+    topic->pending = 1;
+    atomic_fetch_add_explicit(&stat_refreshes, 1, memory_order_relaxed);
+}
+
+static void attach_incoming(void) {
+    pthread_mutex_lock(&incoming_lock);
+    Subscriber* list = incoming;
+    incoming = NULL;
+    pthread_mutex_unlock(&incoming_lock);
+
+    while (list) {
+        Subscriber* sub = list;
+        SubTopic* topic = sub->topic;
+        struct epoll_event ev;
+        list = sub->next;
+
+        memset(&ev, 0, sizeof(ev));
+        ev.events   = EPOLLIN | EPOLLRDHUP;
+        ev.data.ptr = sub;
+        if (epoll_ctl(epfd, EPOLL_CTL_ADD, sub->fd, &ev) < 0) {
+            perror("epoll_ctl() failed");
+            close(sub->fd);
+            cached_reply_release(sub->out);
+            pool_free(&subscriber_pool, sub);
+            continue;
+        }
+        sub->prev = NULL;
+        sub->next = topic->subs;
+        if (topic->subs) topic->subs->prev = sub;
+        topic->subs = sub;
+        if (!topic->active) {
+            topic->active = 1;
+            topic->next_active = active_topics;
+            active_topics = topic;
+        }
+        // 구독자가 없던 동안의 변경은 알림이 오지 않았으므로, 구독자 수를 올린 뒤 결과를 다시 가져옴
+        atomic_fetch_add_explicit(&topic->watchers, 1, memory_order_seq_cst);
+        refresh_topic(topic);
+        topic->pending = 1;
+        atomic_fetch_add_explicit(&stat_subscribers, 1, memory_order_relaxed);
+        // 확인 응답부터 보냄 - 다 보낼 때까지 결과는 보내지 않음
+        if (sub->out && flush_subscriber(sub) < 0) {
+            drop_subscriber(sub);
+        }
+    }
+}
+
+// 최신 결과를 받지 못한 구독자 중 보낼 때가 된 구독자에게 보냄
+// 반환값: 간격 때문에 기다리는 구독자가 있으면 가장 이른 전송 시각, 없으면 -1
+static long long push_pending(long long now) {
+    long long next_due = -1;
+
+    for (SubTopic* topic = active_topics; topic; topic = topic->next_active) {
+        if (!topic->pending || !topic->latest) continue;
+        topic->pending = 0;
+        Subscriber* next;
+        for (Subscriber* sub = topic->subs; sub; sub = next) {
+            next = sub->next;
+            if (sub->sent_any && sub->sent_version == topic->latest->version) continue;
+            if (sub->out) {
+                // 보내던 것을 다 보내면 flush_subscriber 가 다시 pending 을 세움
+                continue;
+            }
+            if (now < sub->next_due_ns) {
+                topic->pending = 1;
+                if (next_due < 0 || sub->next_due_ns < next_due) next_due = sub->next_due_ns;
+                continue;
+            }
+            if (start_send(sub, topic->latest, now) < 0) {
+                drop_subscriber(sub);
+                // 마지막 구독자였으면 topic 이 목록에서 빠졌으므로 이 항목은 여기서 끝냄
+                if (!topic->active) break;
+            }
+        }
+    }
+    return next_due;
+}
+
+static void* fanout_main(void* arg) {
+    struct epoll_event events[SUB_MAX_EVENTS];
+    long long next_due = -1;
+    (void)arg;
+
+    for (;;) {
+        int timeout = -1;
+        if (next_due >= 0) {
+            long long wait = next_due - now_ns();
+            timeout = wait <= 0 ? 0 : (int)((wait + 999999) / 1000000);
+        }
+        int n = epoll_wait(epfd, events, SUB_MAX_EVENTS, timeout);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("epoll_wait() failed");
+            break;
+        }
+        for (int i = 0; i < n; i++) {
+            Subscriber* sub = events[i].data.ptr;
+            if (!sub) {
+                uint64_t count;
+                if (read(wake_fd, &count, sizeof(count)) < 0) {
+                    // EAGAIN - 이미 다른 이벤트와 함께 읽음
+                }
+                continue;
+            }
+            if (events[i].events & (EPOLLERR | EPOLLHUP | EPOLLRDHUP)) {
+                drop_subscriber(sub);
+                continue;
+            }
+            if (events[i].events & EPOLLIN) {
+                // 구독 뒤에 보낸 명령은 처리하지 않고 버림
+                char discard[256];
+                ssize_t r = recv(sub->fd, discard, sizeof(discard), MSG_DONTWAIT);
+                if (r == 0 || (r < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+                    drop_subscriber(sub);
+                    continue;
+                }
+            }
+            if ((events[i].events & EPOLLOUT) && sub->out && flush_subscriber(sub) < 0) {
+                drop_subscriber(sub);
+            }
+        }
+
+        // 이후의 알림이 다시 깨우도록, 바뀐 항목을 꺼내기 전에 내려 둠
+        atomic_store_explicit(&wake_pending, 0, memory_order_seq_cst);
+        attach_incoming();
+        SubTopic* topic = atomic_exchange_explicit(&changed, NULL, memory_order_acquire);
+        while (topic) {
+            SubTopic* next = topic->next_changed;
+            atomic_store_explicit(&topic->queued, 0, memory_order_seq_cst);
+            if (topic->active) refresh_topic(topic);
+            topic = next;
+        }
+        next_due = push_pending(now_ns());
+    }
+    return NULL;
+}
+
+int subscription_start(void) {
+    pthread_t tid;
+    struct epoll_event ev;
+
+    epfd = epoll_create1(EPOLL_CLOEXEC);
+    wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epfd < 0 || wake_fd < 0) {
+        perror("failed to set up subscriptions");
+        return -1;
+    }
+    memset(&ev, 0, sizeof(ev));
+    ev.events   = EPOLLIN;
+    ev.data.ptr = NULL;
+    if (epoll_ctl(epfd, EPOLL_CTL_ADD, wake_fd, &ev) < 0 ||
+        pthread_create(&tid, NULL, fanout_main, NULL) != 0) {
+        perror("failed to start subscription thread");
+        close(epfd);
+        epfd = -1;
+        return -1;
+    }
+    pthread_detach(tid);
+    return 0;
+}
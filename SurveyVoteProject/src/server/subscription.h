@@ -0,0 +1,48 @@
+// subscription.h: SUBSCRIBE_SURVEY / SUBSCRIBE_VOTE 결과 구독 - 항목이 바뀌면 구독 연결로 최신 결과를 밀어 보냄
+// 구독한 연결은 전용 fan-out 스레드 하나가 맡는다. 응답/종료 처리 쪽은 항목에 구독자가 있을 때만 항목을
+// lock-free 스택에 올리고(이미 올라가 있으면 아무것도 하지 않음) 스레드를 깨우므로, 어떤 경우에도
+// 소켓 전송을 기다리지 않는다. fan-out 스레드는 바뀐 항목마다 결과를 한 번만 만들어(응답 캐시의 버퍼)
+// 모든 구독자에게 같은 버퍼를 보내고, 구독자마다 최소 전송 간격을 지켜 그 사이의 변경은 최신 것 하나로 합친다.
+// 받는 쪽이 느려 소켓 버퍼가 차면 그 구독자만 남은 부분을 EPOLLOUT 으로 이어 보내고, 그동안의 변경은 역시 합쳐진다.
+#ifndef SURVEY_VOTE_SUBSCRIPTION_H
+#define SURVEY_VOTE_SUBSCRIPTION_H
+
+#include <stdatomic.h>
+#include "reply_cache.h"
+
+// 구독자가 간격을 주지 않았을 때의 최소 전송 간격과 허용 범위(ms)
+#define SUBSCRIBE_DEFAULT_INTERVAL_MS 200
+#define SUBSCRIBE_MIN_INTERVAL_MS     20
+#define SUBSCRIBE_MAX_INTERVAL_MS     60000
+
+// 구독된 항목 하나 - 항목의 subs 필드가 가리키며, 한 번 만들어지면 항목처럼 지워지지 않음
+typedef struct SubTopic SubTopic;
+
+// 항목의 지금 결과 응답 (참조를 하나 올려 반환, 메모리 부족 시 NULL) - fan-out 스레드에서 호출됨
+typedef CachedReply* (*SubRenderFn)(void* item);
+
+typedef struct SubscriptionStats {
+    size_t subscribers;            // 지금 연결된 구독자 수
+    unsigned long long refreshes;  // 바뀐 항목의 결과를 새로 가져온 횟수 (구독자 수와 상관없이 변경 묶음마다 한 번)
+    unsigned long long pushes;     // 구독자에게 보낸 결과 수
+    unsigned long long stalled;    // 소켓 버퍼가 차서 나중에 이어 보낸 횟수
+} SubscriptionStats;
+
+// fan-out 스레드 시작 (실패 시 -1 - 구독 명령은 오류로 응답)
+int  subscription_start(void);
+// 연결을 구독자로 넘김 - fd 는 fan-out 스레드가 닫을 때까지 가짐 (호출자는 dup 한 번호를 넘김)
+// slot 은 항목의 subs 필드, 처음 구독되는 항목이면 여기서 SubTopic 을 만들어 붙임
+// first 는 첫 결과보다 먼저 그대로(프레임 머리를 붙이지 않고) 보낼 바이트 - 구독 확인 응답을 등록이 끝난 뒤에 보내기 위함
+// 실패하면(-1) 아무것도 보내지 않으며 fd 는 호출자가 닫음
+int  subscription_add(SubTopic* _Atomic* slot, void* item, SubRenderFn render, int fd, int framed, int interval_ms,
+                      const char* first, size_t first_len);
+void subscription_topic_changed(SubTopic* topic);
+void subscription_get_stats(SubscriptionStats* out);
+
+// 항목의 집계/상태가 바뀐 뒤 호출 - 구독된 적 없는 항목이면 원자적 읽기 한 번으로 끝남
+static inline void subscription_notify(SubTopic* _Atomic* slot) {
+    SubTopic* topic = atomic_load_explicit(slot, memory_order_acquire);
+    if (topic) subscription_topic_changed(topic);
+}
+
+#endif  // SURVEY_VOTE_SUBSCRIPTION_H
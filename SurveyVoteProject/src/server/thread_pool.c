@@ -0,0 +1,179 @@
+// thread_pool.c: 고정 크기 워커 스레드 풀
+// 작업 큐는 Vyukov 방식의 bounded MPMC 링 버퍼로, 각 칸의 sequence 번호만으로
+// 생산자/소비자 간 동기화를 하므로 enqueue/dequeue 경로에 mutex가 없다.
+// 워커는 큐가 비어 있을 때 세마포어에서 잠든다.
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <sched.h>
+#include <time.h>
+#include "thread_pool.h"
+
+#define CACHE_LINE 64
+
+typedef struct Job {
+    job_fn fn;
+    void*  arg;
+} Job;
+
+typedef struct Cell {
+    atomic_size_t seq;
+    Job job;
+} Cell;
+
+typedef struct ThreadPool {
+    Cell*  cells;
+    size_t mask;
+    _Alignas(CACHE_LINE) atomic_size_t enqueue_pos;
+    _Alignas(CACHE_LINE) atomic_size_t dequeue_pos;
+    _Alignas(CACHE_LINE) atomic_int busy_workers;
+    atomic_ullong completed;
+    atomic_ullong busy_ns;
+    sem_t items;
+    int worker_count;
+    unsigned long long started_ns;
+} ThreadPool;
+
+static ThreadPool pool;
+static int pool_running = 0;
+
+static unsigned long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int queue_push(Job job) {
+    size_t pos = atomic_load_explicit(&pool.enqueue_pos, memory_order_relaxed);
+    Cell* cell;
+
+    for (;;) {
+        cell = &pool.cells[pos & pool.mask];
+        size_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&pool.enqueue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return -1; // 가득 참
+        } else {
+            pos = atomic_load_explicit(&pool.enqueue_pos, memory_order_relaxed);
+        }
+    }
+    cell->job = job;
+    atomic_store_explicit(&cell->seq, pos + 1, memory_order_release);
+    return 0;
+}
+
+static int queue_pop(Job* out) {
+    size_t pos = atomic_load_explicit(&pool.dequeue_pos, memory_order_relaxed);
+    Cell* cell;
+
+    for (;;) {
+        cell = &pool.cells[pos & pool.mask];
+        size_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&pool.dequeue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return -1; // 비어 있음 (또는 생산자가 아직 기록 중)
+        } else {
+            pos = atomic_load_explicit(&pool.dequeue_pos, memory_order_relaxed);
+        }
+    }
+    *out = cell->job;
+    atomic_store_explicit(&cell->seq, pos + pool.mask + 1, memory_order_release);
+    return 0;
+}
+
+static void* worker_main(void* arg) {
+    (void)arg;
+    Job job;
+
+    while (1) {
+        while (sem_wait(&pool.items) != 0) {
+            // EINTR
+        }
+        // 세마포어 값만큼은 작업이 게시되어 있으므로, 앞선 칸을 기록 중인
+        // 생산자를 잠깐 기다리는 경우를 빼면 곧바로 꺼낼 수 있다
+        while (queue_pop(&job) != 0) {
+            sched_yield();
+        }
+
+        atomic_fetch_add_explicit(&pool.busy_workers, 1, memory_order_relaxed);
+        unsigned long long start = now_ns();
+        job.fn(job.arg);
+        atomic_fetch_add_explicit(&pool.busy_ns, now_ns() - start, memory_order_relaxed);
+        atomic_fetch_sub_explicit(&pool.busy_workers, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&pool.completed, 1, memory_order_relaxed);
+    }
+    return NULL;
+}
+
+int thread_pool_start(int worker_count, size_t queue_capacity) {
+    size_t cap = 2;
+    while (cap < queue_capacity) cap <<= 1;
+
+    pool.cells = calloc(cap, sizeof(Cell));
+    if (!pool.cells) return -1;
+    for (size_t i = 0; i < cap; i++) {
+        atomic_init(&pool.cells[i].seq, i);
+    }
+    pool.mask = cap - 1;
+    atomic_init(&pool.enqueue_pos, 0);
+    atomic_init(&pool.dequeue_pos, 0);
+    atomic_init(&pool.busy_workers, 0);
+    atomic_init(&pool.completed, 0);
+    atomic_init(&pool.busy_ns, 0);
+    if (sem_init(&pool.items, 0, 0) != 0) {
+        perror("sem_init() failed");
+        return -1;
+    }
+    pool.worker_count = worker_count;
+    pool.started_ns = now_ns();
+
+    for (int i = 0; i < worker_count; i++) {
+        pthread_t tid;
+        if (pthread_create(&tid, NULL, worker_main, NULL) != 0) {
+            perror("pthread_create() failed");
+            return -1;
+        }
+        pthread_detach(tid);
+    }
+    pool_running = 1;
+    return 0;
+}
+
+int thread_pool_submit(job_fn fn, void* arg) {
+    Job job = { fn, arg };
+    if (queue_push(job) != 0) {
+        return -1;
+    }
+    sem_post(&pool.items);
+    return 0;
+}
+
+int thread_pool_running(void) {
+    return pool_running;
+}
+
+void thread_pool_get_stats(ThreadPoolStats* out) {
+    size_t enq = atomic_load_explicit(&pool.enqueue_pos, memory_order_relaxed);
+    size_t deq = atomic_load_explicit(&pool.dequeue_pos, memory_order_relaxed);
+
+    out->workers        = pool.worker_count;
+    out->busy_workers   = atomic_load_explicit(&pool.busy_workers, memory_order_relaxed);
+    out->queue_depth    = enq > deq ? enq - deq : 0;
+    out->queue_capacity = pool_running ? pool.mask + 1 : 0;
+    out->completed      = atomic_load_explicit(&pool.completed, memory_order_relaxed);
+    out->busy_ns        = atomic_load_explicit(&pool.busy_ns, memory_order_relaxed);
+    out->uptime_ns      = pool_running ? now_ns() - pool.started_ns : 0;
+}
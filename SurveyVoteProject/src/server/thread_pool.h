@@ -0,0 +1,32 @@
+// thread_pool.h: 고정 크기 워커 스레드 풀과 lock-free 작업 큐
+#ifndef SURVEY_VOTE_THREAD_POOL_H
+#define SURVEY_VOTE_THREAD_POOL_H
+
+#include <stddef.h>
+
+// 워커가 실행할 작업 함수
+typedef void (*job_fn)(void* arg);
+
+// 풀 상태 조회 결과
+typedef struct ThreadPoolStats {
+    int    workers;               // 워커 스레드 수
+    int    busy_workers;          // 지금 작업을 실행 중인 워커 수
+    size_t queue_depth;           // 큐에서 대기 중인 작업 수
+    size_t queue_capacity;        // 큐 최대 크기
+    unsigned long long completed; // 처리 완료한 작업 수 (누적)
+    unsigned long long busy_ns;   // 모든 워커가 작업을 실행한 시간의 합 (누적)
+    unsigned long long uptime_ns; // 풀 시작 이후 경과 시간
+} ThreadPoolStats;
+
+// worker_count 개의 워커와 queue_capacity(2의 거듭제곱으로 올림) 크기의 큐를 생성
+int  thread_pool_start(int worker_count, size_t queue_capacity);
+
+// 작업을 큐에 넣음 - 큐가 가득 찼으면 -1 (호출자가 직접 실행하거나 거절)
+int  thread_pool_submit(job_fn fn, void* arg);
+
+// 풀이 실행 중인지 여부
+int  thread_pool_running(void);
+
+void thread_pool_get_stats(ThreadPoolStats* out);
+
+#endif  // SURVEY_VOTE_THREAD_POOL_H
@@ -0,0 +1,187 @@
+// voter_set.c: 참여자 명단
+// 이름은 크기가 점점 커지는 arena 블록에 이어 붙여 저장하므로, 메모리는 실제 참여자 수에
+// 비례하고 참여자 수에 상한이 없다.
+// 대부분의 응답은 처음 참여하는 사용자이므로, 먼저 Bloom filter 로 "없음"을 걸러내고
+// 필터가 "있을 수도 있음"이라고 할 때만 linear probing 테이블에서 이름을 비교한다.
+#include <stdlib.h>
+#include <string.h>
+#include "voter_set.h"
+
+#define INITIAL_CAPACITY 16
+#define BLOOM_BITS_PER_SLOT 8 // 적재율 70% 기준 원소당 약 11비트, 해시 3개 -> 오탐률 약 1~2%
+#define BLOOM_HASHES 3
+#define FIRST_CHUNK_SIZE 256
+#define MAX_CHUNK_SIZE   (64 * 1024)
+
+static void bloom_set(VoterSet* set, uint64_t hash) {
+    uint64_t h1 = hash >> 32, h2 = (hash & 0xffffffffULL) | 1;
+    for (int i = 0; i < BLOOM_HASHES; i++) {
+        size_t bit = (h1 + i * h2) & (set->bloom_bits - 1);
+        set->bloom[bit >> 6] |= 1ULL << (bit & 63);
+    }
+}
+
+static int bloom_maybe(const VoterSet* set, uint64_t hash) {
+    uint64_t h1 = hash >> 32, h2 = (hash & 0xffffffffULL) | 1;
+    for (int i = 0; i < BLOOM_HASHES; i++) {
+        size_t bit = (h1 + i * h2) & (set->bloom_bits - 1);
+        if (!(set->bloom[bit >> 6] & (1ULL << (bit & 63)))) return 0;
+    }
+    return 1;
+}
+
+static void place(VoterSlot* slots, size_t mask, uint64_t hash, const char* name) {
+    size_t pos = hash & mask;
+    while (slots[pos].name) {
+        pos = (pos + 1) & mask;
+    }
+    slots[pos].hash = hash;
+    slots[pos].name = name;
+}
+
+// 테이블과 Bloom filter 를 new_cap 크기로 키움 - 저장된 해시로 재배치하므로 이름을 다시 해시하지 않음
+static int resize(VoterSet* set, size_t new_cap) {
+    size_t new_bits = new_cap * BLOOM_BITS_PER_SLOT;
+    VoterSlot* slots = calloc(new_cap, sizeof(VoterSlot));
+    uint64_t* bloom = calloc(new_bits / 64, sizeof(uint64_t));
+    if (!slots || !bloom) {
+        free(slots);
+        free(bloom);
+        return -1;
+    }
+
+    VoterSlot* old = set->slots;
+    size_t old_cap = set->capacity;
+    free(set->bloom);
+    set->slots = slots;
+    set->capacity = new_cap;
+    set->bloom = bloom;
+    set->bloom_bits = new_bits;
+
+    for (size_t i = 0; i < old_cap; i++) {
+        if (old[i].name) {
+            place(slots, new_cap - 1, old[i].hash, old[i].name);
+            bloom_set(set, old[i].hash);
+        }
+    }
+    free(old);
+    return 0;
+}
+
+static int grow(VoterSet* set) {
+    return resize(set, set->capacity ? set->capacity * 2 : INITIAL_CAPACITY);
+}
+
+// 이름(len 바이트 + '\0')을 arena 에 복사 - 블록 끝 표시용 '\0' 한 바이트는 항상 남겨 둠
+static char* arena_store(VoterSet* set, const char* name, size_t len) {
+    VoterChunk* chunk = set->last;
+
+    if (!chunk || chunk->used + len + 2 > chunk->size) {
+        size_t size = chunk ? chunk->size * 2 : FIRST_CHUNK_SIZE;
+        if (size > MAX_CHUNK_SIZE) size = MAX_CHUNK_SIZE;
+        if (size < len + 2) size = len + 2;
+
+        VoterChunk* fresh = calloc(1, sizeof(VoterChunk) + size);
+        if (!fresh) return NULL;
+        fresh->data = (char*)(fresh + 1);
+        fresh->size = size;
+        if (chunk) chunk->next = fresh;
+        else set->first = fresh;
+        set->last = fresh;
+        chunk = fresh;
+    }
+
+    char* dst = chunk->data + chunk->used;
+    memcpy(dst, name, len + 1);
+    chunk->used += len + 1;
+    return dst;
+}
+
+VoterSet* voter_set_create(void) {
+    return calloc(1, sizeof(VoterSet));
+}
+
+void voter_set_destroy(VoterSet* set) {
+    if (!set) return;
+    while (set->first) {
+        VoterChunk* next = set->first->next;
+        free(set->first);
+        set->first = next;
+    }
+    free(set->slots);
+    free(set->bloom);
+    free(set);
+}
+
+int voter_set_contains(const VoterSet* set, const char* name, uint64_t hash) {
+    if (set->count == 0 || !bloom_maybe(set, hash)) return 0;
+
+    size_t mask = set->capacity - 1;
+    size_t pos = hash & mask;
+    while (set->slots[pos].name) {
+        if (set->slots[pos].hash == hash && strcmp(set->slots[pos].name, name) == 0) {
+            return 1;
+        }
+        pos = (pos + 1) & mask;
+    }
+    return 0;
+}
+
+const char* voter_set_add(VoterSet* set, const char* name, uint64_t hash) {
+    // 빈 이름은 블록 끝 표시와 구별되지 않으므로 받지 않음
+    if (name[0] == '\0') return NULL;
+    if ((set->count + 1) * 10 > set->capacity * 7 && grow(set) < 0) {
+        return NULL;
+    }
+    const char* stored = arena_store(set, name, strlen(name));
+    if (!stored) return NULL;
+
+    place(set->slots, set->capacity - 1, hash, stored);
+    bloom_set(set, hash);
+    set->count++;
+    return stored;
+}
+
+int voter_set_adopt(VoterSet* set, const char* names, size_t bytes,
+                    const uint64_t* hashes, size_t count) {
+    size_t cap = INITIAL_CAPACITY;
+    if (set->first || bytes == 0) return -1;
+    // 한 번에 최종 크기로 할당
+    while (count * 10 > cap * 7) cap *= 2;
+    if (cap > set->capacity && resize(set, cap) < 0) return -1;
+
+    VoterChunk* chunk = calloc(1, sizeof(VoterChunk));
+    if (!chunk) return -1;
+    // 남은 공간이 없는 것으로 두어 arena_store 가 이 블록에는 쓰지 않게 함
+    chunk->data = (char*)names;
+    chunk->size = bytes;
+    chunk->used = bytes - 1;
+    set->first = set->last = chunk;
+
+    const char* name = names;
+    for (size_t i = 0; i < count; i++) {
+        place(set->slots, set->capacity - 1, hashes[i], name);
+        bloom_set(set, hashes[i]);
+        name += strlen(name) + 1;
+    }
+    set->count = count;
+    return 0;
+}
+
+void voter_iter_init(VoterIter* it, const VoterSet* set) {
+    it->chunk = set->first;
+    it->offset = 0;
+}
+
+const char* voter_iter_next(VoterIter* it) {
+    while (it->chunk) {
+        const char* name = it->chunk->data + it->offset;
+        if (*name != '\0') {
+            it->offset += strlen(name) + 1;
+            return name;
+        }
+        it->chunk = it->chunk->next;
+        it->offset = 0;
+    }
+    return NULL;
+}
@@ -0,0 +1,59 @@
+// voter_set.h: 항목별 참여자 명단 - 이름 저장용 arena + 중복 확인용 해시 집합 (+ Bloom filter)
+#ifndef SURVEY_VOTE_VOTER_SET_H
+#define SURVEY_VOTE_VOTER_SET_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct VoterSlot {
+    uint64_t    hash;
+    const char* name; // NULL 이면 빈 칸 - 이름 문자열은 arena 안에 있음
+} VoterSlot;
+
+// 참여자 이름을 추가된 순서대로 이어 붙여 두는 arena 블록
+// 블록 끝의 빈 문자열('\0')은 "다음 블록으로"를 뜻함 (이름은 비어 있을 수 없음)
+// data 는 보통 헤더 바로 뒤에 함께 할당되지만, 스냅샷에서 읽은 블록은 mmap 된 파일을 직접 가리킴
+typedef struct VoterChunk {
+    struct VoterChunk* next;
+    size_t size;
+    size_t used;
+    char*  data;
+} VoterChunk;
+
+// 동기화는 호출자가 담당 (서버에서는 항목 lock 으로 보호)
+// 이름은 한 번 기록되면 움직이지 않으므로, 잠금 안에서 센 count 만큼은
+// 잠금 밖에서도 순회할 수 있다 (그 뒤에 추가되는 이름은 다른 위치에 기록됨)
+typedef struct VoterSet {
+    VoterChunk* first;
+    VoterChunk* last;
+    VoterSlot* slots;
+    size_t     capacity; // 2의 거듭제곱
+    size_t     count;
+    uint64_t*  bloom;    // "아직 참여하지 않음"을 해시 테이블 탐색 없이 판정하기 위한 비트 배열
+    size_t     bloom_bits;
+} VoterSet;
+
+VoterSet* voter_set_create(void);
+void      voter_set_destroy(VoterSet* set);
+
+// hash 는 str_hash64(name) 값 - 확인과 추가에서 한 번만 계산하도록 호출자가 넘김
+int voter_set_contains(const VoterSet* set, const char* name, uint64_t hash);
+// 이름을 arena 에 복사하고 집합에 추가 - 저장된 문자열을 반환 (메모리 부족이거나 빈 이름이면 NULL)
+const char* voter_set_add(VoterSet* set, const char* name, uint64_t hash);
+
+// 빈 집합에 이미 이어 붙여진 이름 블록을 복사 없이 그대로 붙임 (스냅샷 로딩용)
+// names 는 count 개의 이름과 끝 표시 '\0' 으로 이루어진 bytes 바이트 블록, hashes 는 각 이름의 str_hash64 값
+// names 는 집합이 살아 있는 동안 유효해야 하며, 이후 추가되는 이름은 새 블록에 기록됨
+int voter_set_adopt(VoterSet* set, const char* names, size_t bytes,
+                    const uint64_t* hashes, size_t count);
+
+// 추가된 순서대로 이름 순회
+typedef struct VoterIter {
+    const VoterChunk* chunk;
+    size_t offset;
+} VoterIter;
+
+void        voter_iter_init(VoterIter* it, const VoterSet* set);
+const char* voter_iter_next(VoterIter* it); // 더 없으면 NULL
+
+#endif  // SURVEY_VOTE_VOTER_SET_H
@@ -0,0 +1,429 @@
+// wal.c: append-only write-ahead log
+// 레코드 형식: [payload 길이 u32][payload 의 CRC32 u32][payload]
+// payload   : [op 1B][kind 1B][필드 수 1B] + 필드마다 [길이 u16][내용]
+// 변경 한 건은 레코드 하나를 한 번의 write()로 덧붙이는 것으로 끝나며, 서버가 중간에 죽어
+// 마지막 레코드가 잘려도 체크섬 검사로 걸러 내고 그 앞까지만 복구한다.
+//
+// 그룹 커밋: 레코드마다 일련번호를 매기고, 디스크에 내려진 번호(durable_seq)를 따로 관리한다.
+// 기다리는 스레드 중 하나(리더)만 fdatasync 를 호출하고, 그동안 추가된 레코드는 다음 리더가
+// 한꺼번에 내린다. 나머지는 자기 번호가 내려질 때까지 조건 변수에서 기다린다.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <sys/stat.h>
+#include "wal.h"
+#include "pool.h"
+
+#define WAL_HEADER_SIZE  8
+#define WAL_PAYLOAD_HEAD 3
+
+// wal_lock: 로그 파일과 기록 위치 / sync_lock: 디스크 반영 상태 (잠금 순서는 sync_lock -> wal_lock)
+static int wal_fd = -1;
+static size_t wal_bytes = 0;
+static unsigned long long written_seq = 0;  // 지금까지 기록한 레코드 수
+static pthread_mutex_t wal_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static unsigned long long durable_seq = 0;  // 디스크에 내려진 것이 확인된 레코드 수
+static int syncing = 0;                     // 리더가 fdatasync 중인지
+static pthread_mutex_t sync_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  sync_cond = PTHREAD_COND_INITIALIZER;
+
+static WalSyncPolicy sync_policy = WAL_SYNC_ALWAYS;
+static int sync_interval_ms = 0;
+
+static atomic_ullong stat_appended;
+static atomic_ullong stat_commits;
+static atomic_ullong stat_syncs;
+static atomic_ullong stat_synced;
+static atomic_ullong stat_ack_ns;
+static atomic_ullong stat_ack_max_ns;
+
+static unsigned long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// slicing-by-8: 8개의 표로 한 번에 8바이트씩 처리 (스냅샷 전체 검사가 시작 시간을 좌우하지 않도록)
+static uint32_t crc_table[8][256];
+static pthread_once_t crc_once = PTHREAD_ONCE_INIT;
+
+static void crc_init(void) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++) {
+            c = (c & 1) ? 0xEDB88320U ^ (c >> 1) : c >> 1;
+        }
+        crc_table[0][i] = c;
+    }
+    for (uint32_t i = 0; i < 256; i++) {
+        for (int t = 1; t < 8; t++) {
+            uint32_t prev = crc_table[t - 1][i];
+            crc_table[t][i] = crc_table[0][prev & 0xFF] ^ (prev >> 8);
+        }
+    }
+}
+
+uint32_t wal_crc32(uint32_t crc, const void* buf, size_t len) {
+    const unsigned char* p = buf;
+    uint32_t c = crc ^ 0xFFFFFFFFU;
+    pthread_once(&crc_once, crc_init);
+    for (; len >= 8; len -= 8, p += 8) {
+        uint32_t lo = c ^ ((uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24);
+        uint32_t hi = (uint32_t)p[4] | (uint32_t)p[5] << 8 | (uint32_t)p[6] << 16 | (uint32_t)p[7] << 24;
+        c = crc_table[7][lo & 0xFF] ^ crc_table[6][(lo >> 8) & 0xFF] ^
+            crc_table[5][(lo >> 16) & 0xFF] ^ crc_table[4][lo >> 24] ^
+            crc_table[3][hi & 0xFF] ^ crc_table[2][(hi >> 8) & 0xFF] ^
+            crc_table[1][(hi >> 16) & 0xFF] ^ crc_table[0][hi >> 24];
+    }
+    for (; len > 0; len--, p++) {
+        c = crc_table[0][(c ^ *p) & 0xFF] ^ (c >> 8);
+    }
+    return c ^ 0xFFFFFFFFU;
+}
+
+// 레코드를 out 에 직렬화하고 전체 길이를 반환 (형식에 맞지 않으면 -1)
+static int encode_record(const WalRecord* rec, unsigned char* out) {
+    unsigned char* p = out + WAL_HEADER_SIZE;
+    unsigned char* end = p + WAL_MAX_PAYLOAD;
+
+    if (rec->field_count < 0 || rec->field_count > WAL_MAX_FIELDS) return -1;
+    *p++ = (unsigned char)rec->op;
+    *p++ = (unsigned char)rec->kind;
+    *p++ = (unsigned char)rec->field_count;
+    for (int i = 0; i < rec->field_count; i++) {
+        size_t len = rec->lens[i];
+        if ((size_t)(end - p) < len + 2) return -1;
+        *p++ = (unsigned char)(len >> 8);
+        *p++ = (unsigned char)(len & 0xFF);
+        memcpy(p, rec->fields[i], len);
+        p += len;
+    }
+
+    uint32_t payload_len = (uint32_t)(p - (out + WAL_HEADER_SIZE));
+    uint32_t crc = wal_crc32(0, out + WAL_HEADER_SIZE, payload_len);
+    memcpy(out, &payload_len, 4);
+    memcpy(out + 4, &crc, 4);
+    return WAL_HEADER_SIZE + payload_len;
+}
+
+// payload 를 rec 으로 풀어냄 - 각 필드는 strings 에 '\0' 을 붙여 복사
+static int decode_record(const unsigned char* p, size_t len, WalRecord* rec, char* strings) {
+    const unsigned char* end = p + len;
+
+    if (len < WAL_PAYLOAD_HEAD || p[2] > WAL_MAX_FIELDS) return -1;
+    rec->op = (char)p[0];
+    rec->kind = (char)p[1];
+    rec->field_count = p[2];
+    p += WAL_PAYLOAD_HEAD;
+    for (int i = 0; i < rec->field_count; i++) {
+        if (end - p < 2) return -1;
+        size_t field_len = ((size_t)p[0] << 8) | p[1];
+        p += 2;
+        if ((size_t)(end - p) < field_len) return -1;
+        memcpy(strings, p, field_len);
+        strings[field_len] = '\0';
+        rec->fields[i] = strings;
+        rec->lens[i] = field_len;
+        strings += field_len + 1;
+        p += field_len;
+    }
+    return p == end ? 0 : -1;
+}
+
+long wal_replay(const char* path, wal_apply_fn apply) {
+    FILE* f = fopen(path, "r+");
+    if (!f) return 0;
+
+    unsigned char header[WAL_HEADER_SIZE];
+    unsigned char payload[WAL_MAX_PAYLOAD];
+    char strings[WAL_MAX_PAYLOAD + WAL_MAX_FIELDS];
+    long applied = 0;
+    long good_end = 0;
+
+    while (fread(header, 1, WAL_HEADER_SIZE, f) == WAL_HEADER_SIZE) {
+        uint32_t len, crc;
+        WalRecord rec;
+        memcpy(&len, header, 4);
+        memcpy(&crc, header + 4, 4);
+        if (len > WAL_MAX_PAYLOAD || fread(payload, 1, len, f) != len ||
+            wal_crc32(0, payload, len) != crc ||
+            decode_record(payload, len, &rec, strings) < 0) {
+            break;
+        }
+        apply(&rec);
+        applied++;
+        good_end = ftell(f);
+    }
+
+    // 마지막으로 온전했던 레코드 뒤의 잘린/깨진 부분은 버림
+    fseek(f, 0, SEEK_END);
+    if (ftell(f) != good_end) {
+        fprintf(stderr, ">> WAL %s: discarding %ld bytes of torn tail\n", path, ftell(f) - good_end);
+        fflush(f);
+        if (ftruncate(fileno(f), good_end) != 0) {
+            perror("ftruncate() failed");
+        }
+    }
+    fclose(f);
+    return applied;
+}
+
+int wal_open(int truncate) {
+    int flags = O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC | (truncate ? O_TRUNC : 0);
+    int fd = open(WAL_PATH, flags, 0644);
+    if (fd < 0) {
+        perror("open(WAL) failed");
+        return -1;
+    }
+
+    struct stat st;
+    pthread_mutex_lock(&wal_lock);
+    if (wal_fd >= 0) close(wal_fd);
+    wal_fd = fd;
+    wal_bytes = fstat(fd, &st) == 0 ? (size_t)st.st_size : 0;
+    pthread_mutex_unlock(&wal_lock);
+    return 0;
+}
+
+// seq 번째 레코드까지 디스크에 내려질 때까지 기다림 (필요하면 직접 fdatasync 를 호출하는 리더가 됨)
+static int wal_sync_to(unsigned long long seq) {
+    int ret = 0;
+
+    pthread_mutex_lock(&sync_lock);
+    while (durable_seq < seq) {
+        if (syncing) {
+            pthread_cond_wait(&sync_cond, &sync_lock);
+            continue;
+        }
+        syncing = 1;
+        pthread_mutex_lock(&wal_lock);
+        int fd = wal_fd;
+        unsigned long long target = written_seq;
+        pthread_mutex_unlock(&wal_lock);
+        pthread_mutex_unlock(&sync_lock);
+
+        // 교체(wal_rotate)는 syncing 이 풀릴 때까지 기다리므로 fd 는 이 동안 닫히지 않음
+        int rc = fdatasync(fd);
+
+        pthread_mutex_lock(&sync_lock);
+        syncing = 0;
+        if (rc == 0) {
+            atomic_fetch_add_explicit(&stat_syncs, 1, memory_order_relaxed);
+            atomic_fetch_add_explicit(&stat_synced, target - durable_seq, memory_order_relaxed);
+            durable_seq = target;
+        }
+        pthread_cond_broadcast(&sync_cond);
+        if (rc != 0) {
+            perror("fdatasync(WAL) failed");
+            ret = -1;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&sync_lock);
+    return ret;
+}
+
+static void record_ack(unsigned long long ns) {
+    unsigned long long max = atomic_load_explicit(&stat_ack_max_ns, memory_order_relaxed);
+    atomic_fetch_add_explicit(&stat_ack_ns, ns, memory_order_relaxed);
+    while (ns > max &&
+           !atomic_compare_exchange_weak_explicit(&stat_ack_max_ns, &max, ns,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+// 인코딩된 레코드 count 개(len 바이트)를 한 번의 write()로 덧붙임
+static long append_encoded(const unsigned char* buf, size_t len, size_t count, WalTicket* ticket) {
+    long ret;
+
+    pthread_mutex_lock(&wal_lock);
+    if (wal_fd < 0) {
+        ret = -1;
+    } else {
+        ssize_t n;
+        do {
+            n = write(wal_fd, buf, len);
+        } while (n < 0 && errno == EINTR);
+        if (n == (ssize_t)len) {
+            wal_bytes += len;
+            written_seq += count;
+            ticket->seq = written_seq;
+            ret = (long)wal_bytes;
+        } else {
+            // 일부만 기록되었으면 잘라 내서, 뒤이어 추가되는 레코드가 깨진 레코드 뒤에 붙지 않게 함
+            perror("write(WAL) failed");
+            if (n > 0 && ftruncate(wal_fd, wal_bytes) != 0) {
+                perror("ftruncate() failed");
+            }
+            ret = -1;
+        }
+    }
+    pthread_mutex_unlock(&wal_lock);
+    return ret;
+}
+
+long wal_append(const WalRecord* rec, WalTicket* ticket) {
+    unsigned char buf[WAL_HEADER_SIZE + WAL_MAX_PAYLOAD];
+    int len = encode_record(rec, buf);
+
+    ticket->start_ns = now_ns();
+    ticket->seq = 0;
+    ticket->count = 1;
+    if (len < 0) return -1;
+    return append_encoded(buf, (size_t)len, 1, ticket);
+}
+
+long wal_append_batch(const WalRecord* recs, size_t count, WalTicket* ticket) {
+    size_t total = 0;
+    long ret;
+
+    ticket->start_ns = now_ns();
+    ticket->seq = 0;
+    ticket->count = count;
+    if (count == 0) return (long)wal_size();
+
+    // 각 레코드의 정확한 크기를 더해 한 번에 할당
+    for (size_t i = 0; i < count; i++) {
+        total += WAL_HEADER_SIZE + WAL_PAYLOAD_HEAD;
+        for (int k = 0; k < recs[i].field_count && k < WAL_MAX_FIELDS; k++) {
+            total += 2 + recs[i].lens[k];
+        }
+    }
+    unsigned char* buf = buffer_alloc(total);
+    if (!buf) return -1;
+
+    size_t off = 0;
+    for (size_t i = 0; i < count; i++) {
+        int len = encode_record(&recs[i], buf + off);
+        if (len < 0) {
+            buffer_free(buf, total);
+            return -1;
+        }
+        off += (size_t)len;
+    }
+    ret = append_encoded(buf, off, count, ticket);
+    buffer_free(buf, total);
+    return ret;
+}
+
+int wal_commit(const WalTicket* ticket) {
+    // 디스크에 내리지 못했으면 실패로 알려 호출자가 다른 방법으로 저장하게 함
+    if (sync_policy == WAL_SYNC_ALWAYS && wal_sync_to(ticket->seq) < 0) return -1;
+
+    atomic_fetch_add_explicit(&stat_appended, ticket->count, memory_order_relaxed);
+    atomic_fetch_add_explicit(&stat_commits, 1, memory_order_relaxed);
+    record_ack(now_ns() - ticket->start_ns);
+    return 0;
+}
+
+// INTERVAL 정책: interval_ms 마다 그때까지 기록된 레코드를 내림
+static void* sync_thread_main(void* arg) {
+    (void)arg;
+    struct timespec ts = { sync_interval_ms / 1000, (long)(sync_interval_ms % 1000) * 1000000L };
+
+    while (1) {
+        nanosleep(&ts, NULL);
+        pthread_mutex_lock(&wal_lock);
+        unsigned long long seq = written_seq;
+        pthread_mutex_unlock(&wal_lock);
+        wal_sync_to(seq);
+    }
+    return NULL;
+}
+
+int wal_set_sync_policy(WalSyncPolicy policy, int interval_ms) {
+    sync_policy = policy;
+    sync_interval_ms = interval_ms > 0 ? interval_ms : 1;
+    if (policy == WAL_SYNC_INTERVAL) {
+        pthread_t tid;
+        if (pthread_create(&tid, NULL, sync_thread_main, NULL) != 0) {
+            perror("pthread_create() failed");
+            return -1;
+        }
+        pthread_detach(tid);
+    }
+    return 0;
+}
+
+const char* wal_policy_name(WalSyncPolicy policy) {
+    switch (policy) {
+        case WAL_SYNC_ALWAYS:   return "always";
+        case WAL_SYNC_INTERVAL: return "interval";
+        default:                return "none";
+    }
+}
+
+void wal_get_stats(WalStats* out) {
+    out->policy      = sync_policy;
+    out->interval_ms = sync_interval_ms;
+    out->appended    = atomic_load_explicit(&stat_appended, memory_order_relaxed);
+    out->commits     = atomic_load_explicit(&stat_commits, memory_order_relaxed);
+    out->syncs       = atomic_load_explicit(&stat_syncs, memory_order_relaxed);
+    out->synced      = atomic_load_explicit(&stat_synced, memory_order_relaxed);
+    out->ack_ns      = atomic_load_explicit(&stat_ack_ns, memory_order_relaxed);
+    out->ack_max_ns  = atomic_exchange_explicit(&stat_ack_max_ns, 0, memory_order_relaxed);
+}
+
+size_t wal_size(void) {
+    pthread_mutex_lock(&wal_lock);
+    size_t size = wal_bytes;
+    pthread_mutex_unlock(&wal_lock);
+    return size;
+}
+
+int wal_rotate(void) {
+    int ret = 0;
+    int old_fd = -1;
+    unsigned long long rotated_seq = 0;
+
+    // 진행 중인 fdatasync 가 끝난 뒤에 교체해야 리더가 쓰던 fd 를 닫지 않음
+    pthread_mutex_lock(&sync_lock);
+    while (syncing) {
+        pthread_cond_wait(&sync_cond, &sync_lock);
+    }
+
+    pthread_mutex_lock(&wal_lock);
+    if (rename(WAL_PATH, WAL_OLD_PATH) != 0) {
+        perror("rename(WAL) failed");
+        ret = -1;
+    } else {
+        int fd = open(WAL_PATH, O_WRONLY | O_CREAT | O_APPEND | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            // 새 로그를 못 열면 기존 로그에 계속 기록해야 하므로 이름을 되돌림
+            perror("open(WAL) failed");
+            rename(WAL_OLD_PATH, WAL_PATH);
+            ret = -1;
+        } else {
+            old_fd = wal_fd;
+            wal_fd = fd;
+            wal_bytes = 0;
+            rotated_seq = written_seq;
+        }
+    }
+    pthread_mutex_unlock(&wal_lock);
+
+    // 이전 로그에 남은 레코드를 내려 두어야, 그 레코드를 기다리는 스레드가 새 로그와 무관하게 반환됨
+    if (old_fd >= 0) {
+        if (fdatasync(old_fd) == 0 && rotated_seq > durable_seq) {
+            atomic_fetch_add_explicit(&stat_syncs, 1, memory_order_relaxed);
+            atomic_fetch_add_explicit(&stat_synced, rotated_seq - durable_seq, memory_order_relaxed);
+            durable_seq = rotated_seq;
+            pthread_cond_broadcast(&sync_cond);
+        }
+        close(old_fd);
+    }
+    pthread_mutex_unlock(&sync_lock);
+    return ret;
+}
+
+void wal_remove_old(void) {
+    unlink(WAL_OLD_PATH);
+}
@@ -0,0 +1,106 @@
+// wal.h: 항목 생성/응답(ballot)/종료를 기록하는 append-only write-ahead log
+#ifndef SURVEY_VOTE_WAL_H
+#define SURVEY_VOTE_WAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 현재 기록 중인 로그와, 체크포인트 중 교체되어 정리를 기다리는 이전 로그
+#define WAL_PATH     "data/changes.wal"
+#define WAL_OLD_PATH "data/changes.wal.old"
+
+// 로그가 이 크기를 넘으면 체크포인트(스냅샷 저장 후 로그 비우기)를 수행
+#ifndef WAL_CHECKPOINT_BYTES
+#define WAL_CHECKPOINT_BYTES (64 * 1024 * 1024)
+#endif
+
+// 레코드 하나에 담을 수 있는 필드 수와 payload 최대 크기
+#define WAL_MAX_FIELDS  16
+#define WAL_MAX_PAYLOAD 4096
+
+typedef enum {
+    WAL_BALLOT = 'B', // 필드: ID, 참여자 이름, 고른 보기 인덱스들(0부터, 1바이트씩)
+    WAL_CREATE = 'C', // 필드: ID, 질문/제목, 보기 이름들
+    WAL_CLOSE  = 'X'  // 필드: ID
+} WalOp;
+
+// 레코드 한 건 - kind 는 'S'(설문) / 'V'(투표)
+// 재생 시 넘겨받는 fields 는 모두 '\0' 으로 끝나며, lens 에 원래 길이가 들어 있음
+typedef struct WalRecord {
+    char op;
+    char kind;
+    int  field_count;
+    const char* fields[WAL_MAX_FIELDS];
+    size_t      lens[WAL_MAX_FIELDS];
+} WalRecord;
+
+static inline void wal_record_init(WalRecord* rec, WalOp op, char kind) {
+    rec->op = (char)op;
+    rec->kind = kind;
+    rec->field_count = 0;
+}
+
+static inline void wal_add_field(WalRecord* rec, const void* data, size_t len) {
+    if (rec->field_count < WAL_MAX_FIELDS) {
+        rec->fields[rec->field_count] = data;
+        rec->lens[rec->field_count] = len;
+        rec->field_count++;
+    }
+}
+
+typedef void (*wal_apply_fn)(const WalRecord* rec);
+
+// 기록한 레코드를 언제 디스크에 내릴지(fdatasync) 정하는 정책
+typedef enum {
+    WAL_SYNC_ALWAYS,   // 요청마다 디스크에 내린 뒤 응답 - 동시에 들어온 요청은 한 번의 fdatasync로 묶음
+    WAL_SYNC_INTERVAL, // 백그라운드 스레드가 주기적으로 내림 - 마지막 주기 동안의 기록은 유실될 수 있음
+    WAL_SYNC_NONE      // 운영체제에 맡김 (체크포인트 때만 내림)
+} WalSyncPolicy;
+
+// wal_append 가 돌려주는 기록 위치 - wal_commit 에 넘겨 디스크 반영을 기다림
+typedef struct WalTicket {
+    unsigned long long seq;      // 마지막으로 기록한 레코드의 일련번호
+    unsigned long long start_ns;
+    size_t count;                // 함께 기록한 레코드 수
+} WalTicket;
+
+// 정책별 처리량/묶음 크기/응답 지연을 보기 위한 누적 통계
+typedef struct WalStats {
+    WalSyncPolicy policy;
+    int interval_ms;
+    unsigned long long appended;    // 커밋한 레코드 수 (생성/응답/종료 모두 - 묶음은 레코드마다 셈)
+    unsigned long long commits;     // wal_commit 성공 횟수 (묶음 하나는 한 번)
+    unsigned long long syncs;       // fdatasync 호출 수
+    unsigned long long synced;      // fdatasync 로 내린 레코드 수 (synced / syncs = 평균 묶음 크기)
+    unsigned long long ack_ns;      // 기록 시작부터 커밋 완료까지 걸린 시간의 합 (커밋마다 한 번)
+    unsigned long long ack_max_ns;  // 직전 조회 이후 가장 오래 걸린 커밋 (조회할 때마다 0으로 초기화)
+} WalStats;
+
+// path 의 레코드를 순서대로 apply 에 넘김 - 체크섬이 맞지 않거나 잘린 레코드를 만나면
+// 그 지점에서 멈추고 파일을 잘라냄. 적용한 레코드 수를 반환 (파일이 없으면 0)
+long wal_replay(const char* path, wal_apply_fn apply);
+
+// 기록용 로그 열기 (truncate 이면 기존 내용을 비움)
+int    wal_open(int truncate);
+// 디스크 반영 정책 설정 - INTERVAL 이면 interval_ms 마다 내리는 스레드를 시작
+int    wal_set_sync_policy(WalSyncPolicy policy, int interval_ms);
+// 레코드 하나를 로그 끝에 한 번의 write()로 추가 (디스크 반영은 기다리지 않음)
+// 성공 시 추가 후 로그 크기, 실패 시 -1
+long   wal_append(const WalRecord* rec, WalTicket* ticket);
+// 레코드 count 개를 이어 붙여 한 번의 write()로 추가 - 커밋도 wal_commit 한 번으로 끝남
+long   wal_append_batch(const WalRecord* recs, size_t count, WalTicket* ticket);
+// 정책에 따라 ticket 까지 디스크에 내려질 때까지 기다림 - 실패 시 -1
+int    wal_commit(const WalTicket* ticket);
+size_t wal_size(void);
+
+void   wal_get_stats(WalStats* out);
+const char* wal_policy_name(WalSyncPolicy policy);
+
+// 체크포인트용: 현재 로그를 WAL_OLD_PATH 로 옮기고 빈 로그를 새로 열기
+int  wal_rotate(void);
+void wal_remove_old(void);
+
+// 로그와 스냅샷이 함께 쓰는 CRC-32 (crc 에 이전 결과를 넘기면 이어서 계산, 처음에는 0)
+uint32_t wal_crc32(uint32_t crc, const void* buf, size_t len);
+
+#endif  // SURVEY_VOTE_WAL_H